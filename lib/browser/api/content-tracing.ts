@@ -1 +1,92 @@
-export default process._linkedBinding('electron_browser_content_tracing');
+import { EventEmitter } from 'events';
+import { app, webContents } from 'electron/main';
+
+const binding = process._linkedBinding('electron_browser_content_tracing');
+
+type DumpReason = 'unresponsive' | 'render-process-gone' | 'child-process-gone';
+
+class ContentTracing extends EventEmitter {
+  getCategories = binding.getCategories;
+  startRecording = binding.startRecording;
+  stopRecording = binding.stopRecording;
+  getTraceBufferUsage = binding.getTraceBufferUsage;
+  dumpFlightRecorder = binding.dumpFlightRecorder;
+
+  _removeDumpTriggers: (() => void) | null = null;
+  _lastAutomaticDump = -Infinity;
+
+  get flightRecorderRunning (): boolean {
+    return binding.isFlightRecorderRunning();
+  }
+
+  async startFlightRecorder (options: any = {}) {
+    await binding.startFlightRecorder(options);
+    this._addDumpTriggers(options.dumpOn || [], typeof options.minDumpInterval === 'number' ? options.minDumpInterval : 30);
+  }
+
+  async stopFlightRecorder () {
+    this._removeTriggers();
+    await binding.stopFlightRecorder();
+  }
+
+  _addDumpTriggers (dumpOn: DumpReason[], minDumpInterval: number) {
+    this._removeTriggers();
+    if (dumpOn.length === 0) return;
+
+    const dump = async (reason: DumpReason) => {
+      // A crash loop or a page that keeps hanging would otherwise dump the
+      // same events over and over.
+      const now = Date.now();
+      if (now - this._lastAutomaticDump < minDumpInterval * 1000) return;
+      this._lastAutomaticDump = now;
+      try {
+        const path = await binding.dumpFlightRecorder();
+        this.emit('flight-recorder-dump', { reason, path });
+      } catch {
+        // The flight recorder was stopped.
+      }
+    };
+
+    const removers: (() => void)[] = [];
+    const listen = (emitter: EventEmitter, event: string, listener: (...args: any[]) => void) => {
+      emitter.on(event, listener);
+      removers.push(() => emitter.removeListener(event, listener));
+    };
+
+    if (dumpOn.includes('unresponsive')) {
+      const watched = new Map<Electron.WebContents, () => void>();
+      const onUnresponsive = () => dump('unresponsive');
+      const watch = (contents: Electron.WebContents) => {
+        const onDestroyed = () => watched.delete(contents);
+        watched.set(contents, onDestroyed);
+        contents.on('unresponsive', onUnresponsive);
+        contents.once('destroyed', onDestroyed);
+      };
+      webContents.getAllWebContents().forEach(watch);
+      listen(app, 'web-contents-created', (event: Electron.Event, contents: Electron.WebContents) => watch(contents));
+      removers.push(() => {
+        for (const [contents, onDestroyed] of watched) {
+          contents.removeListener('unresponsive', onUnresponsive);
+          contents.removeListener('destroyed', onDestroyed);
+        }
+      });
+    }
+    if (dumpOn.includes('render-process-gone')) {
+      listen(app, 'render-process-gone', () => dump('render-process-gone'));
+    }
+    if (dumpOn.includes('child-process-gone')) {
+      listen(app, 'child-process-gone', () => dump('child-process-gone'));
+    }
+
+    this._removeDumpTriggers = () => removers.forEach(remove => remove());
+  }
+
+  _removeTriggers () {
+    if (this._removeDumpTriggers) {
+      this._removeDumpTriggers();
+      this._removeDumpTriggers = null;
+    }
+  }
+}
+
+module.exports = new ContentTracing();
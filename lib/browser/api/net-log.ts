@@ -12,11 +12,33 @@ const stopLogging: typeof session.defaultSession.netLog.stopLogging = async () =
   return session.defaultSession.netLog.stopLogging();
 };
 
+const startStreaming: typeof session.defaultSession.netLog.startStreaming = async (options?: any, listener?: any) => {
+  if (!app.isReady()) return;
+  return session.defaultSession.netLog.startStreaming(options, listener);
+};
+
+const stopStreaming: typeof session.defaultSession.netLog.stopStreaming = async () => {
+  if (!app.isReady()) return;
+  return session.defaultSession.netLog.stopStreaming();
+};
+
+const getRecentEvents: typeof session.defaultSession.netLog.getRecentEvents = (seconds?: number) => {
+  if (!app.isReady()) return [];
+  return session.defaultSession.netLog.getRecentEvents(seconds);
+};
+
 export default {
   startLogging,
   stopLogging,
+  startStreaming,
+  stopStreaming,
+  getRecentEvents,
   get currentlyLogging (): boolean {
     if (!app.isReady()) return false;
     return session.defaultSession.netLog.currentlyLogging;
+  },
+  get currentlyStreaming (): boolean {
+    if (!app.isReady()) return false;
+    return session.defaultSession.netLog.currentlyStreaming;
   }
 };
@@ -256,7 +256,9 @@ function parseOptions (optionsIn: ClientRequestConstructorOptions | string): Nod
     extraHeaders: options.headers || {},
     body: null as any,
     useSessionCookies: options.useSessionCookies,
-    credentials: options.credentials
+    credentials: options.credentials,
+    chunkSize: options.chunkSize,
+    downloadPath: options.downloadPath
   };
   for (const [name, value] of Object.entries(urlLoaderOptions.extraHeaders!)) {
     if (!isValidHeaderName(name)) {
@@ -414,6 +416,10 @@ export class ClientRequest extends Writable implements Electron.ClientRequest {
     this._urlLoader.on('response-started', (event, finalUrl, responseHead) => {
       const response = this._response = new IncomingMessage(responseHead);
       this.emit('response', response);
+      if (this._urlLoaderOptions.downloadPath) {
+        // The body goes to the file, so the response only has to emit 'end'.
+        response.resume();
+      }
     });
     this._urlLoader.on('data', (event, data, resume) => {
       this._response!._storeInternalData(Buffer.from(data), resume);
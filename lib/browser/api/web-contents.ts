@@ -1,7 +1,9 @@
 import { app, ipcMain, session, deprecate, BrowserWindowConstructorOptions } from 'electron/main';
 import type { MenuItem, MenuItemConstructorOptions, LoadURLOptions } from 'electron/main';
 
+import { pipeline, Readable } from 'stream';
 import * as url from 'url';
+import * as zlib from 'zlib';
 import * as path from 'path';
 import { openGuestWindow, makeWebPreferences } from '@electron/internal/browser/guest-window-manager';
 import { NavigationController } from '@electron/internal/browser/navigation-controller';
@@ -424,6 +426,21 @@ WebContents.prototype.getPrinters = function () {
   }
 };
 
+WebContents.prototype.takeHeapSnapshotStream = function (options = {}) {
+  const source = this._takeHeapSnapshotStream();
+  const stream = new Readable({
+    read () {
+      source.read().then(chunk => { this.push(chunk); }, error => { this.destroy(error); });
+    },
+    destroy (error, callback) {
+      // Makes the renderer stop serializing the snapshot.
+      source.cancel();
+      callback(error);
+    }
+  });
+  return options.compress ? pipeline(stream, zlib.createGzip(), () => {}) : stream;
+};
+
 WebContents.prototype.loadFile = function (filePath, options = {}) {
   if (typeof filePath !== 'string') {
     throw new Error('Must pass filePath as a string');
@@ -748,3 +765,60 @@ export function getFocusedWebContents () {
 export function getAllWebContents () {
   return binding.getAllWebContents();
 }
+
+export function getRendererResourceUsage (): Promise<Electron.RendererResourceUsage[]> {
+  return binding.getRendererResourceUsage();
+}
+
+export function subscribeRendererResourceUsage (options: { interval: number }, listener: (usage: Electron.RendererResourceUsage[]) => void) {
+  const interval = options && options.interval;
+  if (typeof interval !== 'number' || interval < 100) {
+    throw new Error('interval must be a number of at least 100 milliseconds');
+  }
+  if (typeof listener !== 'function') {
+    throw new Error('listener must be a function');
+  }
+
+  type IPCCounters = Electron.RendererResourceUsage['ipc'][0];
+  let previous = new Map<number, IPCCounters>();
+  let timer: NodeJS.Timeout | null = null;
+  let stopped = false;
+
+  const update = async (notify: boolean) => {
+    const usage = await binding.getRendererResourceUsage() as Electron.RendererResourceUsage[];
+    if (stopped) return;
+    const counters = new Map<number, IPCCounters>();
+    for (const renderer of usage) {
+      renderer.ipc = renderer.ipc.map(current => {
+        counters.set(current.webContentsId, current);
+        // A WebContents created since the previous update reports all of its
+        // messages.
+        const last = previous.get(current.webContentsId);
+        if (!last) return current;
+        return {
+          webContentsId: current.webContentsId,
+          messagesReceived: current.messagesReceived - last.messagesReceived,
+          bytesReceived: current.bytesReceived - last.bytesReceived,
+          messagesSent: current.messagesSent - last.messagesSent,
+          bytesSent: current.bytesSent - last.bytesSent
+        };
+      });
+    }
+    // A WebContents can be missing from an update, e.g. while its renderer is
+    // hung or being replaced, keep its counters until it is destroyed so the
+    // next update still reports a delta.
+    for (const [id, last] of previous) {
+      if (!counters.has(id) && binding.fromId(id)) counters.set(id, last);
+    }
+    previous = counters;
+    // Not setInterval, so a slow renderer does not pile up requests.
+    timer = setTimeout(() => update(true), interval);
+    if (notify) listener(usage);
+  };
+  update(false);
+
+  return () => {
+    stopped = true;
+    if (timer) clearTimeout(timer);
+  };
+}
@@ -4,6 +4,7 @@
 
 #include "shell/browser/api/electron_api_app.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <string>
@@ -41,6 +42,7 @@
 #include "shell/browser/electron_browser_main_parts.h"
 #include "shell/browser/javascript_environment.h"
 #include "shell/browser/login_handler.h"
+#include "shell/browser/long_task_monitor.h"
 #include "shell/browser/relauncher.h"
 #include "shell/common/application_info.h"
 #include "shell/common/electron_command_line.h"
@@ -402,6 +404,73 @@ struct Converter<Browser::LoginItemSettings> {
   }
 };
 
+template <>
+struct Converter<electron::ProcessMetricsSampler::Metric> {
+  static v8::Local<v8::Value> ToV8(
+      v8::Isolate* isolate,
+      electron::ProcessMetricsSampler::Metric metric) {
+    switch (metric) {
+      case electron::ProcessMetricsSampler::Metric::kCPUUsage:
+        return StringToV8(isolate, "percentCPUUsage");
+      case electron::ProcessMetricsSampler::Metric::kWorkingSetSize:
+        return StringToV8(isolate, "workingSetSize");
+    }
+    NOTREACHED();
+    return v8::Undefined(isolate);
+  }
+
+  static bool FromV8(v8::Isolate* isolate,
+                     v8::Local<v8::Value> val,
+                     electron::ProcessMetricsSampler::Metric* out) {
+    std::string metric;
+    if (!ConvertFromV8(isolate, val, &metric))
+      return false;
+    if (metric == "percentCPUUsage") {
+      *out = electron::ProcessMetricsSampler::Metric::kCPUUsage;
+    } else if (metric == "workingSetSize") {
+      *out = electron::ProcessMetricsSampler::Metric::kWorkingSetSize;
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+template <>
+struct Converter<electron::ProcessMetricsSampler::Threshold> {
+  static bool FromV8(v8::Isolate* isolate,
+                     v8::Local<v8::Value> val,
+                     electron::ProcessMetricsSampler::Threshold* out) {
+    gin_helper::Dictionary dict;
+    if (!ConvertFromV8(isolate, val, &dict))
+      return false;
+    dict.Get("processType", &(out->process_type));
+    return dict.Get("metric", &(out->metric)) &&
+           dict.Get("value", &(out->value));
+  }
+};
+
+template <>
+struct Converter<electron::LongTaskMonitor::Source> {
+  static v8::Local<v8::Value> ToV8(v8::Isolate* isolate,
+                                   electron::LongTaskMonitor::Source source) {
+    switch (source) {
+      case electron::LongTaskMonitor::Source::kTask:
+        return StringToV8(isolate, "task");
+      case electron::LongTaskMonitor::Source::kUv:
+        return StringToV8(isolate, "uv");
+      case electron::LongTaskMonitor::Source::kIPC:
+        return StringToV8(isolate, "ipc");
+      case electron::LongTaskMonitor::Source::kMojo:
+        return StringToV8(isolate, "mojo");
+      case electron::LongTaskMonitor::Source::kTimer:
+        return StringToV8(isolate, "timer");
+    }
+    NOTREACHED();
+    return v8::Undefined(isolate);
+  }
+};
+
 template <>
 struct Converter<content::CertificateRequestResultType> {
   static bool FromV8(v8::Isolate* isolate,
@@ -907,10 +976,14 @@ void App::ChildProcessLaunched(int process_type,
 #endif
   app_metrics_[pid] = std::make_unique<electron::ProcessMetric>(
       process_type, handle, std::move(metrics), service_name, name);
+  if (metrics_sampler_)
+    metrics_sampler_->AddProcess(pid, *app_metrics_[pid]);
 }
 
 void App::ChildProcessDisconnected(base::ProcessId pid) {
   app_metrics_.erase(pid);
+  if (metrics_sampler_)
+    metrics_sampler_->RemoveProcess(pid);
 }
 
 base::FilePath App::GetAppPath() const {
@@ -1393,6 +1466,204 @@ std::vector<gin_helper::Dictionary> App::GetAppMetrics(v8::Isolate* isolate) {
   return result;
 }
 
+void App::StartMetricsSampling(gin::Arguments* args) {
+  int interval = 1000;
+  int max_samples = 60;
+  std::vector<ProcessMetricsSampler::Threshold> thresholds;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    if ((options.Has("interval") && !options.Get("interval", &interval)) ||
+        (options.Has("maxSamples") &&
+         !options.Get("maxSamples", &max_samples)) ||
+        (options.Has("thresholds") &&
+         !options.Get("thresholds", &thresholds))) {
+      args->ThrowTypeError("Invalid metrics sampling options");
+      return;
+    }
+  }
+  if (interval < 100 || max_samples < 1) {
+    args->ThrowTypeError("Invalid metrics sampling options");
+    return;
+  }
+
+  metrics_sampler_ = std::make_unique<ProcessMetricsSampler>(
+      base::TimeDelta::FromMilliseconds(interval), max_samples,
+      std::move(thresholds),
+      base::BindRepeating(&App::OnMetricsThresholdExceeded,
+                          base::Unretained(this)));
+  for (const auto& process_metric : app_metrics_)
+    metrics_sampler_->AddProcess(process_metric.first, *process_metric.second);
+}
+
+void App::StopMetricsSampling() {
+  metrics_sampler_.reset();
+}
+
+bool App::IsMetricsSamplingEnabled() const {
+  return !!metrics_sampler_;
+}
+
+namespace {
+
+gin_helper::Dictionary CreateMetricsSample(
+    v8::Isolate* isolate,
+    const ProcessMetricsSampler::Sample& sample) {
+  gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+  dict.Set("time", sample.time.ToJsTime());
+  dict.Set("percentCPUUsage", sample.cpu_usage);
+  dict.Set("workingSetSize", sample.working_set_size);
+  dict.Set("ioReadBytes", static_cast<double>(sample.io_read_bytes));
+  dict.Set("ioWriteBytes", static_cast<double>(sample.io_write_bytes));
+  return dict;
+}
+
+}  // namespace
+
+std::vector<gin_helper::Dictionary> App::GetMetricsSnapshot(
+    v8::Isolate* isolate) {
+  std::vector<gin_helper::Dictionary> result;
+  if (!metrics_sampler_)
+    return result;
+
+  result.reserve(metrics_sampler_->histories().size());
+  for (const auto& it : metrics_sampler_->histories()) {
+    if (it.second.samples.empty())
+      continue;
+    gin_helper::Dictionary dict =
+        CreateMetricsSample(isolate, it.second.samples.back());
+    dict.Set("pid", it.first);
+    dict.Set("type", content::GetProcessTypeNameInEnglish(it.second.type));
+    result.push_back(dict);
+  }
+  return result;
+}
+
+std::vector<gin_helper::Dictionary> App::GetMetricsHistory(
+    gin::Arguments* args) {
+  std::vector<gin_helper::Dictionary> result;
+  if (!metrics_sampler_)
+    return result;
+
+  // Only the samples taken after |since|, so polling does not convert the
+  // same samples again.
+  double since = 0;
+  args->GetNext(&since);
+
+  v8::Isolate* isolate = args->isolate();
+  result.reserve(metrics_sampler_->histories().size());
+  for (const auto& it : metrics_sampler_->histories()) {
+    std::vector<gin_helper::Dictionary> samples;
+    for (auto sample = it.second.samples.rbegin();
+         sample != it.second.samples.rend() && sample->time.ToJsTime() > since;
+         ++sample)
+      samples.push_back(CreateMetricsSample(isolate, *sample));
+    std::reverse(samples.begin(), samples.end());
+
+    gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+    dict.Set("pid", it.first);
+    dict.Set("type", content::GetProcessTypeNameInEnglish(it.second.type));
+    dict.Set("samples", samples);
+    result.push_back(dict);
+  }
+  return result;
+}
+
+void App::OnMetricsThresholdExceeded(
+    base::ProcessId pid,
+    int type,
+    const ProcessMetricsSampler::Threshold& threshold,
+    double value) {
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  auto details = gin_helper::Dictionary::CreateEmpty(isolate);
+  details.Set("pid", pid);
+  details.Set("type", content::GetProcessTypeNameInEnglish(type));
+  details.Set("metric", threshold.metric);
+  details.Set("value", value);
+  details.Set("threshold", threshold.value);
+  Emit("process-metrics-threshold-exceeded", details);
+}
+
+void App::StartLongTaskMonitor(gin::Arguments* args) {
+  auto* monitor = LongTaskMonitor::Get();
+  if (!monitor) {
+    args->ThrowTypeError("The long task monitor is not available");
+    return;
+  }
+
+  double threshold = 50;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options) && options.Has("threshold") &&
+      !options.Get("threshold", &threshold)) {
+    args->ThrowTypeError("Invalid long task monitor options");
+    return;
+  }
+  if (threshold <= 0) {
+    args->ThrowTypeError("Invalid long task monitor options");
+    return;
+  }
+
+  monitor->Start(
+      base::TimeDelta::FromMillisecondsD(threshold),
+      base::BindRepeating(&App::OnLongTask, base::Unretained(this)));
+}
+
+void App::StopLongTaskMonitor() {
+  auto* monitor = LongTaskMonitor::Get();
+  if (monitor)
+    monitor->Stop();
+}
+
+bool App::IsLongTaskMonitorRunning() const {
+  auto* monitor = LongTaskMonitor::Get();
+  return monitor && monitor->IsRunning();
+}
+
+v8::Local<v8::Value> App::GetLongTaskStats(v8::Isolate* isolate) {
+  gin_helper::Dictionary result = gin::Dictionary::CreateEmpty(isolate);
+  auto* monitor = LongTaskMonitor::Get();
+  if (!monitor)
+    return result.GetHandle();
+
+  for (size_t i = 0; i < LongTaskMonitor::kSourceCount; ++i) {
+    const LongTaskMonitor::Stats& stats = monitor->stats()[i];
+    std::vector<gin_helper::Dictionary> histogram;
+    for (size_t bucket = 0; bucket < stats.histogram.size(); ++bucket) {
+      gin_helper::Dictionary entry = gin::Dictionary::CreateEmpty(isolate);
+      entry.Set("min", bucket == 0
+                           ? 0
+                           : LongTaskMonitor::kBucketBoundaries[bucket - 1]);
+      if (bucket < LongTaskMonitor::kBucketBoundaries.size())
+        entry.Set("max", LongTaskMonitor::kBucketBoundaries[bucket]);
+      entry.Set("count", static_cast<double>(stats.histogram[bucket]));
+      histogram.push_back(entry);
+    }
+
+    gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+    dict.Set("count", static_cast<double>(stats.count));
+    dict.Set("longTaskCount", static_cast<double>(stats.long_task_count));
+    dict.Set("totalTime", stats.total_time.InMillisecondsF());
+    dict.Set("maxTime", stats.max_time.InMillisecondsF());
+    dict.Set("histogram", histogram);
+    result.Set(static_cast<LongTaskMonitor::Source>(i), dict);
+  }
+  return result.GetHandle();
+}
+
+void App::OnLongTask(const LongTaskMonitor::LongTask& long_task) {
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  // Reported in the same time base as the process metrics samples.
+  base::Time start_time =
+      base::Time::Now() - (base::TimeTicks::Now() - long_task.start_time);
+  auto details = gin_helper::Dictionary::CreateEmpty(isolate);
+  details.Set("source", long_task.source);
+  details.Set("detail", long_task.detail);
+  details.Set("startTime", start_time.ToJsTime());
+  details.Set("duration", long_task.duration.InMillisecondsF());
+  Emit("long-task", details);
+}
+
 v8::Local<v8::Value> App::GetGPUFeatureStatus(v8::Isolate* isolate) {
   auto status = content::GetFeatureStatus();
   base::DictionaryValue temp;
@@ -1656,6 +1927,15 @@ gin::ObjectTemplateBuilder App::GetObjectTemplateBuilder(v8::Isolate* isolate) {
                  &App::DisableDomainBlockingFor3DAPIs)
       .SetMethod("getFileIcon", &App::GetFileIcon)
       .SetMethod("getAppMetrics", &App::GetAppMetrics)
+      .SetMethod("startMetricsSampling", &App::StartMetricsSampling)
+      .SetMethod("stopMetricsSampling", &App::StopMetricsSampling)
+      .SetMethod("isMetricsSamplingEnabled", &App::IsMetricsSamplingEnabled)
+      .SetMethod("getMetricsSnapshot", &App::GetMetricsSnapshot)
+      .SetMethod("getMetricsHistory", &App::GetMetricsHistory)
+      .SetMethod("startLongTaskMonitor", &App::StartLongTaskMonitor)
+      .SetMethod("stopLongTaskMonitor", &App::StopLongTaskMonitor)
+      .SetMethod("isLongTaskMonitorRunning", &App::IsLongTaskMonitorRunning)
+      .SetMethod("getLongTaskStats", &App::GetLongTaskStats)
       .SetMethod("getGPUFeatureStatus", &App::GetGPUFeatureStatus)
       .SetMethod("getGPUInfo", &App::GetGPUInfo)
 #if defined(MAS_BUILD)
@@ -22,10 +22,12 @@
 #include "net/base/completion_repeating_callback.h"
 #include "net/ssl/client_cert_identity.h"
 #include "shell/browser/api/process_metric.h"
+#include "shell/browser/api/process_metrics_sampler.h"
 #include "shell/browser/browser.h"
 #include "shell/browser/browser_observer.h"
 #include "shell/browser/electron_browser_client.h"
 #include "shell/browser/event_emitter_mixin.h"
+#include "shell/browser/long_task_monitor.h"
 #include "shell/common/gin_helper/dictionary.h"
 #include "shell/common/gin_helper/error_thrower.h"
 #include "shell/common/gin_helper/promise.h"
@@ -206,6 +208,21 @@ class App : public ElectronBrowserClient::Delegate,
                                      gin::Arguments* args);
 
   std::vector<gin_helper::Dictionary> GetAppMetrics(v8::Isolate* isolate);
+  void StartMetricsSampling(gin::Arguments* args);
+  void StopMetricsSampling();
+  bool IsMetricsSamplingEnabled() const;
+  std::vector<gin_helper::Dictionary> GetMetricsSnapshot(v8::Isolate* isolate);
+  std::vector<gin_helper::Dictionary> GetMetricsHistory(gin::Arguments* args);
+  void OnMetricsThresholdExceeded(
+      base::ProcessId pid,
+      int type,
+      const ProcessMetricsSampler::Threshold& threshold,
+      double value);
+  void StartLongTaskMonitor(gin::Arguments* args);
+  void StopLongTaskMonitor();
+  bool IsLongTaskMonitorRunning() const;
+  v8::Local<v8::Value> GetLongTaskStats(v8::Isolate* isolate);
+  void OnLongTask(const LongTaskMonitor::LongTask& long_task);
   v8::Local<v8::Value> GetGPUFeatureStatus(v8::Isolate* isolate);
   v8::Local<v8::Promise> GetGPUInfo(v8::Isolate* isolate,
                                     const std::string& info_type);
@@ -253,6 +270,8 @@ class App : public ElectronBrowserClient::Delegate,
       std::unordered_map<base::ProcessId,
                          std::unique_ptr<electron::ProcessMetric>>;
   ProcessMetricMap app_metrics_;
+  // Only set while the metrics are sampled in the background.
+  std::unique_ptr<ProcessMetricsSampler> metrics_sampler_;
 
   bool disable_hw_acceleration_ = false;
   bool disable_domain_blocking_for_3DAPIs_ = false;
@@ -2,17 +2,23 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <iterator>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "base/callback_helpers.h"
 #include "base/files/file_util.h"
+#include "base/no_destructor.h"
 #include "base/optional.h"
+#include "base/strings/string_util.h"
 #include "base/task/thread_pool.h"
 #include "base/threading/thread_restrictions.h"
 #include "content/public/browser/tracing_controller.h"
 #include "shell/common/gin_converters/callback_converter.h"
 #include "shell/common/gin_converters/file_path_converter.h"
+#include "shell/common/gin_converters/std_converter.h"
 #include "shell/common/gin_converters/value_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
 #include "shell/common/gin_helper/promise.h"
@@ -78,10 +84,32 @@ void StopTracing(gin_helper::Promise<base::FilePath> promise,
   }
 }
 
+// The state of the flight recorder, a continuous trace into a ring buffer
+// that is only written out on demand. Only accessed on the UI thread.
+struct FlightRecorder {
+  bool running = false;
+  bool dumping = false;
+  base::trace_event::TraceConfig config;
+  // Waiting for the dump in progress.
+  std::vector<gin_helper::Promise<base::FilePath>> dump_promises;
+  std::vector<gin_helper::Promise<void>> stop_promises;
+};
+
+FlightRecorder& GetFlightRecorder() {
+  static base::NoDestructor<FlightRecorder> flight_recorder;
+  return *flight_recorder;
+}
+
 v8::Local<v8::Promise> StopRecording(gin_helper::Arguments* args) {
   gin_helper::Promise<base::FilePath> promise(args->isolate());
   v8::Local<v8::Promise> handle = promise.GetHandle();
 
+  if (GetFlightRecorder().running) {
+    promise.RejectWithErrorMessage(
+        "Cannot stop recording while the flight recorder is running");
+    return handle;
+  }
+
   base::FilePath path;
   if (args->GetNext(&path) && !path.empty()) {
     StopTracing(std::move(promise), base::make_optional(path));
@@ -114,6 +142,12 @@ v8::Local<v8::Promise> StartTracing(
   gin_helper::Promise<void> promise(isolate);
   v8::Local<v8::Promise> handle = promise.GetHandle();
 
+  if (GetFlightRecorder().running) {
+    promise.RejectWithErrorMessage(
+        "Cannot start recording while the flight recorder is running");
+    return handle;
+  }
+
   if (!TracingController::GetInstance()->StartTracing(
           trace_config,
           base::BindOnce(gin_helper::Promise<void>::ResolvePromise,
@@ -148,6 +182,160 @@ v8::Local<v8::Promise> GetTraceBufferUsage(v8::Isolate* isolate) {
   return handle;
 }
 
+// Keeps the events of few categories in a ring buffer, so the overhead stays
+// low enough to leave it on.
+constexpr const char* kDefaultFlightRecorderCategories[] = {"electron",
+                                                             "toplevel", "ipc"};
+constexpr int kDefaultFlightRecorderBufferSizeInKb = 4096;
+
+v8::Local<v8::Promise> StartFlightRecorder(gin_helper::Arguments* args) {
+  gin_helper::Promise<void> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  std::vector<std::string> categories(
+      std::begin(kDefaultFlightRecorderCategories),
+      std::end(kDefaultFlightRecorderCategories));
+  int buffer_size = kDefaultFlightRecorderBufferSizeInKb;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    options.Get("categories", &categories);
+    options.Get("bufferSize", &buffer_size);
+  }
+  if (categories.empty() || buffer_size <= 0) {
+    args->ThrowError("Invalid flight recorder options");
+    return v8::Local<v8::Promise>();
+  }
+
+  FlightRecorder& flight_recorder = GetFlightRecorder();
+  if (flight_recorder.running) {
+    promise.RejectWithErrorMessage("Flight recorder is already running");
+    return handle;
+  }
+  if (TracingController::GetInstance()->IsTracing()) {
+    promise.RejectWithErrorMessage(
+        "Cannot start the flight recorder while recording");
+    return handle;
+  }
+
+  base::trace_event::TraceConfig config(
+      base::JoinString(categories, ","),
+      base::trace_event::RECORD_CONTINUOUSLY);
+  config.SetTraceBufferSizeInKb(buffer_size);
+  if (!TracingController::GetInstance()->StartTracing(
+          config, base::BindOnce(gin_helper::Promise<void>::ResolvePromise,
+                                 std::move(promise)))) {
+    // The callback, and the promise moved into it, were dropped.
+    gin_helper::Promise<void> failed(args->isolate());
+    v8::Local<v8::Promise> failed_handle = failed.GetHandle();
+    failed.RejectWithErrorMessage("Failed to start the flight recorder");
+    return failed_handle;
+  }
+  flight_recorder.config = config;
+  flight_recorder.running = true;
+  return handle;
+}
+
+void OnFlightRecorderStopped(std::unique_ptr<std::string> data) {
+  auto promises = std::move(GetFlightRecorder().stop_promises);
+  for (auto& promise : promises)
+    promise.Resolve();
+}
+
+void StopFlightRecorderTracing() {
+  // The events are dropped.
+  TracingController::GetInstance()->StopTracing(
+      TracingController::CreateStringEndpoint(
+          base::BindOnce(&OnFlightRecorderStopped)));
+}
+
+void OnFlightRecorderDumped(const base::FilePath& path) {
+  FlightRecorder& flight_recorder = GetFlightRecorder();
+  flight_recorder.dumping = false;
+
+  // Stopping the trace cleared the ring buffer, so recording starts over.
+  if (flight_recorder.running) {
+    if (!TracingController::GetInstance()->StartTracing(flight_recorder.config,
+                                                        base::DoNothing()))
+      flight_recorder.running = false;
+  } else if (!flight_recorder.stop_promises.empty()) {
+    OnFlightRecorderStopped(nullptr);
+  }
+
+  auto promises = std::move(flight_recorder.dump_promises);
+  for (auto& promise : promises)
+    promise.Resolve(path);
+}
+
+void DumpFlightRecorderToFile(base::Optional<base::FilePath> file_path) {
+  FlightRecorder& flight_recorder = GetFlightRecorder();
+  if (!file_path) {
+    flight_recorder.dumping = false;
+    auto promises = std::move(flight_recorder.dump_promises);
+    for (auto& promise : promises)
+      promise.RejectWithErrorMessage(
+          "Failed to create temporary file for trace data");
+    if (!flight_recorder.running && !flight_recorder.stop_promises.empty())
+      StopFlightRecorderTracing();
+    return;
+  }
+
+  auto endpoint = TracingController::CreateFileEndpoint(
+      *file_path, base::AdaptCallbackForRepeating(base::BindOnce(
+                      &OnFlightRecorderDumped, *file_path)));
+  TracingController::GetInstance()->StopTracing(endpoint);
+}
+
+v8::Local<v8::Promise> DumpFlightRecorder(gin_helper::Arguments* args) {
+  gin_helper::Promise<base::FilePath> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  FlightRecorder& flight_recorder = GetFlightRecorder();
+  if (!flight_recorder.running) {
+    promise.RejectWithErrorMessage("Flight recorder is not running");
+    return handle;
+  }
+
+  // Concurrent requests share the dump in progress.
+  flight_recorder.dump_promises.push_back(std::move(promise));
+  if (flight_recorder.dumping)
+    return handle;
+  flight_recorder.dumping = true;
+
+  base::FilePath path;
+  if (args->GetNext(&path) && !path.empty()) {
+    DumpFlightRecorderToFile(base::make_optional(path));
+  } else {
+    base::ThreadPool::PostTaskAndReplyWithResult(
+        FROM_HERE, {base::MayBlock(), base::TaskPriority::USER_VISIBLE},
+        base::BindOnce(CreateTemporaryFileOnIO),
+        base::BindOnce(DumpFlightRecorderToFile));
+  }
+
+  return handle;
+}
+
+v8::Local<v8::Promise> StopFlightRecorder(v8::Isolate* isolate) {
+  gin_helper::Promise<void> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  FlightRecorder& flight_recorder = GetFlightRecorder();
+  if (!flight_recorder.running) {
+    promise.RejectWithErrorMessage("Flight recorder is not running");
+    return handle;
+  }
+
+  flight_recorder.running = false;
+  flight_recorder.stop_promises.push_back(std::move(promise));
+  // Otherwise the trace is not restarted after the dump.
+  if (!flight_recorder.dumping)
+    StopFlightRecorderTracing();
+  return handle;
+}
+
+bool IsFlightRecorderRunning() {
+  return GetFlightRecorder().running;
+}
+
 void Initialize(v8::Local<v8::Object> exports,
                 v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context,
@@ -157,6 +345,10 @@ void Initialize(v8::Local<v8::Object> exports,
   dict.SetMethod("startRecording", &StartTracing);
   dict.SetMethod("stopRecording", &StopRecording);
   dict.SetMethod("getTraceBufferUsage", &GetTraceBufferUsage);
+  dict.SetMethod("startFlightRecorder", &StartFlightRecorder);
+  dict.SetMethod("dumpFlightRecorder", &DumpFlightRecorder);
+  dict.SetMethod("stopFlightRecorder", &StopFlightRecorder);
+  dict.SetMethod("isFlightRecorderRunning", &IsFlightRecorderRunning);
 }
 
 }  // namespace
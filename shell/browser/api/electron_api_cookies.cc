@@ -5,8 +5,13 @@
 #include "shell/browser/api/electron_api_cookies.h"
 
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "base/time/time.h"
 #include "base/values.h"
 #include "content/public/browser/browser_context.h"
@@ -100,51 +105,73 @@ namespace api {
 
 namespace {
 
-// Returns whether |domain| matches |filter|.
-bool MatchesDomain(std::string filter, const std::string& domain) {
-  // Add a leading '.' character to the filter domain if it doesn't exist.
-  if (net::cookie_util::DomainIsHostOnly(filter))
-    filter.insert(0, ".");
+// The properties of a cookies.get() filter, parsed once per query instead of
+// once per cookie.
+struct CookieFilter {
+  explicit CookieFilter(const base::Value& filter) {
+    const std::string* str;
+    if ((str = filter.FindStringKey("name")))
+      name = *str;
+    if ((str = filter.FindStringKey("path")))
+      path = *str;
+    if ((str = filter.FindStringKey("domain"))) {
+      // Add a leading '.' character to the filter domain if it doesn't exist.
+      domain = *str;
+      if (net::cookie_util::DomainIsHostOnly(*domain))
+        domain->insert(0, ".");
+    }
+    secure = filter.FindBoolKey("secure");
+    session = filter.FindBoolKey("session");
+  }
 
-  std::string sub_domain(domain);
-  // Strip any leading '.' character from the input cookie domain.
-  if (!net::cookie_util::DomainIsHostOnly(sub_domain))
-    sub_domain = sub_domain.substr(1);
-
-  // Now check whether the domain argument is a subdomain of the filter domain.
-  for (sub_domain.insert(0, "."); sub_domain.length() >= filter.length();) {
-    if (sub_domain == filter)
-      return true;
-    const size_t next_dot = sub_domain.find('.', 1);  // Skip over leading dot.
-    sub_domain.erase(0, next_dot);
+  bool empty() const {
+    return !name && !path && !domain && !secure && !session;
   }
-  return false;
+
+  base::Optional<std::string> name;
+  base::Optional<std::string> path;
+  base::Optional<std::string> domain;
+  base::Optional<bool> secure;
+  base::Optional<bool> session;
+};
+
+// Returns whether |domain| matches |filter|, which starts with a '.'.
+bool MatchesDomain(base::StringPiece filter, base::StringPiece domain) {
+  // Strip any leading '.' character from the input cookie domain.
+  if (!domain.empty() && domain[0] == '.')
+    domain.remove_prefix(1);
+
+  // Now check whether the domain argument is the filter domain or one of its
+  // subdomains.
+  return domain == filter.substr(1) ||
+         base::EndsWith(domain, filter, base::CompareCase::SENSITIVE);
 }
 
 // Returns whether |cookie| matches |filter|.
-bool MatchesCookie(const base::Value& filter,
+bool MatchesCookie(const CookieFilter& filter,
                    const net::CanonicalCookie& cookie) {
-  const std::string* str;
-  if ((str = filter.FindStringKey("name")) && *str != cookie.Name())
+  if (filter.name && *filter.name != cookie.Name())
     return false;
-  if ((str = filter.FindStringKey("path")) && *str != cookie.Path())
+  if (filter.path && *filter.path != cookie.Path())
     return false;
-  if ((str = filter.FindStringKey("domain")) &&
-      !MatchesDomain(*str, cookie.Domain()))
+  if (filter.domain && !MatchesDomain(*filter.domain, cookie.Domain()))
     return false;
-  base::Optional<bool> secure_filter = filter.FindBoolKey("secure");
-  if (secure_filter && *secure_filter == cookie.IsSecure())
+  if (filter.secure && *filter.secure == cookie.IsSecure())
     return false;
-  base::Optional<bool> session_filter = filter.FindBoolKey("session");
-  if (session_filter && *session_filter != !cookie.IsPersistent())
+  if (filter.session && *filter.session != !cookie.IsPersistent())
     return false;
   return true;
 }
 
 // Remove cookies from |list| not matching |filter|, and pass it to |callback|.
-void FilterCookies(const base::Value& filter,
+void FilterCookies(const CookieFilter& filter,
                    gin_helper::Promise<net::CookieList> promise,
                    const net::CookieList& cookies) {
+  if (filter.empty()) {
+    promise.Resolve(cookies);
+    return;
+  }
+
   net::CookieList result;
   for (const auto& cookie : cookies) {
     if (MatchesCookie(filter, cookie))
@@ -154,7 +181,7 @@ void FilterCookies(const base::Value& filter,
 }
 
 void FilterCookieWithStatuses(
-    const base::Value& filter,
+    const CookieFilter& filter,
     gin_helper::Promise<net::CookieList> promise,
     const net::CookieAccessResultList& list,
     const net::CookieAccessResultList& excluded_list) {
@@ -162,6 +189,38 @@ void FilterCookieWithStatuses(
                 net::cookie_util::StripAccessResults(list));
 }
 
+// Settles |promise| once every cookie of a batch has been set or removed,
+// rejecting it with the first error if any.
+class BatchResult : public base::RefCounted<BatchResult> {
+ public:
+  BatchResult(gin_helper::Promise<void> promise, size_t count)
+      : promise_(std::move(promise)), remaining_(count) {
+    if (remaining_ == 0)
+      promise_.Resolve();
+  }
+
+  void Done(const std::string& error) {
+    if (error_.empty())
+      error_ = error;
+    if (--remaining_ > 0)
+      return;
+    if (error_.empty())
+      promise_.Resolve();
+    else
+      promise_.RejectWithErrorMessage(error_);
+  }
+
+ private:
+  friend class base::RefCounted<BatchResult>;
+  ~BatchResult() = default;
+
+  gin_helper::Promise<void> promise_;
+  size_t remaining_;
+  std::string error_;
+
+  DISALLOW_COPY_AND_ASSIGN(BatchResult);
+};
+
 // Parse dictionary property to CanonicalCookie time correctly.
 base::Time ParseTimeProperty(const base::Optional<double>& value) {
   if (!value)  // empty time means ignoring the parameter
@@ -214,6 +273,60 @@ std::string StringToCookieSameSite(const std::string* str_ptr,
   return "";
 }
 
+// Creates the cookie described by |details| of cookies.set(), and the |url|
+// and |options| to set it with, or sets |error|.
+std::unique_ptr<net::CanonicalCookie> CreateCookie(
+    const base::Value& details,
+    GURL* url,
+    net::CookieOptions* options,
+    std::string* error) {
+  const std::string* url_string = details.FindStringKey("url");
+  if (!url_string) {
+    *error = "Missing required option 'url'";
+    return nullptr;
+  }
+  const std::string* name = details.FindStringKey("name");
+  const std::string* value = details.FindStringKey("value");
+  const std::string* domain = details.FindStringKey("domain");
+  const std::string* path = details.FindStringKey("path");
+  bool secure = details.FindBoolKey("secure").value_or(false);
+  bool http_only = details.FindBoolKey("httpOnly").value_or(false);
+  const std::string* same_site_string = details.FindStringKey("sameSite");
+  net::CookieSameSite same_site;
+  *error = StringToCookieSameSite(same_site_string, &same_site);
+  if (!error->empty())
+    return nullptr;
+  bool same_party =
+      details.FindBoolKey("sameParty")
+          .value_or(secure && same_site != net::CookieSameSite::STRICT_MODE);
+
+  *url = GURL(*url_string);
+  if (!url->is_valid()) {
+    *error = InclusionStatusToString(net::CookieInclusionStatus(
+        net::CookieInclusionStatus::EXCLUDE_INVALID_DOMAIN));
+    return nullptr;
+  }
+
+  auto canonical_cookie = net::CanonicalCookie::CreateSanitizedCookie(
+      *url, name ? *name : "", value ? *value : "", domain ? *domain : "",
+      path ? *path : "",
+      ParseTimeProperty(details.FindDoubleKey("creationDate")),
+      ParseTimeProperty(details.FindDoubleKey("expirationDate")),
+      ParseTimeProperty(details.FindDoubleKey("lastAccessDate")), secure,
+      http_only, same_site, net::COOKIE_PRIORITY_DEFAULT, same_party);
+  if (!canonical_cookie || !canonical_cookie->IsCanonical()) {
+    *error = InclusionStatusToString(net::CookieInclusionStatus(
+        net::CookieInclusionStatus::EXCLUDE_FAILURE_TO_STORE));
+    return nullptr;
+  }
+
+  if (http_only)
+    options->set_include_httponly();
+  options->set_same_site_cookie_context(
+      net::CookieOptions::SameSiteCookieContext::MakeInclusive());
+  return canonical_cookie;
+}
+
 }  // namespace
 
 gin::WrapperInfo Cookies::kWrapperInfo = {gin::kEmbedderNativeGin};
@@ -239,12 +352,14 @@ v8::Local<v8::Promise> Cookies::Get(v8::Isolate* isolate,
 
   base::DictionaryValue dict;
   gin::ConvertFromV8(isolate, filter.GetHandle(), &dict);
+  CookieFilter cookie_filter(dict);
 
   std::string url;
   filter.Get("url", &url);
   if (url.empty()) {
     manager->GetAllCookies(
-        base::BindOnce(&FilterCookies, std::move(dict), std::move(promise)));
+        base::BindOnce(&FilterCookies, std::move(cookie_filter),
+                       std::move(promise)));
   } else {
     net::CookieOptions options;
     options.set_include_httponly();
@@ -254,7 +369,8 @@ v8::Local<v8::Promise> Cookies::Get(v8::Isolate* isolate,
 
     manager->GetCookieList(GURL(url), options,
                            base::BindOnce(&FilterCookieWithStatuses,
-                                          std::move(dict), std::move(promise)));
+                                          std::move(cookie_filter),
+                                          std::move(promise)));
   }
 
   return handle;
@@ -290,54 +406,14 @@ v8::Local<v8::Promise> Cookies::Set(v8::Isolate* isolate,
   gin_helper::Promise<void> promise(isolate);
   v8::Local<v8::Promise> handle = promise.GetHandle();
 
-  const std::string* url_string = details.FindStringKey("url");
-  if (!url_string) {
-    promise.RejectWithErrorMessage("Missing required option 'url'");
-  }
-  const std::string* name = details.FindStringKey("name");
-  const std::string* value = details.FindStringKey("value");
-  const std::string* domain = details.FindStringKey("domain");
-  const std::string* path = details.FindStringKey("path");
-  bool secure = details.FindBoolKey("secure").value_or(false);
-  bool http_only = details.FindBoolKey("httpOnly").value_or(false);
-  const std::string* same_site_string = details.FindStringKey("sameSite");
-  net::CookieSameSite same_site;
-  std::string error = StringToCookieSameSite(same_site_string, &same_site);
-  if (!error.empty()) {
+  GURL url;
+  net::CookieOptions options;
+  std::string error;
+  auto canonical_cookie = CreateCookie(details, &url, &options, &error);
+  if (!canonical_cookie) {
     promise.RejectWithErrorMessage(error);
     return handle;
   }
-  bool same_party =
-      details.FindBoolKey("sameParty")
-          .value_or(secure && same_site != net::CookieSameSite::STRICT_MODE);
-
-  GURL url(url_string ? *url_string : "");
-  if (!url.is_valid()) {
-    promise.RejectWithErrorMessage(
-        InclusionStatusToString(net::CookieInclusionStatus(
-            net::CookieInclusionStatus::EXCLUDE_INVALID_DOMAIN)));
-    return handle;
-  }
-
-  auto canonical_cookie = net::CanonicalCookie::CreateSanitizedCookie(
-      url, name ? *name : "", value ? *value : "", domain ? *domain : "",
-      path ? *path : "",
-      ParseTimeProperty(details.FindDoubleKey("creationDate")),
-      ParseTimeProperty(details.FindDoubleKey("expirationDate")),
-      ParseTimeProperty(details.FindDoubleKey("lastAccessDate")), secure,
-      http_only, same_site, net::COOKIE_PRIORITY_DEFAULT, same_party);
-  if (!canonical_cookie || !canonical_cookie->IsCanonical()) {
-    promise.RejectWithErrorMessage(
-        InclusionStatusToString(net::CookieInclusionStatus(
-            net::CookieInclusionStatus::EXCLUDE_FAILURE_TO_STORE)));
-    return handle;
-  }
-  net::CookieOptions options;
-  if (http_only) {
-    options.set_include_httponly();
-  }
-  options.set_same_site_cookie_context(
-      net::CookieOptions::SameSiteCookieContext::MakeInclusive());
 
   auto* storage_partition =
       content::BrowserContext::GetDefaultStoragePartition(browser_context_);
@@ -357,6 +433,96 @@ v8::Local<v8::Promise> Cookies::Set(v8::Isolate* isolate,
   return handle;
 }
 
+v8::Local<v8::Promise> Cookies::SetMany(v8::Isolate* isolate,
+                                        const base::ListValue& cookies) {
+  gin_helper::Promise<void> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  // Validate the whole batch first, so that it is either rejected or sent to
+  // the cookie manager in one go.
+  struct PendingCookie {
+    std::unique_ptr<net::CanonicalCookie> cookie;
+    GURL url;
+    net::CookieOptions options;
+  };
+  std::vector<PendingCookie> pending(cookies.GetList().size());
+  for (size_t i = 0; i < pending.size(); ++i) {
+    std::string error;
+    const base::Value& details = cookies.GetList()[i];
+    if (details.is_dict()) {
+      pending[i].cookie = CreateCookie(details, &pending[i].url,
+                                       &pending[i].options, &error);
+    } else {
+      error = "Expected an object";
+    }
+    if (!pending[i].cookie) {
+      promise.RejectWithErrorMessage(error);
+      return handle;
+    }
+  }
+
+  auto result =
+      base::MakeRefCounted<BatchResult>(std::move(promise), pending.size());
+  auto* storage_partition =
+      content::BrowserContext::GetDefaultStoragePartition(browser_context_);
+  auto* manager = storage_partition->GetCookieManagerForBrowserProcess();
+  for (const auto& it : pending) {
+    manager->SetCanonicalCookie(
+        *it.cookie, it.url, it.options,
+        base::BindOnce(
+            [](scoped_refptr<BatchResult> result, net::CookieAccessResult r) {
+              result->Done(r.status.IsInclude()
+                               ? std::string()
+                               : InclusionStatusToString(r.status));
+            },
+            result));
+  }
+
+  return handle;
+}
+
+v8::Local<v8::Promise> Cookies::RemoveMany(v8::Isolate* isolate,
+                                           const base::ListValue& cookies) {
+  gin_helper::Promise<void> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  std::vector<network::mojom::CookieDeletionFilterPtr> filters;
+  for (const auto& details : cookies.GetList()) {
+    const std::string* url = nullptr;
+    const std::string* name = nullptr;
+    if (details.is_dict()) {
+      url = details.FindStringKey("url");
+      name = details.FindStringKey("name");
+    }
+    if (!url || !name) {
+      promise.RejectWithErrorMessage(
+          "Expected objects with 'url' and 'name' properties");
+      return handle;
+    }
+    auto cookie_deletion_filter = network::mojom::CookieDeletionFilter::New();
+    cookie_deletion_filter->url = GURL(*url);
+    cookie_deletion_filter->cookie_name = *name;
+    filters.push_back(std::move(cookie_deletion_filter));
+  }
+
+  auto result =
+      base::MakeRefCounted<BatchResult>(std::move(promise), filters.size());
+  auto* storage_partition =
+      content::BrowserContext::GetDefaultStoragePartition(browser_context_);
+  auto* manager = storage_partition->GetCookieManagerForBrowserProcess();
+  for (auto& filter : filters) {
+    manager->DeleteCookies(
+        std::move(filter),
+        base::BindOnce(
+            [](scoped_refptr<BatchResult> result, uint32_t num_deleted) {
+              result->Done(std::string());
+            },
+            result));
+  }
+
+  return handle;
+}
+
 v8::Local<v8::Promise> Cookies::FlushStore(v8::Isolate* isolate) {
   gin_helper::Promise<void> promise(isolate);
   v8::Local<v8::Promise> handle = promise.GetHandle();
@@ -378,6 +544,33 @@ void Cookies::OnCookieChanged(const net::CookieChangeInfo& change) {
        gin::ConvertToV8(isolate, change.cause),
        gin::ConvertToV8(isolate,
                         change.cause != net::CookieChangeCause::INSERTED));
+
+  // Changes arriving together, e.g. from setMany(), are also emitted at once
+  // from a later task.
+  if (pending_changes_.empty()) {
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(&Cookies::EmitChanges,
+                                  weak_factory_.GetWeakPtr()));
+  }
+  pending_changes_.push_back(change);
+}
+
+void Cookies::EmitChanges() {
+  std::vector<net::CookieChangeInfo> changes;
+  changes.swap(pending_changes_);
+
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope scope(isolate);
+  std::vector<v8::Local<v8::Value>> batch;
+  batch.reserve(changes.size());
+  for (const auto& change : changes) {
+    gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+    dict.Set("cookie", change.cookie);
+    dict.Set("cause", change.cause);
+    dict.Set("removed", change.cause != net::CookieChangeCause::INSERTED);
+    batch.push_back(dict.GetHandle());
+  }
+  Emit("changes", batch);
 }
 
 // static
@@ -393,6 +586,8 @@ gin::ObjectTemplateBuilder Cookies::GetObjectTemplateBuilder(
       .SetMethod("get", &Cookies::Get)
       .SetMethod("remove", &Cookies::Remove)
       .SetMethod("set", &Cookies::Set)
+      .SetMethod("setMany", &Cookies::SetMany)
+      .SetMethod("removeMany", &Cookies::RemoveMany)
       .SetMethod("flushStore", &Cookies::FlushStore);
 }
 
@@ -7,8 +7,10 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/callback_list.h"
+#include "base/memory/weak_ptr.h"
 #include "gin/handle.h"
 #include "net/cookies/canonical_cookie.h"
 #include "net/cookies/cookie_change_dispatcher.h"
@@ -18,7 +20,8 @@
 
 namespace base {
 class DictionaryValue;
-}
+class ListValue;
+}  // namespace base
 
 namespace gin_helper {
 class Dictionary;
@@ -57,12 +60,20 @@ class Cookies : public gin::Wrappable<Cookies>,
   v8::Local<v8::Promise> Remove(v8::Isolate*,
                                 const GURL& url,
                                 const std::string& name);
+  v8::Local<v8::Promise> SetMany(v8::Isolate*, const base::ListValue& cookies);
+  v8::Local<v8::Promise> RemoveMany(v8::Isolate*,
+                                    const base::ListValue& cookies);
   v8::Local<v8::Promise> FlushStore(v8::Isolate*);
 
   // CookieChangeNotifier subscription:
   void OnCookieChanged(const net::CookieChangeInfo& change);
 
  private:
+  void EmitChanges();
+
+  // Changes that have not been emitted yet.
+  std::vector<net::CookieChangeInfo> pending_changes_;
+
   std::unique_ptr<base::CallbackList<void(
       const net::CookieChangeInfo& change)>::Subscription>
       cookie_change_subscription_;
@@ -70,6 +81,8 @@ class Cookies : public gin::Wrappable<Cookies>,
   // Weak reference; ElectronBrowserContext is guaranteed to outlive us.
   ElectronBrowserContext* browser_context_;
 
+  base::WeakPtrFactory<Cookies> weak_factory_{this};
+
   DISALLOW_COPY_AND_ASSIGN(Cookies);
 };
 
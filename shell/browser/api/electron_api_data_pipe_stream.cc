@@ -0,0 +1,132 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/api/electron_api_data_pipe_stream.h"
+
+#include <utility>
+
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "gin/object_template_builder.h"
+#include "shell/common/node_includes.h"
+
+namespace electron {
+
+namespace api {
+
+gin::WrapperInfo DataPipeStream::kWrapperInfo = {gin::kEmbedderNativeGin};
+
+DataPipeStream::DataPipeStream(mojo::ScopedDataPipeConsumerHandle data_pipe)
+    : data_pipe_(std::move(data_pipe)),
+      handle_watcher_(FROM_HERE,
+                      mojo::SimpleWatcher::ArmingPolicy::MANUAL,
+                      base::SequencedTaskRunnerHandle::Get()) {
+  handle_watcher_.Watch(data_pipe_.get(), MOJO_HANDLE_SIGNAL_READABLE,
+                        base::BindRepeating(&DataPipeStream::OnHandleReadable,
+                                            base::Unretained(this)));
+}
+
+DataPipeStream::~DataPipeStream() = default;
+
+// static
+gin::Handle<DataPipeStream> DataPipeStream::Create(
+    v8::Isolate* isolate,
+    mojo::ScopedDataPipeConsumerHandle data_pipe) {
+  return gin::CreateHandle(isolate, new DataPipeStream(std::move(data_pipe)));
+}
+
+void DataPipeStream::SetResult(bool success, const std::string& error) {
+  if (success_)
+    return;
+  success_ = success;
+  error_ = error;
+  if (end_of_data_)
+    Finish();
+}
+
+v8::Local<v8::Promise> DataPipeStream::Read(v8::Isolate* isolate) {
+  gin_helper::Promise<v8::Local<v8::Value>> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+  if (pending_read_) {
+    promise.RejectWithErrorMessage("A read is already in progress");
+    return handle;
+  }
+
+  pending_read_ = std::move(promise);
+  if (end_of_data_)
+    Finish();
+  else
+    handle_watcher_.ArmOrNotify();
+  return handle;
+}
+
+void DataPipeStream::Cancel() {
+  handle_watcher_.Cancel();
+  data_pipe_.reset();
+  end_of_data_ = true;
+  SetResult(false, "The stream was cancelled");
+}
+
+void DataPipeStream::OnHandleReadable(MojoResult result) {
+  if (!pending_read_)
+    return;
+
+  const void* buffer = nullptr;
+  uint32_t size = 0;
+  if (result == MOJO_RESULT_OK) {
+    result =
+        data_pipe_->BeginReadData(&buffer, &size, MOJO_READ_DATA_FLAG_NONE);
+  }
+  if (result == MOJO_RESULT_SHOULD_WAIT) {
+    handle_watcher_.ArmOrNotify();
+    return;
+  }
+  if (result != MOJO_RESULT_OK) {
+    // The producer has closed the pipe.
+    handle_watcher_.Cancel();
+    data_pipe_.reset();
+    end_of_data_ = true;
+    Finish();
+    return;
+  }
+
+  auto promise = std::move(*pending_read_);
+  pending_read_.reset();
+  v8::Isolate* isolate = promise.isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Value> chunk =
+      node::Buffer::Copy(isolate, static_cast<const char*>(buffer), size)
+          .ToLocalChecked();
+  data_pipe_->EndReadData(size);
+  promise.Resolve(chunk);
+}
+
+void DataPipeStream::Finish() {
+  // Wait for the producer to report whether the data is complete.
+  if (!pending_read_ || !success_)
+    return;
+
+  auto promise = std::move(*pending_read_);
+  pending_read_.reset();
+  if (*success_) {
+    v8::HandleScope handle_scope(promise.isolate());
+    promise.Resolve(v8::Null(promise.isolate()));
+  } else {
+    promise.RejectWithErrorMessage(error_);
+  }
+}
+
+gin::ObjectTemplateBuilder DataPipeStream::GetObjectTemplateBuilder(
+    v8::Isolate* isolate) {
+  return gin::Wrappable<DataPipeStream>::GetObjectTemplateBuilder(isolate)
+      .SetMethod("read", &DataPipeStream::Read)
+      .SetMethod("cancel", &DataPipeStream::Cancel);
+}
+
+const char* DataPipeStream::GetTypeName() {
+  return "DataPipeStream";
+}
+
+}  // namespace api
+
+}  // namespace electron
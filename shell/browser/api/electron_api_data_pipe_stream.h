@@ -0,0 +1,75 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_API_ELECTRON_API_DATA_PIPE_STREAM_H_
+#define SHELL_BROWSER_API_ELECTRON_API_DATA_PIPE_STREAM_H_
+
+#include <string>
+
+#include "base/memory/weak_ptr.h"
+#include "base/optional.h"
+#include "gin/handle.h"
+#include "gin/wrappable.h"
+#include "mojo/public/cpp/system/data_pipe.h"
+#include "mojo/public/cpp/system/simple_watcher.h"
+#include "shell/common/gin_helper/promise.h"
+
+namespace electron {
+
+namespace api {
+
+// Reads a data pipe chunk by chunk on request of JS, so the producer is only
+// allowed to write as fast as JS consumes the data.
+class DataPipeStream : public gin::Wrappable<DataPipeStream> {
+ public:
+  static gin::WrapperInfo kWrapperInfo;
+
+  static gin::Handle<DataPipeStream> Create(
+      v8::Isolate* isolate,
+      mojo::ScopedDataPipeConsumerHandle data_pipe);
+
+  // Called once the producer has reported whether all the data was written,
+  // the stream only ends successfully after that.
+  void SetResult(bool success, const std::string& error);
+
+  base::WeakPtr<DataPipeStream> GetWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  // gin::Wrappable:
+  gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
+      v8::Isolate* isolate) override;
+  const char* GetTypeName() override;
+
+ private:
+  explicit DataPipeStream(mojo::ScopedDataPipeConsumerHandle data_pipe);
+  ~DataPipeStream() override;
+
+  // Resolves with a Buffer, or null at the end of the data.
+  v8::Local<v8::Promise> Read(v8::Isolate* isolate);
+  // Closes the pipe, which makes the producer fail.
+  void Cancel();
+
+  void OnHandleReadable(MojoResult result);
+  void Finish();
+
+  mojo::ScopedDataPipeConsumerHandle data_pipe_;
+  mojo::SimpleWatcher handle_watcher_;
+  base::Optional<gin_helper::Promise<v8::Local<v8::Value>>> pending_read_;
+
+  bool end_of_data_ = false;
+  // Set by SetResult().
+  base::Optional<bool> success_;
+  std::string error_;
+
+  base::WeakPtrFactory<DataPipeStream> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(DataPipeStream);
+};
+
+}  // namespace api
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_API_ELECTRON_API_DATA_PIPE_STREAM_H_
@@ -4,18 +4,33 @@
 
 #include "shell/browser/api/electron_api_net_log.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
 #include <utility>
 
+#include "base/callback_helpers.h"
 #include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/stl_util.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "base/task/thread_pool.h"
 #include "chrome/browser/browser_process.h"
 #include "components/net_log/chrome_net_log.h"
 #include "content/public/browser/storage_partition.h"
 #include "electron/electron_version.h"
 #include "gin/object_template_builder.h"
+#include "net/log/net_log.h"
 #include "shell/browser/electron_browser_context.h"
+#include "shell/browser/javascript_environment.h"
 #include "shell/browser/net/system_network_context_manager.h"
+#include "shell/common/gin_converters/callback_converter.h"
 #include "shell/common/gin_converters/file_path_converter.h"
+#include "shell/common/gin_converters/value_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
 #include "shell/common/node_includes.h"
 
@@ -72,16 +87,202 @@ void ResolvePromiseWithNetError(gin_helper::Promise<void> promise,
   }
 }
 
+base::Value GetNetLogConstants() {
+  auto command_line_string =
+      base::CommandLine::ForCurrentProcess()->GetCommandLineString();
+  auto channel_string = std::string("Electron " ELECTRON_VERSION);
+  return base::Value::FromUniquePtrValue(net_log::GetPlatformConstantsForNetLog(
+      command_line_string, channel_string));
+}
+
+// How often the log file of the streaming mode is read.
+constexpr base::TimeDelta kStreamPollInterval =
+    base::TimeDelta::FromMilliseconds(500);
+
+// The maximum number of bytes read from the log file at once.
+constexpr size_t kStreamMaxReadSize = 4 * 1024 * 1024;
+
+std::pair<base::FilePath, base::File> CreateStreamFile() {
+  base::FilePath path;
+  if (!base::CreateTemporaryFile(&path))
+    return std::make_pair(path, base::File());
+  return std::make_pair(path, OpenFileForWriting(path));
+}
+
+void DeleteStreamFile(base::FilePath path, base::File file) {
+  file.Close();
+  base::DeleteFile(path);
+}
+
+// Returns the value of the top-level "type" key of a serialized event. The line
+// is scanned instead of parsed, as most events are usually filtered out, and
+// the keys of nested objects like "source", which has its own "type", are
+// skipped.
+bool GetEventType(base::StringPiece line, int* type) {
+  static constexpr base::StringPiece kTypeKey = "\"type\"";
+  int depth = 0;
+  for (size_t i = 0; i < line.size(); ++i) {
+    switch (line[i]) {
+      case '{':
+      case '[':
+        depth++;
+        break;
+      case '}':
+      case ']':
+        depth--;
+        break;
+      case '"': {
+        size_t end = i + 1;
+        while (end < line.size() && line[end] != '"')
+          end += line[end] == '\\' ? 2 : 1;
+        if (end >= line.size())
+          return false;
+        base::StringPiece string = line.substr(i, end + 1 - i);
+        i = end;
+        if (depth != 1 || string != kTypeKey)
+          break;
+        // Values that happen to be "type" are not followed by a colon.
+        size_t colon = line.find_first_not_of(' ', end + 1);
+        if (colon == base::StringPiece::npos || line[colon] != ':')
+          break;
+        base::StringPiece value = line.substr(colon + 1);
+        value = base::TrimWhitespaceASCII(value, base::TRIM_LEADING);
+        value = value.substr(0, value.find_first_not_of("0123456789"));
+        return base::StringToInt(value, type);
+      }
+    }
+  }
+  return false;
+}
+
+// Reads the optional limit |key| of |dict|, which must be a finite and
+// non-negative number.
+bool GetStreamLimit(const gin_helper::Dictionary& dict,
+                    base::StringPiece key,
+                    double* out) {
+  v8::Local<v8::Value> value;
+  if (!dict.Get(key, &value) || value->IsUndefined())
+    return true;
+  if (!value->IsNumber())
+    return false;
+  double number = value.As<v8::Number>()->Value();
+  if (!std::isfinite(number) || number < 0)
+    return false;
+  *out = number;
+  return true;
+}
+
+const char* EventPhaseToString(int phase) {
+  switch (static_cast<net::NetLogEventPhase>(phase)) {
+    case net::NetLogEventPhase::BEGIN:
+      return "begin";
+    case net::NetLogEventPhase::END:
+      return "end";
+    default:
+      return "none";
+  }
+}
+
 }  // namespace
 
 namespace api {
 
+// Reads the events appended to the log file written by a NetLogExporter,
+// which writes the constants on the first line followed by one event per line.
+// Lives on the file task runner and deletes the file when destroyed.
+class NetLog::StreamReader {
+ public:
+  StreamReader(base::FilePath path, std::set<int> event_types)
+      : path_(std::move(path)), event_types_(std::move(event_types)) {}
+
+  ~StreamReader() {
+    file_.Close();
+    base::DeleteFile(path_);
+  }
+
+  // Appends the events written since the last call to |events|, returns the
+  // size of the file.
+  int64_t Read(std::vector<StreamedEvent>* events) {
+    if (!file_.IsValid()) {
+      file_.Initialize(path_, base::File::FLAG_OPEN | base::File::FLAG_READ);
+      if (!file_.IsValid())
+        return 0;
+    }
+
+    buffer_.resize(64 * 1024);
+    for (size_t total = 0; total < kStreamMaxReadSize;) {
+      int read = file_.ReadAtCurrentPos(buffer_.data(),
+                                        static_cast<int>(buffer_.size()));
+      if (read <= 0)
+        break;
+      total += read;
+      pending_.append(buffer_.data(), read);
+
+      size_t start = 0;
+      for (size_t end = pending_.find('\n'); end != std::string::npos;
+           start = end + 1, end = pending_.find('\n', start)) {
+        ParseLine(base::StringPiece(pending_).substr(start, end - start),
+                  events);
+      }
+      pending_.erase(0, start);
+    }
+    return file_.GetLength();
+  }
+
+ private:
+  void ParseLine(base::StringPiece line, std::vector<StreamedEvent>* events) {
+    if (!in_events_) {
+      in_events_ =
+          base::StartsWith(line, "\"events\"", base::CompareCase::SENSITIVE);
+      return;
+    }
+    // The closing bracket of the events.
+    if (line.empty() || line[0] != '{')
+      return;
+
+    // Filter before parsing, most events are usually filtered out.
+    int type;
+    if (!GetEventType(line, &type) ||
+        type >= static_cast<int>(net::NetLogEventType::COUNT) ||
+        (!event_types_.empty() && !base::Contains(event_types_, type)))
+      return;
+
+    if (line.back() == ',')
+      line.remove_suffix(1);
+    base::Optional<base::Value> event = base::JSONReader::Read(line);
+    if (!event || !event->is_dict())
+      return;
+
+    int64_t time = 0;
+    const std::string* time_string = event->FindStringKey("time");
+    if (time_string)
+      base::StringToInt64(*time_string, &time);
+    event->SetStringKey("type", net::NetLog::EventTypeToString(
+                                    static_cast<net::NetLogEventType>(type)));
+    event->SetStringKey("phase",
+                        EventPhaseToString(event->FindIntKey("phase").value_or(
+                            static_cast<int>(net::NetLogEventPhase::NONE))));
+    events->push_back({time, std::move(*event)});
+  }
+
+  base::FilePath path_;
+  std::set<int> event_types_;
+  base::File file_;
+  std::vector<char> buffer_;
+  // The incomplete line read last time.
+  std::string pending_;
+  bool in_events_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamReader);
+};
+
 gin::WrapperInfo NetLog::kWrapperInfo = {gin::kEmbedderNativeGin};
 
 NetLog::NetLog(v8::Isolate* isolate, ElectronBrowserContext* browser_context)
-    : browser_context_(browser_context), weak_ptr_factory_(this) {
-  file_task_runner_ = CreateFileTaskRunner();
-}
+    : browser_context_(browser_context),
+      file_task_runner_(CreateFileTaskRunner()),
+      stream_reader_(nullptr, base::OnTaskRunnerDeleter(nullptr)),
+      weak_ptr_factory_(this) {}
 
 NetLog::~NetLog() = default;
 
@@ -124,12 +325,7 @@ v8::Local<v8::Promise> NetLog::StartLogging(base::FilePath log_path,
       base::make_optional<gin_helper::Promise<void>>(args->isolate());
   v8::Local<v8::Promise> handle = pending_start_promise_->GetHandle();
 
-  auto command_line_string =
-      base::CommandLine::ForCurrentProcess()->GetCommandLineString();
-  auto channel_string = std::string("Electron " ELECTRON_VERSION);
-  base::Value custom_constants =
-      base::Value::FromUniquePtrValue(net_log::GetPlatformConstantsForNetLog(
-          command_line_string, channel_string));
+  base::Value custom_constants = GetNetLogConstants();
 
   auto* network_context =
       content::BrowserContext::GetDefaultStoragePartition(browser_context_)
@@ -213,12 +409,303 @@ v8::Local<v8::Promise> NetLog::StopLogging(gin::Arguments* args) {
   return handle;
 }
 
+v8::Local<v8::Promise> NetLog::StartStreaming(gin::Arguments* args) {
+  net::NetLogCaptureMode capture_mode = net::NetLogCaptureMode::kDefault;
+  std::set<int> event_types;
+  double max_events = 10000;
+  double max_age = 60;
+  double max_file_size = 16 * 1024 * 1024;
+  StreamListener listener;
+
+  v8::Local<v8::Value> arg;
+  if (args->GetNext(&arg) && !arg->IsFunction()) {
+    gin_helper::Dictionary dict;
+    if (!gin::ConvertFromV8(args->isolate(), arg, &dict)) {
+      args->ThrowTypeError("Options must be an object");
+      return v8::Local<v8::Promise>();
+    }
+    v8::Local<v8::Value> capture_mode_v8;
+    if (dict.Get("captureMode", &capture_mode_v8) &&
+        !gin::ConvertFromV8(args->isolate(), capture_mode_v8, &capture_mode)) {
+      args->ThrowTypeError("Invalid value for captureMode");
+      return v8::Local<v8::Promise>();
+    }
+    std::vector<std::string> names;
+    if (dict.Get("eventTypes", &names)) {
+      std::map<std::string, int> types;
+      for (int i = 0; i < static_cast<int>(net::NetLogEventType::COUNT); ++i)
+        types[net::NetLog::EventTypeToString(
+            static_cast<net::NetLogEventType>(i))] = i;
+      for (const auto& name : names) {
+        auto it = types.find(name);
+        if (it == types.end()) {
+          args->ThrowTypeError("Unknown event type " + name);
+          return v8::Local<v8::Promise>();
+        }
+        event_types.insert(it->second);
+      }
+    }
+    for (auto limit : {std::make_pair("maxEvents", &max_events),
+                       std::make_pair("maxAge", &max_age),
+                       std::make_pair("maxFileSize", &max_file_size)}) {
+      if (!GetStreamLimit(dict, limit.first, limit.second)) {
+        args->ThrowTypeError(std::string("Invalid value for ") + limit.first);
+        return v8::Local<v8::Promise>();
+      }
+    }
+    args->GetNext(&arg);
+  }
+  if (!arg.IsEmpty() && !arg->IsUndefined() &&
+      !gin::ConvertFromV8(args->isolate(), arg, &listener)) {
+    args->ThrowTypeError("Listener must be a function");
+    return v8::Local<v8::Promise>();
+  }
+
+  if (streaming_) {
+    args->ThrowTypeError("There is already a net log stream running");
+    return v8::Local<v8::Promise>();
+  }
+
+  streaming_ = true;
+  stream_capture_mode_ = capture_mode;
+  stream_event_types_ = std::move(event_types);
+  // Larger limits are never reached, the bound keeps the casts defined.
+  constexpr double kMaxStreamLimit = std::numeric_limits<uint32_t>::max();
+  stream_max_events_ =
+      static_cast<size_t>(std::min(max_events, kMaxStreamLimit));
+  stream_max_age_ = base::TimeDelta::FromSecondsD(max_age);
+  stream_max_file_size_ =
+      static_cast<int64_t>(std::min(max_file_size, kMaxStreamLimit));
+  stream_listener_ = std::move(listener);
+  streamed_events_.clear();
+
+  pending_stream_promise_ =
+      base::make_optional<gin_helper::Promise<void>>(args->isolate());
+  v8::Local<v8::Promise> handle = pending_stream_promise_->GetHandle();
+  StartStreamExporter();
+  return handle;
+}
+
+void NetLog::StartStreamExporter() {
+  base::PostTaskAndReplyWithResult(
+      file_task_runner_.get(), FROM_HERE, base::BindOnce(&CreateStreamFile),
+      base::BindOnce(&NetLog::OnStreamFileCreated,
+                     weak_ptr_factory_.GetWeakPtr()));
+}
+
+void NetLog::OnStreamFileCreated(std::pair<base::FilePath, base::File> file) {
+  if (!streaming_ || stream_exporter_) {
+    file_task_runner_->PostTask(
+        FROM_HERE, base::BindOnce(&DeleteStreamFile, std::move(file.first),
+                                  std::move(file.second)));
+    return;
+  }
+  if (!file.second.IsValid()) {
+    streaming_ = false;
+    if (pending_stream_promise_) {
+      std::move(*pending_stream_promise_)
+          .RejectWithErrorMessage(
+              base::File::ErrorToString(file.second.error_details()));
+      pending_stream_promise_.reset();
+    }
+    return;
+  }
+
+  auto* network_context =
+      content::BrowserContext::GetDefaultStoragePartition(browser_context_)
+          ->GetNetworkContext();
+  network_context->CreateNetLogExporter(mojo::MakeRequest(&stream_exporter_));
+  stream_exporter_.set_connection_error_handler(base::BindOnce(
+      &NetLog::OnStreamConnectionError, base::Unretained(this)));
+  stream_exporter_->Start(
+      std::move(file.second), GetNetLogConstants(), stream_capture_mode_,
+      network::mojom::NetLogExporter::kUnlimitedFileSize,
+      base::BindOnce(&NetLog::OnStreamStarted, base::Unretained(this)));
+  stream_reader_ = std::unique_ptr<StreamReader, base::OnTaskRunnerDeleter>(
+      new StreamReader(std::move(file.first), stream_event_types_),
+      base::OnTaskRunnerDeleter(file_task_runner_));
+}
+
+void NetLog::OnStreamStarted(int32_t error) {
+  if (pending_stream_promise_) {
+    ResolvePromiseWithNetError(std::move(*pending_stream_promise_), error);
+    pending_stream_promise_.reset();
+  }
+  if (error != net::OK || !streaming_) {
+    streaming_ = false;
+    StopStreamExporter(base::DoNothing());
+    return;
+  }
+  stream_poll_timer_.Start(
+      FROM_HERE, kStreamPollInterval,
+      base::BindRepeating(&NetLog::PollStream, base::Unretained(this)));
+}
+
+void NetLog::StopStreamExporter(base::OnceCallback<void(int32_t)> callback) {
+  stream_poll_timer_.Stop();
+  if (!stream_exporter_) {
+    std::move(callback).Run(net::OK);
+    return;
+  }
+
+  // The exporter flushes the file before replying, so the rest of the events
+  // can be read before the file is deleted.
+  network::mojom::NetLogExporterPtr exporter = std::move(stream_exporter_);
+  exporter.set_connection_error_handler(base::OnceClosure());
+  network::mojom::NetLogExporter* exporter_ptr = exporter.get();
+  exporter_ptr->Stop(
+      base::Value(base::Value::Type::DICTIONARY),
+      base::BindOnce(&NetLog::OnStreamExporterStopped,
+                     weak_ptr_factory_.GetWeakPtr(), std::move(exporter),
+                     std::move(stream_reader_), std::move(callback)));
+}
+
+void NetLog::OnStreamExporterStopped(
+    network::mojom::NetLogExporterPtr exporter,
+    std::unique_ptr<StreamReader, base::OnTaskRunnerDeleter> reader,
+    base::OnceCallback<void(int32_t)> callback,
+    int32_t error) {
+  if (!reader) {
+    std::move(callback).Run(error);
+    return;
+  }
+
+  // Complete after the last events are buffered. |reader| is deleted on the
+  // file task runner after the read.
+  auto events = std::make_unique<std::vector<StreamedEvent>>();
+  auto* events_ptr = events.get();
+  base::PostTaskAndReplyWithResult(
+      file_task_runner_.get(), FROM_HERE,
+      base::BindOnce(&StreamReader::Read, base::Unretained(reader.get()),
+                     events_ptr),
+      base::BindOnce(&NetLog::OnStreamRead, weak_ptr_factory_.GetWeakPtr(),
+                     true, std::move(events))
+          .Then(base::BindOnce(std::move(callback), error)));
+}
+
+void NetLog::PollStream() {
+  if (stream_poll_pending_ || !stream_reader_)
+    return;
+  stream_poll_pending_ = true;
+
+  auto events = std::make_unique<std::vector<StreamedEvent>>();
+  auto* events_ptr = events.get();
+  // |stream_reader_| is deleted on the file task runner, after this task.
+  base::PostTaskAndReplyWithResult(
+      file_task_runner_.get(), FROM_HERE,
+      base::BindOnce(&StreamReader::Read,
+                     base::Unretained(stream_reader_.get()), events_ptr),
+      base::BindOnce(&NetLog::OnStreamRead, weak_ptr_factory_.GetWeakPtr(),
+                     false, std::move(events)));
+}
+
+void NetLog::OnStreamRead(bool final_read,
+                          std::unique_ptr<std::vector<StreamedEvent>> events,
+                          int64_t file_size) {
+  if (!final_read)
+    stream_poll_pending_ = false;
+
+  if (!events->empty()) {
+    if (stream_listener_) {
+      v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+      v8::HandleScope handle_scope(isolate);
+      std::vector<v8::Local<v8::Value>> values;
+      values.reserve(events->size());
+      for (const auto& event : *events)
+        values.push_back(gin::ConvertToV8(isolate, event.event));
+      stream_listener_.Run(gin::ConvertToV8(isolate, values));
+    }
+    for (auto& event : *events)
+      streamed_events_.push_back(std::move(event));
+    PruneStreamedEvents();
+  }
+
+  // Replace the log file before it grows too large.
+  if (!final_read && streaming_ && stream_exporter_ &&
+      file_size > stream_max_file_size_) {
+    StopStreamExporter(base::DoNothing());
+    StartStreamExporter();
+  }
+}
+
+void NetLog::OnStreamConnectionError() {
+  stream_exporter_.reset();
+  stream_poll_timer_.Stop();
+  stream_reader_.reset();
+  streaming_ = false;
+  stream_listener_.Reset();
+  if (pending_stream_promise_) {
+    std::move(*pending_stream_promise_)
+        .RejectWithErrorMessage("Failed to start net log exporter");
+    pending_stream_promise_.reset();
+  }
+}
+
+void NetLog::PruneStreamedEvents() {
+  while (streamed_events_.size() > stream_max_events_)
+    streamed_events_.pop_front();
+  const int64_t min_time =
+      (base::TimeTicks::Now() - base::TimeTicks() - stream_max_age_)
+          .InMilliseconds();
+  while (!streamed_events_.empty() &&
+         streamed_events_.front().time < min_time)
+    streamed_events_.pop_front();
+}
+
+v8::Local<v8::Promise> NetLog::StopStreaming(gin::Arguments* args) {
+  gin_helper::Promise<void> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  if (!streaming_) {
+    promise.RejectWithErrorMessage("No net log stream in progress");
+    return handle;
+  }
+
+  streaming_ = false;
+  stream_listener_.Reset();
+  if (pending_stream_promise_) {
+    std::move(*pending_stream_promise_)
+        .RejectWithErrorMessage("Net log stream stopped");
+    pending_stream_promise_.reset();
+  }
+  StopStreamExporter(
+      base::BindOnce(&ResolvePromiseWithNetError, std::move(promise)));
+  return handle;
+}
+
+bool NetLog::IsCurrentlyStreaming() const {
+  return streaming_;
+}
+
+v8::Local<v8::Value> NetLog::GetRecentEvents(gin::Arguments* args) {
+  PruneStreamedEvents();
+
+  int64_t min_time = std::numeric_limits<int64_t>::min();
+  double seconds;
+  if (args->GetNext(&seconds)) {
+    min_time = (base::TimeTicks::Now() - base::TimeTicks() -
+                base::TimeDelta::FromSecondsD(seconds))
+                   .InMilliseconds();
+  }
+
+  std::vector<v8::Local<v8::Value>> values;
+  for (const auto& event : streamed_events_) {
+    if (event.time >= min_time)
+      values.push_back(gin::ConvertToV8(args->isolate(), event.event));
+  }
+  return gin::ConvertToV8(args->isolate(), values);
+}
+
 gin::ObjectTemplateBuilder NetLog::GetObjectTemplateBuilder(
     v8::Isolate* isolate) {
   return gin::Wrappable<NetLog>::GetObjectTemplateBuilder(isolate)
       .SetProperty("currentlyLogging", &NetLog::IsCurrentlyLogging)
       .SetMethod("startLogging", &NetLog::StartLogging)
-      .SetMethod("stopLogging", &NetLog::StopLogging);
+      .SetMethod("stopLogging", &NetLog::StopLogging)
+      .SetProperty("currentlyStreaming", &NetLog::IsCurrentlyStreaming)
+      .SetMethod("startStreaming", &NetLog::StartStreaming)
+      .SetMethod("stopStreaming", &NetLog::StopStreaming)
+      .SetMethod("getRecentEvents", &NetLog::GetRecentEvents);
 }
 
 const char* NetLog::GetTypeName() {
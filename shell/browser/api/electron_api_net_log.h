@@ -7,10 +7,18 @@
 
 #include <list>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/callback.h"
+#include "base/containers/circular_deque.h"
+#include "base/files/file_path.h"
 #include "base/optional.h"
+#include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
 #include "gin/handle.h"
 #include "gin/wrappable.h"
@@ -37,6 +45,11 @@ class NetLog : public gin::Wrappable<NetLog> {
   v8::Local<v8::Promise> StopLogging(gin::Arguments* args);
   bool IsCurrentlyLogging() const;
 
+  v8::Local<v8::Promise> StartStreaming(gin::Arguments* args);
+  v8::Local<v8::Promise> StopStreaming(gin::Arguments* args);
+  bool IsCurrentlyStreaming() const;
+  v8::Local<v8::Value> GetRecentEvents(gin::Arguments* args);
+
   // gin::Wrappable
   static gin::WrapperInfo kWrapperInfo;
   gin::ObjectTemplateBuilder GetObjectTemplateBuilder(
@@ -57,13 +70,55 @@ class NetLog : public gin::Wrappable<NetLog> {
   void NetLogStarted(int32_t error);
 
  private:
+  class StreamReader;
+  using StreamListener = base::RepeatingCallback<void(v8::Local<v8::Value>)>;
+
+  struct StreamedEvent {
+    // Milliseconds of base::TimeTicks, like the "time" of the event.
+    int64_t time;
+    base::Value event;
+  };
+
+  void StartStreamExporter();
+  void OnStreamFileCreated(std::pair<base::FilePath, base::File> file);
+  void OnStreamStarted(int32_t error);
+  void StopStreamExporter(base::OnceCallback<void(int32_t)> callback);
+  void OnStreamExporterStopped(
+      network::mojom::NetLogExporterPtr exporter,
+      std::unique_ptr<StreamReader, base::OnTaskRunnerDeleter> reader,
+      base::OnceCallback<void(int32_t)> callback,
+      int32_t error);
+  void PollStream();
+  void OnStreamRead(bool final_read,
+                    std::unique_ptr<std::vector<StreamedEvent>> events,
+                    int64_t file_size);
+  void OnStreamConnectionError();
+  void PruneStreamedEvents();
+
   ElectronBrowserContext* browser_context_;
 
   network::mojom::NetLogExporterPtr net_log_exporter_;
 
   base::Optional<gin_helper::Promise<void>> pending_start_promise_;
 
-  scoped_refptr<base::TaskRunner> file_task_runner_;
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+
+  // The streaming mode, which tails a temporary log file that is replaced
+  // once it reaches |stream_max_file_size_|.
+  bool streaming_ = false;
+  net::NetLogCaptureMode stream_capture_mode_ =
+      net::NetLogCaptureMode::kDefault;
+  std::set<int> stream_event_types_;
+  size_t stream_max_events_ = 0;
+  base::TimeDelta stream_max_age_;
+  int64_t stream_max_file_size_ = 0;
+  StreamListener stream_listener_;
+  network::mojom::NetLogExporterPtr stream_exporter_;
+  std::unique_ptr<StreamReader, base::OnTaskRunnerDeleter> stream_reader_;
+  base::Optional<gin_helper::Promise<void>> pending_stream_promise_;
+  base::RepeatingTimer stream_poll_timer_;
+  bool stream_poll_pending_ = false;
+  base::circular_deque<StreamedEvent> streamed_events_;
 
   base::WeakPtrFactory<NetLog> weak_ptr_factory_;
 
@@ -16,7 +16,9 @@
 #include "shell/browser/electron_browser_context.h"
 #include "shell/browser/protocol_registry.h"
 #include "shell/common/gin_converters/callback_converter.h"
+#include "shell/common/gin_converters/file_path_converter.h"
 #include "shell/common/gin_converters/net_converter.h"
+#include "shell/common/gin_converters/std_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
 #include "shell/common/gin_helper/object_template_builder.h"
 #include "shell/common/gin_helper/promise.h"
@@ -199,6 +201,36 @@ bool Protocol::IsProtocolRegistered(const std::string& scheme) {
   return protocol_registry_->IsProtocolRegistered(scheme);
 }
 
+bool Protocol::EnableResponseCache(const std::string& scheme,
+                                   gin::Arguments* args) {
+  ProtocolResponseCache* cache = protocol_registry_->GetResponseCache(scheme);
+  if (!cache)
+    return false;
+
+  ProtocolResponseCache::Options options;
+  gin_helper::Dictionary dict;
+  if (args->GetNext(&dict)) {
+    double max_size;
+    if (dict.Get("maxSize", &max_size) && max_size >= 0)
+      options.max_size = static_cast<size_t>(max_size);
+    dict.Get("varyHeaders", &options.vary_headers);
+    dict.Get("diskPath", &options.disk_path);
+    double max_disk_size;
+    if (dict.Get("maxDiskSize", &max_disk_size) && max_disk_size >= 0)
+      options.max_disk_size = static_cast<size_t>(max_disk_size);
+  }
+  cache->Enable(options);
+  return true;
+}
+
+bool Protocol::DisableResponseCache(const std::string& scheme) {
+  ProtocolResponseCache* cache = protocol_registry_->GetResponseCache(scheme);
+  if (!cache)
+    return false;
+  cache->Disable();
+  return true;
+}
+
 ProtocolError Protocol::InterceptProtocol(ProtocolType type,
                                           const std::string& scheme,
                                           const ProtocolHandler& handler) {
@@ -281,6 +313,8 @@ gin::ObjectTemplateBuilder Protocol::GetObjectTemplateBuilder(
                  &Protocol::RegisterProtocolFor<ProtocolType::kFree>)
       .SetMethod("unregisterProtocol", &Protocol::UnregisterProtocol)
       .SetMethod("isProtocolRegistered", &Protocol::IsProtocolRegistered)
+      .SetMethod("enableResponseCache", &Protocol::EnableResponseCache)
+      .SetMethod("disableResponseCache", &Protocol::DisableResponseCache)
       .SetMethod("isProtocolHandled", &Protocol::IsProtocolHandled)
       .SetMethod("interceptStringProtocol",
                  &Protocol::InterceptProtocolFor<ProtocolType::kString>)
@@ -60,6 +60,8 @@ class Protocol : public gin::Wrappable<Protocol> {
                                  const ProtocolHandler& handler);
   bool UnregisterProtocol(const std::string& scheme, gin::Arguments* args);
   bool IsProtocolRegistered(const std::string& scheme);
+  bool EnableResponseCache(const std::string& scheme, gin::Arguments* args);
+  bool DisableResponseCache(const std::string& scheme);
 
   ProtocolError InterceptProtocol(ProtocolType type,
                                   const std::string& scheme,
@@ -424,6 +424,35 @@ v8::Local<v8::Promise> Session::ResolveProxy(gin::Arguments* args) {
   return handle;
 }
 
+v8::Local<v8::Promise> Session::ResolveProxies(const std::vector<GURL>& urls) {
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  gin_helper::Promise<std::vector<std::string>> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  browser_context_->GetResolveProxyHelper()->ResolveProxies(
+      urls, base::BindOnce(
+                gin_helper::Promise<std::vector<std::string>>::ResolvePromise,
+                std::move(promise)));
+
+  return handle;
+}
+
+void Session::SetProxyResolutionCacheTTL(double ttl) {
+  browser_context_->GetResolveProxyHelper()->SetCacheTTL(
+      base::TimeDelta::FromSecondsD(std::max(ttl, 0.0)));
+}
+
+v8::Local<v8::Value> Session::GetProxyResolutionMetrics(v8::Isolate* isolate) {
+  const auto& metrics = browser_context_->GetResolveProxyHelper()->metrics();
+  gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+  dict.Set("lookupCount", metrics.lookup_count);
+  dict.Set("cacheHitCount", metrics.cache_hit_count);
+  dict.Set("totalTime", metrics.total_time.InMillisecondsF());
+  dict.Set("maxTime", metrics.max_time.InMillisecondsF());
+  dict.Set("lastTime", metrics.last_time.InMillisecondsF());
+  return dict.GetHandle();
+}
+
 v8::Local<v8::Promise> Session::GetCacheSize() {
   auto* isolate = JavascriptEnvironment::GetIsolate();
   gin_helper::Promise<int64_t> promise(isolate);
@@ -549,10 +578,10 @@ v8::Local<v8::Promise> Session::SetProxy(gin::Arguments* args) {
   browser_context_->in_memory_pref_store()->SetValue(
       proxy_config::prefs::kProxy, std::move(proxy_config),
       WriteablePrefStore::DEFAULT_PREF_WRITE_FLAGS);
-
-  base::ThreadTaskRunnerHandle::Get()->PostTask(
-      FROM_HERE, base::BindOnce(gin_helper::Promise<void>::ResolvePromise,
-                                std::move(promise)));
+  // Resolves once the network service uses the new configuration.
+  browser_context_->GetResolveProxyHelper()->ReloadProxyConfig(
+      base::BindOnce(gin_helper::Promise<void>::ResolvePromise,
+                     std::move(promise)));
 
   return handle;
 }
@@ -562,10 +591,9 @@ v8::Local<v8::Promise> Session::ForceReloadProxyConfig() {
   gin_helper::Promise<void> promise(isolate);
   auto handle = promise.GetHandle();
 
-  content::BrowserContext::GetDefaultStoragePartition(browser_context_)
-      ->GetNetworkContext()
-      ->ForceReloadProxyConfig(base::BindOnce(
-          gin_helper::Promise<void>::ResolvePromise, std::move(promise)));
+  browser_context_->GetResolveProxyHelper()->ReloadProxyConfig(
+      base::BindOnce(gin_helper::Promise<void>::ResolvePromise,
+                     std::move(promise)));
 
   return handle;
 }
@@ -609,11 +637,20 @@ void Session::SetCertVerifyProc(v8::Local<v8::Value> val,
     return;
   }
 
+  size_t cache_size = 0;
+  double cache_ttl = 300;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    options.Get("cacheSize", &cache_size);
+    options.Get("cacheTTL", &cache_ttl);
+  }
+
   mojo::PendingRemote<network::mojom::CertVerifierClient>
       cert_verifier_client_remote;
   if (proc) {
     mojo::MakeSelfOwnedReceiver(
-        std::make_unique<CertVerifierClient>(proc),
+        std::make_unique<CertVerifierClient>(
+            proc, cache_size, base::TimeDelta::FromSecondsD(cache_ttl)),
         cert_verifier_client_remote.InitWithNewPipeAndPassReceiver());
   }
   content::BrowserContext::GetDefaultStoragePartition(browser_context_)
@@ -1143,6 +1180,11 @@ gin::ObjectTemplateBuilder Session::GetObjectTemplateBuilder(
   return gin_helper::EventEmitterMixin<Session>::GetObjectTemplateBuilder(
              isolate)
       .SetMethod("resolveProxy", &Session::ResolveProxy)
+      .SetMethod("resolveProxies", &Session::ResolveProxies)
+      .SetMethod("setProxyResolutionCacheTTL",
+                 &Session::SetProxyResolutionCacheTTL)
+      .SetMethod("getProxyResolutionMetrics",
+                 &Session::GetProxyResolutionMetrics)
       .SetMethod("getCacheSize", &Session::GetCacheSize)
       .SetMethod("clearCache", &Session::ClearCache)
       .SetMethod("clearStorageData", &Session::ClearStorageData)
@@ -90,6 +90,9 @@ class Session : public gin::Wrappable<Session>,
 
   // Methods.
   v8::Local<v8::Promise> ResolveProxy(gin::Arguments* args);
+  v8::Local<v8::Promise> ResolveProxies(const std::vector<GURL>& urls);
+  void SetProxyResolutionCacheTTL(double ttl);
+  v8::Local<v8::Value> GetProxyResolutionMetrics(v8::Isolate* isolate);
   v8::Local<v8::Promise> GetCacheSize();
   v8::Local<v8::Promise> ClearCache();
   v8::Local<v8::Promise> ClearStorageData(gin::Arguments* args);
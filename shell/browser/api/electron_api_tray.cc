@@ -206,6 +206,36 @@ void Tray::SetPressedImage(gin::Handle<NativeImage> image) {
 #endif
 }
 
+void Tray::SetImageFrames(v8::Isolate* isolate,
+                          std::vector<gin::Handle<NativeImage>> frames) {
+  if (!CheckAlive())
+    return;
+  image_frames_.clear();
+  std::vector<gfx::Image> images;
+  for (auto& frame : frames) {
+    image_frames_.emplace_back(isolate, frame.ToV8());
+#if defined(OS_WIN)
+    // Creating the HICON is the expensive part, and NativeImage caches it.
+    frame->GetHICON(GetSystemMetrics(SM_CXSMICON));
+#endif
+    images.push_back(frame->image());
+  }
+  tray_icon_->PreloadImages(images);
+}
+
+void Tray::SetImageFrame(gin_helper::ErrorThrower thrower, uint32_t index) {
+  if (!CheckAlive())
+    return;
+  if (index >= image_frames_.size()) {
+    thrower.ThrowRangeError("Image frame index out of range");
+    return;
+  }
+  gin::Handle<NativeImage> frame;
+  v8::Local<v8::Value> value = image_frames_[index].Get(thrower.isolate());
+  if (gin::ConvertFromV8(thrower.isolate(), value, &frame))
+    SetImage(frame);
+}
+
 void Tray::SetToolTip(const std::string& tool_tip) {
   if (!CheckAlive())
     return;
@@ -384,6 +414,8 @@ v8::Local<v8::ObjectTemplate> Tray::FillObjectTemplate(
       .SetMethod("isDestroyed", &Tray::IsDestroyed)
       .SetMethod("setImage", &Tray::SetImage)
       .SetMethod("setPressedImage", &Tray::SetPressedImage)
+      .SetMethod("setImageFrames", &Tray::SetImageFrames)
+      .SetMethod("setImageFrame", &Tray::SetImageFrame)
       .SetMethod("setToolTip", &Tray::SetToolTip)
       .SetMethod("setTitle", &Tray::SetTitle)
       .SetMethod("getTitle", &Tray::GetTitle)
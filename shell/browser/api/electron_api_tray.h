@@ -85,6 +85,9 @@ class Tray : public gin::Wrappable<Tray>,
   bool IsDestroyed();
   void SetImage(gin::Handle<NativeImage> image);
   void SetPressedImage(gin::Handle<NativeImage> image);
+  void SetImageFrames(v8::Isolate* isolate,
+                      std::vector<gin::Handle<NativeImage>> frames);
+  void SetImageFrame(gin_helper::ErrorThrower thrower, uint32_t index);
   void SetToolTip(const std::string& tool_tip);
   void SetTitle(const std::string& title,
                 const base::Optional<gin_helper::Dictionary>& options,
@@ -105,6 +108,7 @@ class Tray : public gin::Wrappable<Tray>,
   bool CheckAlive();
 
   v8::Global<v8::Value> menu_;
+  std::vector<v8::Global<v8::Value>> image_frames_;
   std::unique_ptr<TrayIcon> tray_icon_;
 
   DISALLOW_COPY_AND_ASSIGN(Tray);
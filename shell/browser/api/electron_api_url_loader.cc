@@ -11,6 +11,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/callback_helpers.h"
 #include "base/containers/id_map.h"
 #include "base/no_destructor.h"
 #include "gin/handle.h"
@@ -27,6 +28,7 @@
 #include "shell/browser/electron_browser_context.h"
 #include "shell/browser/javascript_environment.h"
 #include "shell/common/gin_converters/callback_converter.h"
+#include "shell/common/gin_converters/file_path_converter.h"
 #include "shell/common/gin_converters/gurl_converter.h"
 #include "shell/common/gin_converters/net_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
@@ -274,8 +276,10 @@ gin::WrapperInfo SimpleURLLoaderWrapper::kWrapperInfo = {
 SimpleURLLoaderWrapper::SimpleURLLoaderWrapper(
     std::unique_ptr<network::ResourceRequest> request,
     network::mojom::URLLoaderFactory* url_loader_factory,
-    int options)
-    : id_(GetAllRequests().Add(this)) {
+    int options,
+    size_t chunk_size,
+    const base::FilePath& download_path)
+    : id_(GetAllRequests().Add(this)), chunk_size_(chunk_size) {
   // We slightly abuse the |render_frame_id| field in ResourceRequest so that
   // we can correlate any authentication events that arrive with this request.
   request->render_frame_id = id_;
@@ -301,7 +305,17 @@ SimpleURLLoaderWrapper::SimpleURLLoaderWrapper(
   loader_->SetOnDownloadProgressCallback(base::BindRepeating(
       &SimpleURLLoaderWrapper::OnDownloadProgress, base::Unretained(this)));
 
-  loader_->DownloadAsStream(url_loader_factory, this);
+  if (download_path.empty()) {
+    loader_->DownloadAsStream(url_loader_factory, this);
+  } else {
+    // The body is written to the file off the main thread, without ever
+    // entering JavaScript.
+    loader_->DownloadToFile(
+        url_loader_factory,
+        base::BindOnce(&SimpleURLLoaderWrapper::OnDownloadedToFile,
+                       base::Unretained(this)),
+        download_path);
+  }
 }
 
 void SimpleURLLoaderWrapper::Pin() {
@@ -428,6 +442,11 @@ gin::Handle<SimpleURLLoaderWrapper> SimpleURLLoaderWrapper::Create(
     }
   }
 
+  size_t chunk_size = 0;
+  opts.Get("chunkSize", &chunk_size);
+  base::FilePath download_path;
+  opts.Get("downloadPath", &download_path);
+
   std::string partition;
   gin::Handle<Session> session;
   if (!opts.Get("session", &session)) {
@@ -442,7 +461,7 @@ gin::Handle<SimpleURLLoaderWrapper> SimpleURLLoaderWrapper::Create(
   auto ret = gin::CreateHandle(
       args->isolate(),
       new SimpleURLLoaderWrapper(std::move(request), url_loader_factory.get(),
-                                 options));
+                                 options, chunk_size, download_path));
   ret->Pin();
   if (!chunk_pipe_getter.IsEmpty()) {
     ret->PinBodyGetter(chunk_pipe_getter);
@@ -453,16 +472,66 @@ gin::Handle<SimpleURLLoaderWrapper> SimpleURLLoaderWrapper::Create(
 void SimpleURLLoaderWrapper::OnDataReceived(base::StringPiece string_piece,
                                             base::OnceClosure resume) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (chunk_size_ == 0) {
+    AppendToBatch(string_piece);
+    EmitBatch(std::move(resume));
+    return;
+  }
+
+  // Fill the batch with the part of |string_piece| that fits. |string_piece|
+  // stays valid until |resume| is called, so the rest of it is carried into
+  // the next batch after JavaScript has read the full one.
+  size_t available = chunk_size_ - batch_size_;
+  AppendToBatch(string_piece.substr(0, available));
+  if (batch_size_ < chunk_size_) {
+    // Keep reading from the network until the batch is full.
+    std::move(resume).Run();
+    return;
+  }
+
+  if (string_piece.size() > available) {
+    EmitBatch(base::BindOnce(&SimpleURLLoaderWrapper::OnDataReceived,
+                             weak_factory_.GetWeakPtr(),
+                             string_piece.substr(available),
+                             std::move(resume)));
+  } else {
+    EmitBatch(std::move(resume));
+  }
+}
+
+void SimpleURLLoaderWrapper::AppendToBatch(base::StringPiece string_piece) {
+  if (!batch_) {
+    batch_ = v8::ArrayBuffer::NewBackingStore(
+        JavascriptEnvironment::GetIsolate(),
+        std::max(chunk_size_, string_piece.size()));
+    batch_size_ = 0;
+  }
+  memcpy(static_cast<char*>(batch_->Data()) + batch_size_, string_piece.data(),
+         string_piece.size());
+  batch_size_ += string_piece.size();
+}
+
+void SimpleURLLoaderWrapper::EmitBatch(base::OnceClosure resume) {
   v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
   v8::HandleScope handle_scope(isolate);
-  auto array_buffer = v8::ArrayBuffer::New(isolate, string_piece.size());
-  auto backing_store = array_buffer->GetBackingStore();
-  memcpy(backing_store->Data(), string_piece.data(), string_piece.size());
+  // The batch is handed over to JavaScript as is, only the last batch of a
+  // response can be partially filled and has to be shrunk first.
+  if (batch_size_ < batch_->ByteLength())
+    batch_ = v8::BackingStore::Reallocate(isolate, std::move(batch_),
+                                          batch_size_);
+  auto array_buffer = v8::ArrayBuffer::New(isolate, std::move(batch_));
+  batch_size_ = 0;
   Emit("data", array_buffer,
        base::AdaptCallbackForRepeating(std::move(resume)));
 }
 
+void SimpleURLLoaderWrapper::OnDownloadedToFile(base::FilePath path) {
+  OnComplete(!path.empty());
+}
+
 void SimpleURLLoaderWrapper::OnComplete(bool success) {
+  if (success && batch_)
+    EmitBatch(base::DoNothing());
   if (success) {
     Emit("complete");
   } else {
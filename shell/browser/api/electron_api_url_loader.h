@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "gin/wrappable.h"
 #include "net/base/auth.h"
@@ -65,7 +66,9 @@ class SimpleURLLoaderWrapper
  private:
   SimpleURLLoaderWrapper(std::unique_ptr<network::ResourceRequest> request,
                          network::mojom::URLLoaderFactory* url_loader_factory,
-                         int options);
+                         int options,
+                         size_t chunk_size,
+                         const base::FilePath& download_path);
 
   // SimpleURLLoaderStreamConsumer:
   void OnDataReceived(base::StringPiece string_piece,
@@ -73,6 +76,14 @@ class SimpleURLLoaderWrapper
   void OnComplete(bool success) override;
   void OnRetry(base::OnceClosure start_retry) override;
 
+  // Copies |string_piece| to the end of |batch_|.
+  void AppendToBatch(base::StringPiece string_piece);
+  // Emits |batch_| as a "data" event.
+  void EmitBatch(base::OnceClosure resume);
+
+  // SimpleURLLoader::DownloadToFile callback.
+  void OnDownloadedToFile(base::FilePath path);
+
   // SimpleURLLoader callbacks
   void OnResponseStarted(const GURL& final_url,
                          const network::mojom::URLResponseHead& response_head);
@@ -91,6 +102,12 @@ class SimpleURLLoaderWrapper
   v8::Global<v8::Value> pinned_wrapper_;
   v8::Global<v8::Value> pinned_chunk_pipe_getter_;
 
+  // When not 0, received data is batched into chunks of exactly this size
+  // before being emitted, except for the last one.
+  size_t chunk_size_;
+  std::unique_ptr<v8::BackingStore> batch_;
+  size_t batch_size_ = 0;
+
   base::WeakPtrFactory<SimpleURLLoaderWrapper> weak_factory_{this};
 };
 
@@ -4,7 +4,9 @@
 
 #include "shell/browser/api/electron_api_web_contents.h"
 
+#include <algorithm>
 #include <limits>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -12,11 +14,14 @@
 #include <utility>
 #include <vector>
 
+#include "base/barrier_closure.h"
 #include "base/containers/id_map.h"
 #include "base/files/file_util.h"
 #include "base/json/json_reader.h"
+#include "base/memory/ref_counted.h"
 #include "base/no_destructor.h"
 #include "base/optional.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/task/current_thread.h"
 #include "base/task/post_task.h"
@@ -68,12 +73,14 @@
 #include "gin/object_template_builder.h"
 #include "gin/wrappable.h"
 #include "mojo/public/cpp/bindings/associated_remote.h"
+#include "mojo/public/cpp/bindings/callback_helpers.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/remote.h"
 #include "mojo/public/cpp/system/platform_handle.h"
 #include "ppapi/buildflags/buildflags.h"
 #include "printing/buildflags/buildflags.h"
 #include "shell/browser/api/electron_api_browser_window.h"
+#include "shell/browser/api/electron_api_data_pipe_stream.h"
 #include "shell/browser/api/electron_api_debugger.h"
 #include "shell/browser/api/electron_api_session.h"
 #include "shell/browser/api/electron_api_web_frame_main.h"
@@ -87,6 +94,7 @@
 #include "shell/browser/electron_javascript_dialog_manager.h"
 #include "shell/browser/electron_navigation_throttle.h"
 #include "shell/browser/lib/bluetooth_chooser.h"
+#include "shell/browser/long_task_monitor.h"
 #include "shell/browser/native_window.h"
 #include "shell/browser/session_preferences.h"
 #include "shell/browser/ui/drag_util.h"
@@ -127,11 +135,16 @@
 #include "third_party/blink/public/mojom/frame/fullscreen.mojom.h"
 #include "third_party/blink/public/mojom/messaging/transferable_message.mojom.h"
 #include "third_party/blink/public/mojom/renderer_preferences.mojom.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkPixelRef.h"
 #include "ui/base/cursor/cursor.h"
 #include "ui/base/ime/ime_text_span.h"
 #include "ui/base/cursor/mojom/cursor_type.mojom-shared.h"
 #include "ui/display/screen.h"
 #include "ui/events/base_event_utils.h"
+#include "ui/gfx/codec/jpeg_codec.h"
+#include "ui/gfx/codec/png_codec.h"
 
 #if BUILDFLAG(ENABLE_OSR)
 #include "shell/browser/osr/osr_render_widget_host_view.h"
@@ -385,6 +398,10 @@ base::IDMap<WebContents*>& GetAllWebContents() {
   return *s_all_web_contents;
 }
 
+// The data of a streamed heap snapshot that may be in flight, the renderer
+// waits while the pipe is full.
+constexpr uint32_t kHeapSnapshotPipeCapacity = 1024 * 1024;
+
 // Called when CapturePage is done.
 void OnCapturePageDone(gin_helper::Promise<gfx::Image> promise,
                        const SkBitmap& bitmap) {
@@ -392,6 +409,123 @@ void OnCapturePageDone(gin_helper::Promise<gfx::Image> promise,
   promise.Resolve(gfx::Image::CreateFrom1xBitmap(bitmap));
 }
 
+// Reads the "size" of the capture options. Either dimension may be left out,
+// which gfx::Size's converter does not allow.
+gfx::Size GetCaptureOutputSize(const gin_helper::Dictionary& options) {
+  gin_helper::Dictionary size;
+  int width = 0;
+  int height = 0;
+  if (options.Get("size", &size)) {
+    size.Get("width", &width);
+    size.Get("height", &height);
+  }
+  return gfx::Size(width, height);
+}
+
+enum class CaptureFormat { kBGRA, kPNG, kJPEG };
+
+void FreeEncodedCapture(char* data, void* hint) {
+  delete reinterpret_cast<std::vector<unsigned char>*>(hint);
+}
+
+void UnrefCapturePixels(char* data, void* hint) {
+  reinterpret_cast<SkPixelRef*>(hint)->unref();
+}
+
+std::unique_ptr<std::vector<unsigned char>> EncodeCapture(
+    const SkBitmap& bitmap,
+    CaptureFormat format,
+    int quality) {
+  auto encoded = std::make_unique<std::vector<unsigned char>>();
+  bool success = format == CaptureFormat::kPNG
+                     ? gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false,
+                                                         encoded.get())
+                     : gfx::JPEGCodec::Encode(bitmap, quality, encoded.get());
+  if (!success)
+    encoded->clear();
+  return encoded;
+}
+
+void OnCaptureEncoded(gin_helper::Promise<v8::Local<v8::Value>> promise,
+                      std::unique_ptr<std::vector<unsigned char>> encoded) {
+  v8::Isolate* isolate = promise.isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(promise.GetContext());
+  if (encoded->empty()) {
+    promise.RejectWithErrorMessage("Failed to encode the captured page");
+    return;
+  }
+  char* data = reinterpret_cast<char*>(encoded->data());
+  size_t size = encoded->size();
+  promise.Resolve(node::Buffer::New(isolate, data, size, &FreeEncodedCapture,
+                                    encoded.release())
+                      .ToLocalChecked());
+}
+
+// Called when CapturePageToBuffer is done.
+void OnCapturePageToBufferDone(
+    gin_helper::Promise<v8::Local<v8::Value>> promise,
+    CaptureFormat format,
+    int quality,
+    v8::Global<v8::Value> target,
+    const SkBitmap& bitmap) {
+  v8::Isolate* isolate = promise.isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(promise.GetContext());
+
+  if (bitmap.drawsNothing()) {
+    promise.Resolve(node::Buffer::New(isolate, 0).ToLocalChecked());
+    return;
+  }
+
+  if (format != CaptureFormat::kBGRA) {
+    base::ThreadPool::PostTaskAndReplyWithResult(
+        FROM_HERE,
+        {base::TaskPriority::USER_VISIBLE,
+         base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+        base::BindOnce(&EncodeCapture, bitmap, format, quality),
+        base::BindOnce(&OnCaptureEncoded, std::move(promise)));
+    return;
+  }
+
+  SkImageInfo info =
+      SkImageInfo::MakeN32Premul(bitmap.width(), bitmap.height());
+  size_t size = info.computeMinByteSize();
+
+  if (target.IsEmpty()) {
+    // Hand the captured pixels to the Buffer without copying them.
+    SkPixelRef* ref = bitmap.pixelRef();
+    if (bitmap.rowBytes() == info.minRowBytes() && ref) {
+      ref->ref();
+      promise.Resolve(
+          node::Buffer::New(isolate, static_cast<char*>(bitmap.getPixels()),
+                            size, &UnrefCapturePixels, ref)
+              .ToLocalChecked());
+      return;
+    }
+    target.Reset(isolate, node::Buffer::New(isolate, size).ToLocalChecked());
+  }
+
+  v8::Local<v8::ArrayBufferView> view =
+      target.Get(isolate).As<v8::ArrayBufferView>();
+  if (view->ByteLength() < size) {
+    promise.RejectWithErrorMessage(
+        "buffer is too small, " + base::NumberToString(size) +
+        " bytes are needed");
+    return;
+  }
+  v8::Local<v8::ArrayBuffer> array_buffer = view->Buffer();
+  char* data = static_cast<char*>(array_buffer->GetBackingStore()->Data()) +
+               view->ByteOffset();
+  if (!bitmap.readPixels(info, data, info.minRowBytes(), 0, 0)) {
+    promise.RejectWithErrorMessage("Failed to read the captured pixels");
+    return;
+  }
+  promise.Resolve(
+      node::Buffer::New(isolate, array_buffer, view->ByteOffset(), size)
+          .ToLocalChecked());
+}
+
 base::Optional<base::TimeDelta> GetCursorBlinkInterval() {
 #if defined(OS_MAC)
   base::TimeDelta interval;
@@ -1509,10 +1643,31 @@ void WebContents::OnElectronBrowserConnectionError() {
   base::Erase(frame_to_receivers_map_[frame_host], receiver_id);
 }
 
+void WebContents::OnIPCMessageReceived(const blink::CloneableMessage& message) {
+  ipc_counters_.messages_received++;
+  ipc_counters_.bytes_received += message.encoded_message.size();
+}
+
+void WebContents::OnIPCMessageSent(const blink::CloneableMessage& message) {
+  ipc_counters_.messages_sent++;
+  ipc_counters_.bytes_sent += message.encoded_message.size();
+}
+
+// static
+void WebContents::OnIPCReply(base::WeakPtr<WebContents> web_contents,
+                             InvokeCallback callback,
+                             blink::CloneableMessage result) {
+  if (web_contents)
+    web_contents->OnIPCMessageSent(result);
+  std::move(callback).Run(std::move(result));
+}
+
 void WebContents::Message(bool internal,
                           const std::string& channel,
                           blink::CloneableMessage arguments) {
   TRACE_EVENT1("electron", "WebContents::Message", "channel", channel);
+  OnIPCMessageReceived(arguments);
+  LongTaskMonitor::AnnotateCurrentTask(LongTaskMonitor::Source::kIPC, channel);
   // webContents.emit('-ipc-message', new Event(), internal, channel,
   // arguments);
   EmitWithSender("-ipc-message", receivers_.current_context(), InvokeCallback(),
@@ -1524,9 +1679,13 @@ void WebContents::Invoke(bool internal,
                          blink::CloneableMessage arguments,
                          InvokeCallback callback) {
   TRACE_EVENT1("electron", "WebContents::Invoke", "channel", channel);
+  OnIPCMessageReceived(arguments);
+  LongTaskMonitor::AnnotateCurrentTask(LongTaskMonitor::Source::kIPC, channel);
   // webContents.emit('-ipc-invoke', new Event(), internal, channel, arguments);
   EmitWithSender("-ipc-invoke", receivers_.current_context(),
-                 std::move(callback), internal, channel, std::move(arguments));
+                 base::BindOnce(&WebContents::OnIPCReply, GetWeakPtr(),
+                                std::move(callback)),
+                 internal, channel, std::move(arguments));
 }
 
 void WebContents::OnFirstNonEmptyLayout() {
@@ -1537,6 +1696,8 @@ void WebContents::OnFirstNonEmptyLayout() {
 
 void WebContents::ReceivePostMessage(const std::string& channel,
                                      blink::TransferableMessage message) {
+  OnIPCMessageReceived(message);
+  LongTaskMonitor::AnnotateCurrentTask(LongTaskMonitor::Source::kIPC, channel);
   v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
   v8::HandleScope handle_scope(isolate);
   auto wrapped_ports =
@@ -1576,6 +1737,7 @@ void WebContents::PostMessage(const std::string& channel,
   content::RenderFrameHost* frame_host = web_contents()->GetMainFrame();
   mojo::AssociatedRemote<mojom::ElectronRenderer> electron_renderer;
   frame_host->GetRemoteAssociatedInterfaces()->GetInterface(&electron_renderer);
+  OnIPCMessageSent(transferable_message);
   electron_renderer->ReceivePostMessage(channel,
                                         std::move(transferable_message));
 }
@@ -1585,10 +1747,14 @@ void WebContents::MessageSync(bool internal,
                               blink::CloneableMessage arguments,
                               MessageSyncCallback callback) {
   TRACE_EVENT1("electron", "WebContents::MessageSync", "channel", channel);
+  OnIPCMessageReceived(arguments);
+  LongTaskMonitor::AnnotateCurrentTask(LongTaskMonitor::Source::kIPC, channel);
   // webContents.emit('-ipc-message-sync', new Event(sender, message), internal,
   // channel, arguments);
   EmitWithSender("-ipc-message-sync", receivers_.current_context(),
-                 std::move(callback), internal, channel, std::move(arguments));
+                 base::BindOnce(&WebContents::OnIPCReply, GetWeakPtr(),
+                                std::move(callback)),
+                 internal, channel, std::move(arguments));
 }
 
 void WebContents::MessageTo(bool internal,
@@ -1597,6 +1763,7 @@ void WebContents::MessageTo(bool internal,
                             const std::string& channel,
                             blink::CloneableMessage arguments) {
   TRACE_EVENT1("electron", "WebContents::MessageTo", "channel", channel);
+  OnIPCMessageReceived(arguments);
   auto* web_contents = FromID(web_contents_id);
 
   if (web_contents) {
@@ -1608,6 +1775,8 @@ void WebContents::MessageTo(bool internal,
 void WebContents::MessageHost(const std::string& channel,
                               blink::CloneableMessage arguments) {
   TRACE_EVENT1("electron", "WebContents::MessageHost", "channel", channel);
+  OnIPCMessageReceived(arguments);
+  LongTaskMonitor::AnnotateCurrentTask(LongTaskMonitor::Source::kIPC, channel);
   // webContents.emit('ipc-message-host', new Event(), channel, args);
   EmitWithSender("ipc-message-host", receivers_.current_context(),
                  InvokeCallback(), channel, std::move(arguments));
@@ -2750,6 +2919,7 @@ bool WebContents::SendIPCMessageWithSender(bool internal,
     mojo::AssociatedRemote<mojom::ElectronRenderer> electron_renderer;
     frame_host->GetRemoteAssociatedInterfaces()->GetInterface(
         &electron_renderer);
+    OnIPCMessageSent(args);
     electron_renderer->Message(internal, false, channel, args.ShallowClone(),
                                sender_id);
   }
@@ -2779,6 +2949,7 @@ bool WebContents::SendIPCMessageToFrame(bool internal,
 
   mojo::AssociatedRemote<mojom::ElectronRenderer> electron_renderer;
   (*iter)->GetRemoteAssociatedInterfaces()->GetInterface(&electron_renderer);
+  OnIPCMessageSent(message);
   electron_renderer->Message(internal, send_to_all, channel, std::move(message),
                              0 /* sender_id */);
   return true;
@@ -2929,18 +3100,14 @@ void WebContents::StartDrag(const gin_helper::Dictionary& item,
   }
 }
 
-v8::Local<v8::Promise> WebContents::CapturePage(gin::Arguments* args) {
-  gfx::Rect rect;
-  gin_helper::Promise<gfx::Image> promise(args->isolate());
-  v8::Local<v8::Promise> handle = promise.GetHandle();
-
-  // get rect arguments if they exist
-  args->GetNext(&rect);
-
+void WebContents::CopyPageSurface(
+    const gfx::Rect& rect,
+    const gfx::Size& output_size,
+    base::OnceCallback<void(const SkBitmap&)> callback) {
   auto* const view = web_contents()->GetRenderWidgetHostView();
   if (!view) {
-    promise.Resolve(gfx::Image());
-    return handle;
+    std::move(callback).Run(SkBitmap());
+    return;
   }
 
   // Capture full page if user doesn't specify a |rect|.
@@ -2958,8 +3125,98 @@ v8::Local<v8::Promise> WebContents::CapturePage(gin::Arguments* args) {
   if (scale > 1.0f)
     bitmap_size = gfx::ScaleToCeiledSize(view_size, scale);
 
+  // Let the compositor scale the copy down when a smaller output is asked for,
+  // a missing dimension preserves the aspect ratio.
+  if (!view_size.IsEmpty() &&
+      (output_size.width() > 0 || output_size.height() > 0)) {
+    if (output_size.width() > 0 && output_size.height() > 0) {
+      bitmap_size = output_size;
+    } else if (output_size.width() > 0) {
+      bitmap_size = gfx::Size(
+          output_size.width(),
+          std::max(1, output_size.width() * view_size.height() /
+                          view_size.width()));
+    } else {
+      bitmap_size = gfx::Size(std::max(1, output_size.height() *
+                                              view_size.width() /
+                                              view_size.height()),
+                              output_size.height());
+    }
+  }
+
   view->CopyFromSurface(gfx::Rect(rect.origin(), view_size), bitmap_size,
-                        base::BindOnce(&OnCapturePageDone, std::move(promise)));
+                        std::move(callback));
+}
+
+v8::Local<v8::Promise> WebContents::CapturePage(gin::Arguments* args) {
+  gfx::Rect rect;
+  gin_helper::Promise<gfx::Image> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  // get rect and options arguments if they exist
+  args->GetNext(&rect);
+  gfx::Size output_size;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options))
+    output_size = GetCaptureOutputSize(options);
+
+  CopyPageSurface(rect, output_size,
+                  base::BindOnce(&OnCapturePageDone, std::move(promise)));
+  return handle;
+}
+
+v8::Local<v8::Promise> WebContents::CapturePageToBuffer(gin::Arguments* args) {
+  v8::Isolate* isolate = args->isolate();
+  gfx::Rect rect;
+  gin_helper::Promise<v8::Local<v8::Value>> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  // get rect and options arguments if they exist
+  args->GetNext(&rect);
+  gfx::Size output_size;
+  std::string format_name = "bgra";
+  int quality = 90;
+  v8::Local<v8::Value> buffer;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    output_size = GetCaptureOutputSize(options);
+    options.Get("format", &format_name);
+    options.Get("quality", &quality);
+    options.Get("buffer", &buffer);
+  }
+
+  CaptureFormat format;
+  if (format_name == "bgra") {
+    format = CaptureFormat::kBGRA;
+  } else if (format_name == "png") {
+    format = CaptureFormat::kPNG;
+  } else if (format_name == "jpeg") {
+    format = CaptureFormat::kJPEG;
+  } else {
+    promise.RejectWithErrorMessage(
+        "format must be one of 'bgra', 'png' or 'jpeg'");
+    return handle;
+  }
+
+  v8::Global<v8::Value> target;
+  if (!buffer.IsEmpty() && !buffer->IsUndefined()) {
+    if (format != CaptureFormat::kBGRA ||
+        !(buffer->IsArrayBufferView() || buffer->IsArrayBuffer())) {
+      promise.RejectWithErrorMessage(
+          "buffer must be a Buffer or an ArrayBuffer and is only supported by "
+          "the 'bgra' format");
+      return handle;
+    }
+    if (buffer->IsArrayBuffer()) {
+      auto array_buffer = buffer.As<v8::ArrayBuffer>();
+      buffer = v8::Uint8Array::New(array_buffer, 0, array_buffer->ByteLength());
+    }
+    target.Reset(isolate, buffer);
+  }
+
+  CopyPageSurface(rect, output_size,
+                  base::BindOnce(&OnCapturePageToBufferDone, std::move(promise),
+                                 format, quality, std::move(target)));
   return handle;
 }
 
@@ -3386,6 +3643,178 @@ v8::Local<v8::Promise> WebContents::TakeHeapSnapshot(
   return handle;
 }
 
+v8::Local<v8::Promise> WebContents::TakeCpuProfile(
+    const base::FilePath& file_path,
+    gin::Arguments* args) {
+  gin_helper::Promise<void> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  int duration = 10000;
+  int sampling_interval = 1000;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    options.Get("duration", &duration);
+    options.Get("samplingInterval", &sampling_interval);
+  }
+  if (duration <= 0 || sampling_interval <= 0) {
+    promise.RejectWithErrorMessage("Invalid CPU profile options");
+    return handle;
+  }
+
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+  base::File file(file_path,
+                  base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  if (!file.IsValid()) {
+    promise.RejectWithErrorMessage("takeCpuProfile failed");
+    return handle;
+  }
+
+  auto* frame_host = web_contents()->GetMainFrame();
+  if (!frame_host) {
+    promise.RejectWithErrorMessage("takeCpuProfile failed");
+    return handle;
+  }
+
+  auto electron_renderer =
+      std::make_unique<mojo::AssociatedRemote<mojom::ElectronRenderer>>();
+  frame_host->GetRemoteAssociatedInterfaces()->GetInterface(
+      electron_renderer.get());
+  auto* raw_ptr = electron_renderer.get();
+  (*raw_ptr)->TakeCpuProfile(
+      mojo::WrapPlatformFile(base::ScopedPlatformFile(file.TakePlatformFile())),
+      base::TimeDelta::FromMilliseconds(duration),
+      base::TimeDelta::FromMicroseconds(sampling_interval),
+      mojo::WrapCallbackWithDefaultInvokeIfNotRun(
+          base::BindOnce(
+              [](mojo::AssociatedRemote<mojom::ElectronRenderer>* ep,
+                 gin_helper::Promise<void> promise, bool success) {
+                if (success) {
+                  promise.Resolve();
+                } else {
+                  promise.RejectWithErrorMessage("takeCpuProfile failed");
+                }
+              },
+              base::Owned(std::move(electron_renderer)), std::move(promise)),
+          false));
+  return handle;
+}
+
+v8::Local<v8::Value> WebContents::TakeHeapSnapshotStream(gin::Arguments* args) {
+  auto* frame_host = web_contents()->GetMainFrame();
+  if (!frame_host) {
+    args->ThrowError("takeHeapSnapshotStream failed");
+    return v8::Null(args->isolate());
+  }
+
+  mojo::DataPipe data_pipe(kHeapSnapshotPipeCapacity);
+  if (!data_pipe.producer_handle.is_valid()) {
+    args->ThrowError("takeHeapSnapshotStream failed");
+    return v8::Null(args->isolate());
+  }
+  auto stream = DataPipeStream::Create(args->isolate(),
+                                       std::move(data_pipe.consumer_handle));
+
+  // See TakeHeapSnapshot for why the interface is owned by the callback.
+  auto electron_renderer =
+      std::make_unique<mojo::AssociatedRemote<mojom::ElectronRenderer>>();
+  frame_host->GetRemoteAssociatedInterfaces()->GetInterface(
+      electron_renderer.get());
+  auto* raw_ptr = electron_renderer.get();
+  (*raw_ptr)->TakeHeapSnapshotStream(
+      std::move(data_pipe.producer_handle),
+      mojo::WrapCallbackWithDefaultInvokeIfNotRun(
+          base::BindOnce(
+              [](mojo::AssociatedRemote<mojom::ElectronRenderer>* ep,
+                 base::WeakPtr<DataPipeStream> stream, bool success) {
+                if (stream)
+                  stream->SetResult(success, "takeHeapSnapshotStream failed");
+              },
+              base::Owned(std::move(electron_renderer)), stream->GetWeakPtr()),
+          false));
+  return stream.ToV8();
+}
+
+v8::Local<v8::Promise> WebContents::StartSamplingHeapProfiler(
+    gin::Arguments* args) {
+  gin_helper::Promise<void> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  // The defaults of V8, which keep the overhead low.
+  uint64_t sampling_interval = 512 * 1024;
+  int stack_depth = 16;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    options.Get("samplingInterval", &sampling_interval);
+    options.Get("stackDepth", &stack_depth);
+  }
+  if (sampling_interval == 0 || stack_depth <= 0) {
+    promise.RejectWithErrorMessage("Invalid sampling heap profiler options");
+    return handle;
+  }
+
+  auto* frame_host = web_contents()->GetMainFrame();
+  if (!frame_host) {
+    promise.RejectWithErrorMessage("startSamplingHeapProfiler failed");
+    return handle;
+  }
+
+  auto electron_renderer =
+      std::make_unique<mojo::AssociatedRemote<mojom::ElectronRenderer>>();
+  frame_host->GetRemoteAssociatedInterfaces()->GetInterface(
+      electron_renderer.get());
+  auto* raw_ptr = electron_renderer.get();
+  (*raw_ptr)->StartSamplingHeapProfiler(
+      sampling_interval, stack_depth,
+      mojo::WrapCallbackWithDefaultInvokeIfNotRun(
+          base::BindOnce(
+              [](mojo::AssociatedRemote<mojom::ElectronRenderer>* ep,
+                 gin_helper::Promise<void> promise, bool success) {
+                if (success) {
+                  promise.Resolve();
+                } else {
+                  promise.RejectWithErrorMessage(
+                      "startSamplingHeapProfiler failed");
+                }
+              },
+              base::Owned(std::move(electron_renderer)), std::move(promise)),
+          false));
+  return handle;
+}
+
+v8::Local<v8::Promise> WebContents::StopSamplingHeapProfiler(
+    v8::Isolate* isolate) {
+  gin_helper::Promise<std::string> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  auto* frame_host = web_contents()->GetMainFrame();
+  if (!frame_host) {
+    promise.RejectWithErrorMessage("stopSamplingHeapProfiler failed");
+    return handle;
+  }
+
+  auto electron_renderer =
+      std::make_unique<mojo::AssociatedRemote<mojom::ElectronRenderer>>();
+  frame_host->GetRemoteAssociatedInterfaces()->GetInterface(
+      electron_renderer.get());
+  auto* raw_ptr = electron_renderer.get();
+  (*raw_ptr)->StopSamplingHeapProfiler(
+      mojo::WrapCallbackWithDefaultInvokeIfNotRun(
+          base::BindOnce(
+              [](mojo::AssociatedRemote<mojom::ElectronRenderer>* ep,
+                 gin_helper::Promise<std::string> promise,
+                 const std::string& profile) {
+                if (profile.empty()) {
+                  promise.RejectWithErrorMessage(
+                      "The sampling heap profiler is not running");
+                } else {
+                  promise.Resolve(profile);
+                }
+              },
+              base::Owned(std::move(electron_renderer)), std::move(promise)),
+          std::string()));
+  return handle;
+}
+
 void WebContents::UpdatePreferredSize(content::WebContents* web_contents,
                                       const gfx::Size& pref_size) {
   Emit("preferred-size-changed", pref_size);
@@ -3868,6 +4297,7 @@ v8::Local<v8::ObjectTemplate> WebContents::FillObjectTemplate(
                  &WebContents::ShowDefinitionForSelection)
       .SetMethod("copyImageAt", &WebContents::CopyImageAt)
       .SetMethod("capturePage", &WebContents::CapturePage)
+      .SetMethod("capturePageToBuffer", &WebContents::CapturePageToBuffer)
       .SetMethod("setEmbedder", &WebContents::SetEmbedder)
       .SetMethod("setDevToolsWebContents", &WebContents::SetDevToolsWebContents)
       .SetMethod("getNativeView", &WebContents::GetNativeView)
@@ -3880,6 +4310,13 @@ v8::Local<v8::ObjectTemplate> WebContents::FillObjectTemplate(
                  &WebContents::GetWebRTCIPHandlingPolicy)
       .SetMethod("_grantOriginAccess", &WebContents::GrantOriginAccess)
       .SetMethod("takeHeapSnapshot", &WebContents::TakeHeapSnapshot)
+      .SetMethod("_takeHeapSnapshotStream",
+                 &WebContents::TakeHeapSnapshotStream)
+      .SetMethod("takeCpuProfile", &WebContents::TakeCpuProfile)
+      .SetMethod("startSamplingHeapProfiler",
+                 &WebContents::StartSamplingHeapProfiler)
+      .SetMethod("stopSamplingHeapProfiler",
+                 &WebContents::StopSamplingHeapProfiler)
       .SetProperty("id", &WebContents::ID)
       .SetProperty("session", &WebContents::Session)
       .SetProperty("hostWebContents", &WebContents::HostWebContents)
@@ -3979,6 +4416,170 @@ std::vector<gin::Handle<WebContents>> GetAllWebContentsAsV8(
   return list;
 }
 
+// How long getRendererResourceUsage() waits for each renderer, the ones that
+// reply later are left out.
+constexpr base::TimeDelta kRendererResourceUsageTimeout =
+    base::TimeDelta::FromSeconds(1);
+
+// The WebContents sharing a renderer process, and the usage reported by it.
+struct RendererResourceUsage {
+  base::ProcessId pid = base::kNullProcessId;
+  std::vector<std::pair<int32_t, WebContents::IPCCounters>> web_contents;
+  electron::mojom::RendererResourceUsagePtr usage;
+  // Set once the renderer replied, went away or timed out.
+  bool done = false;
+};
+
+using RendererResourceUsageList =
+    base::RefCountedData<std::vector<RendererResourceUsage>>;
+
+gin_helper::Dictionary CreateResourceTypeStat(
+    v8::Isolate* isolate,
+    const electron::mojom::ResourceTypeStatPtr& stat) {
+  gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+  dict.Set("count", static_cast<double>(stat->count));
+  dict.Set("size", static_cast<double>(stat->size));
+  dict.Set("liveSize", static_cast<double>(stat->decoded_size));
+  return dict;
+}
+
+void ResolveRendererResourceUsage(
+    gin_helper::Promise<std::vector<gin_helper::Dictionary>> promise,
+    scoped_refptr<RendererResourceUsageList> renderers) {
+  v8::Isolate* isolate = promise.isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(promise.GetContext());
+
+  std::vector<gin_helper::Dictionary> result;
+  for (const RendererResourceUsage& renderer : renderers->data) {
+    // The renderer went away or timed out before replying.
+    if (!renderer.usage)
+      continue;
+    const auto& usage = renderer.usage;
+
+    std::vector<gin_helper::Dictionary> ipc;
+    for (const auto& it : renderer.web_contents) {
+      gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+      dict.Set("webContentsId", it.first);
+      dict.Set("messagesReceived",
+               static_cast<double>(it.second.messages_received));
+      dict.Set("bytesReceived", static_cast<double>(it.second.bytes_received));
+      dict.Set("messagesSent", static_cast<double>(it.second.messages_sent));
+      dict.Set("bytesSent", static_cast<double>(it.second.bytes_sent));
+      ipc.push_back(dict);
+    }
+
+    // In KB, like process.getHeapStatistics() and getBlinkMemoryInfo().
+    gin_helper::Dictionary js_heap = gin::Dictionary::CreateEmpty(isolate);
+    js_heap.Set("usedHeapSize",
+                static_cast<double>(usage->js_heap_used_size >> 10));
+    js_heap.Set("totalHeapSize",
+                static_cast<double>(usage->js_heap_total_size >> 10));
+    js_heap.Set("heapSizeLimit",
+                static_cast<double>(usage->js_heap_size_limit >> 10));
+    gin_helper::Dictionary blink_heap = gin::Dictionary::CreateEmpty(isolate);
+    blink_heap.Set("allocated",
+                   static_cast<double>(usage->blink_heap_allocated_size >> 10));
+    blink_heap.Set("total",
+                   static_cast<double>(usage->blink_heap_total_size >> 10));
+
+    // Like webFrame.getResourceUsage().
+    gin_helper::Dictionary cache = gin::Dictionary::CreateEmpty(isolate);
+    cache.Set("images", CreateResourceTypeStat(isolate, usage->images));
+    cache.Set("scripts", CreateResourceTypeStat(isolate, usage->scripts));
+    cache.Set("cssStyleSheets",
+              CreateResourceTypeStat(isolate, usage->css_style_sheets));
+    cache.Set("xslStyleSheets",
+              CreateResourceTypeStat(isolate, usage->xsl_style_sheets));
+    cache.Set("fonts", CreateResourceTypeStat(isolate, usage->fonts));
+    cache.Set("other", CreateResourceTypeStat(isolate, usage->other));
+
+    gin_helper::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+    dict.Set("pid", renderer.pid);
+    dict.Set("ipc", ipc);
+    dict.Set("heap", js_heap);
+    dict.Set("blinkMemory", blink_heap);
+    dict.Set("cache", cache);
+    result.push_back(dict);
+  }
+  promise.Resolve(result);
+}
+
+// Asks each renderer process once, however many WebContents it hosts, and
+// resolves when all of them have replied or timed out.
+v8::Local<v8::Promise> GetRendererResourceUsage(v8::Isolate* isolate) {
+  gin_helper::Promise<std::vector<gin_helper::Dictionary>> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  auto renderers = base::MakeRefCounted<RendererResourceUsageList>();
+  std::vector<content::RenderFrameHost*> frames;
+  std::map<content::RenderProcessHost*, size_t> indices;
+  for (auto iter = base::IDMap<WebContents*>::iterator(&GetAllWebContents());
+       !iter.IsAtEnd(); iter.Advance()) {
+    WebContents* contents = iter.GetCurrentValue();
+    if (!contents->web_contents())
+      continue;
+    content::RenderFrameHost* frame_host =
+        contents->web_contents()->GetMainFrame();
+    if (!frame_host || !frame_host->IsRenderFrameLive())
+      continue;
+    content::RenderProcessHost* process = frame_host->GetProcess();
+    auto index = indices.find(process);
+    if (index == indices.end()) {
+      index = indices.emplace(process, renderers->data.size()).first;
+      renderers->data.emplace_back();
+      renderers->data.back().pid = process->GetProcess().Pid();
+      frames.push_back(frame_host);
+    }
+    renderers->data[index->second].web_contents.emplace_back(
+        contents->ID(), contents->ipc_counters());
+  }
+
+  base::RepeatingClosure barrier = base::BarrierClosure(
+      static_cast<int>(frames.size()),
+      base::BindOnce(&ResolveRendererResourceUsage, std::move(promise),
+                     renderers));
+  for (size_t i = 0; i < frames.size(); ++i) {
+    auto electron_renderer = std::make_unique<
+        mojo::AssociatedRemote<electron::mojom::ElectronRenderer>>();
+    frames[i]->GetRemoteAssociatedInterfaces()->GetInterface(
+        electron_renderer.get());
+    auto* raw_ptr = electron_renderer.get();
+    (*raw_ptr)->GetResourceUsage(mojo::WrapCallbackWithDefaultInvokeIfNotRun(
+        base::BindOnce(
+            [](mojo::AssociatedRemote<electron::mojom::ElectronRenderer>* ep,
+               scoped_refptr<RendererResourceUsageList> renderers, size_t i,
+               base::RepeatingClosure barrier,
+               electron::mojom::RendererResourceUsagePtr usage) {
+              RendererResourceUsage& renderer = renderers->data[i];
+              if (renderer.done)
+                return;
+              renderer.done = true;
+              renderer.usage = std::move(usage);
+              barrier.Run();
+            },
+            base::Owned(std::move(electron_renderer)), renderers, i, barrier),
+        electron::mojom::RendererResourceUsagePtr()));
+  }
+
+  // A hung renderer must not hold back the usage of the others.
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](scoped_refptr<RendererResourceUsageList> renderers,
+             base::RepeatingClosure barrier) {
+            for (RendererResourceUsage& renderer : renderers->data) {
+              if (renderer.done)
+                continue;
+              renderer.done = true;
+              barrier.Run();
+            }
+          },
+          renderers, barrier),
+      kRendererResourceUsageTimeout);
+  return handle;
+}
+
 void Initialize(v8::Local<v8::Object> exports,
                 v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context,
@@ -3989,6 +4590,7 @@ void Initialize(v8::Local<v8::Object> exports,
   dict.SetMethod("create", &WebContents::Create);
   dict.SetMethod("fromId", &WebContents::FromID);
   dict.SetMethod("getAllWebContents", &GetAllWebContentsAsV8);
+  dict.SetMethod("getRendererResourceUsage", &GetRendererResourceUsage);
 }
 
 }  // namespace
@@ -65,6 +65,8 @@ class ScriptExecutor;
 
 #include "discord/overlay.h"
 
+class SkBitmap;
+
 namespace blink {
 struct DeviceEmulationParams;
 }
@@ -335,6 +337,14 @@ class WebContents : public gin::Wrappable<WebContents>,
   // Captures the page with |rect|, |callback| would be called when capturing is
   // done.
   v8::Local<v8::Promise> CapturePage(gin::Arguments* args);
+  // Same as CapturePage, but resolves with the raw or encoded pixels in a
+  // Buffer instead of a NativeImage.
+  v8::Local<v8::Promise> CapturePageToBuffer(gin::Arguments* args);
+  // Copies |rect| of the page scaled to |output_size|, |callback| receives an
+  // empty bitmap when there is nothing to capture.
+  void CopyPageSurface(const gfx::Rect& rect,
+                       const gfx::Size& output_size,
+                       base::OnceCallback<void(const SkBitmap&)> callback);
 
   // Methods for creating <webview>.
   bool IsGuest() const;
@@ -403,6 +413,20 @@ class WebContents : public gin::Wrappable<WebContents>,
 
   v8::Local<v8::Promise> TakeHeapSnapshot(v8::Isolate* isolate,
                                           const base::FilePath& file_path);
+  v8::Local<v8::Value> TakeHeapSnapshotStream(gin::Arguments* args);
+  v8::Local<v8::Promise> TakeCpuProfile(const base::FilePath& file_path,
+                                        gin::Arguments* args);
+  v8::Local<v8::Promise> StartSamplingHeapProfiler(gin::Arguments* args);
+  v8::Local<v8::Promise> StopSamplingHeapProfiler(v8::Isolate* isolate);
+
+  // The IPC messages exchanged with the frames of this WebContents.
+  struct IPCCounters {
+    uint64_t messages_received = 0;
+    uint64_t bytes_received = 0;
+    uint64_t messages_sent = 0;
+    uint64_t bytes_sent = 0;
+  };
+  const IPCCounters& ipc_counters() const { return ipc_counters_; }
 
   // Properties.
   int32_t ID() const { return id_; }
@@ -672,6 +696,14 @@ class WebContents : public gin::Wrappable<WebContents>,
 
   uint32_t GetNextRequestId() { return ++request_id_; }
 
+  void OnIPCMessageReceived(const blink::CloneableMessage& message);
+  void OnIPCMessageSent(const blink::CloneableMessage& message);
+  // Counts the reply to ipcRenderer.invoke() or ipcRenderer.sendSync() as
+  // sent, unless |web_contents| is gone.
+  static void OnIPCReply(base::WeakPtr<WebContents> web_contents,
+                         InvokeCallback callback,
+                         blink::CloneableMessage result);
+
 #if BUILDFLAG(ENABLE_OSR)
   OffScreenWebContentsView* GetOffScreenWebContentsView() const;
   OffScreenRenderWidgetHostView* GetOffScreenRenderWidgetHostView() const;
@@ -809,6 +841,8 @@ class WebContents : public gin::Wrappable<WebContents>,
   // Request id used for findInPage request.
   uint32_t request_id_ = 0;
 
+  IPCCounters ipc_counters_;
+
   // Whether background throttling is disabled.
   bool background_throttling_ = true;
 
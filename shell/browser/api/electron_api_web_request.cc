@@ -4,11 +4,17 @@
 
 #include "shell/browser/api/electron_api_web_request.h"
 
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "base/memory/ref_counted_memory.h"
 #include "base/stl_util.h"
+#include "base/strings/string_util.h"
 #include "base/values.h"
 #include "extensions/browser/api/web_request/web_request_resource_type.h"
 #include "gin/converter.h"
@@ -24,6 +30,7 @@
 #include "shell/common/gin_converters/net_converter.h"
 #include "shell/common/gin_converters/std_converter.h"
 #include "shell/common/gin_converters/value_converter.h"
+#include "shell/common/node_includes.h"
 
 namespace gin {
 
@@ -90,19 +97,135 @@ struct UserData : public base::SupportsUserData::Data {
   WebRequest* data;
 };
 
-// Test whether the URL of |request| matches |patterns|.
-bool MatchesFilterCondition(extensions::WebRequestInfo* info,
-                            const std::set<URLPattern>& patterns) {
-  if (patterns.empty())
-    return true;
-
-  for (const auto& pattern : patterns) {
-    if (pattern.MatchesURL(info->url))
+// Parse |filter_patterns| into |patterns|, returning an error message on
+// failure.
+bool ParseURLPatterns(const std::set<std::string>& filter_patterns,
+                      std::set<URLPattern>* patterns,
+                      std::string* error) {
+  for (const std::string& filter_pattern : filter_patterns) {
+    URLPattern pattern(URLPattern::SCHEME_ALL);
+    const URLPattern::ParseResult result = pattern.Parse(filter_pattern);
+    if (result != URLPattern::ParseResult::kSuccess) {
+      const char* error_type = URLPattern::GetParseResultString(result);
+      *error = "Invalid url pattern " + filter_pattern + ": " + error_type;
+      return false;
+    }
+    patterns->insert(pattern);
+  }
+  return true;
+}
+
+bool ResourceTypeFromString(const std::string& name,
+                            extensions::WebRequestResourceType* type) {
+  static constexpr std::pair<const char*, extensions::WebRequestResourceType>
+      kResourceTypes[] = {
+          {"mainFrame", extensions::WebRequestResourceType::MAIN_FRAME},
+          {"subFrame", extensions::WebRequestResourceType::SUB_FRAME},
+          {"stylesheet", extensions::WebRequestResourceType::STYLESHEET},
+          {"script", extensions::WebRequestResourceType::SCRIPT},
+          {"image", extensions::WebRequestResourceType::IMAGE},
+          {"object", extensions::WebRequestResourceType::OBJECT},
+          {"xhr", extensions::WebRequestResourceType::XHR},
+          {"other", extensions::WebRequestResourceType::OTHER},
+      };
+  for (const auto& resource_type : kResourceTypes) {
+    if (name == resource_type.first) {
+      *type = resource_type.second;
       return true;
+    }
   }
   return false;
 }
 
+// Read the |set| and |remove| lists of a rule's header modifications.
+bool ReadHeaderModifications(gin::Dictionary* rule,
+                             const char* key,
+                             std::map<std::string, std::string>* set_headers,
+                             std::set<std::string>* remove_headers) {
+  gin::Dictionary headers(rule->isolate());
+  if (!rule->Get(key, &headers))
+    return true;
+  v8::Local<v8::Value> value;
+  if (headers.Get("set", &value) &&
+      !gin::ConvertFromV8(rule->isolate(), value, set_headers))
+    return false;
+  if (headers.Get("remove", &value) &&
+      !gin::ConvertFromV8(rule->isolate(), value, remove_headers))
+    return false;
+  return true;
+}
+
+// Convert a JS rule object into a WebRequestRule, returning an error message
+// on failure.
+bool ParseRule(v8::Isolate* isolate,
+               v8::Local<v8::Value> value,
+               WebRequestRule* rule,
+               std::string* error) {
+  gin::Dictionary dict(isolate);
+  if (!gin::ConvertFromV8(isolate, value, &dict)) {
+    *error = "Rule must be an object.";
+    return false;
+  }
+
+  std::set<std::string> filter_patterns;
+  std::set<URLPattern> patterns;
+  if (dict.Get("urls", &filter_patterns) &&
+      !ParseURLPatterns(filter_patterns, &patterns, error))
+    return false;
+  rule->url_patterns = URLPatternMatcher(patterns);
+
+  std::vector<std::string> resource_types;
+  dict.Get("resourceTypes", &resource_types);
+  for (const auto& name : resource_types) {
+    extensions::WebRequestResourceType type;
+    if (!ResourceTypeFromString(name, &type)) {
+      *error = "Invalid resource type " + name;
+      return false;
+    }
+    rule->resource_types.insert(type);
+  }
+
+  std::vector<std::string> methods;
+  dict.Get("methods", &methods);
+  for (const auto& method : methods)
+    rule->methods.insert(base::ToUpperASCII(method));
+
+  std::string action;
+  dict.Get("action", &action);
+  if (action == "block") {
+    rule->action = WebRequestRule::Action::kBlock;
+  } else if (action == "redirect") {
+    rule->action = WebRequestRule::Action::kRedirect;
+    if (!dict.Get("redirectURL", &rule->redirect_url) ||
+        !rule->redirect_url.is_valid()) {
+      *error = "Redirect rules must have a valid 'redirectURL'.";
+      return false;
+    }
+  } else if (action == "modifyHeaders") {
+    rule->action = WebRequestRule::Action::kModifyHeaders;
+    if (!ReadHeaderModifications(&dict, "requestHeaders",
+                                 &rule->set_request_headers,
+                                 &rule->remove_request_headers) ||
+        !ReadHeaderModifications(&dict, "responseHeaders",
+                                 &rule->set_response_headers,
+                                 &rule->remove_response_headers)) {
+      *error = "Invalid header modifications.";
+      return false;
+    }
+  } else {
+    *error = "Rule action must be one of 'block', 'redirect' or "
+             "'modifyHeaders'.";
+    return false;
+  }
+  return true;
+}
+
+// Test whether the URL of |request| matches |patterns|.
+bool MatchesFilterCondition(extensions::WebRequestInfo* info,
+                            const URLPatternMatcher& patterns) {
+  return patterns.empty() || patterns.MatchesURL(info->url);
+}
+
 // Convert HttpResponseHeaders to V8.
 //
 // Note that while we already have converters for HttpResponseHeaders, we can
@@ -139,23 +262,103 @@ v8::Local<v8::Value> HttpResponseHeadersToV8(
   return gin::ConvertToV8(v8::Isolate::GetCurrent(), response_headers);
 }
 
+v8::Local<v8::Value> ResponseHeadersToV8(
+    scoped_refptr<net::HttpResponseHeaders> headers) {
+  return HttpResponseHeadersToV8(headers.get());
+}
+
+v8::Local<v8::Value> RequestHeadersToV8(
+    const net::HttpRequestHeaders& headers) {
+  return gin::ConvertToV8(v8::Isolate::GetCurrent(), headers);
+}
+
+v8::Local<v8::Value> UploadDataToV8(
+    scoped_refptr<network::ResourceRequestBody> body) {
+  return gin::ConvertToV8(v8::Isolate::GetCurrent(), *body);
+}
+
+// Called the first time a lazy property of the details is read, |info.Data()|
+// is the function that computes its value.
+void GetLazyDetail(v8::Local<v8::Name> name,
+                   const v8::PropertyCallbackInfo<v8::Value>& info) {
+  v8::Isolate* isolate = info.GetIsolate();
+  v8::Local<v8::Value> value;
+  if (info.Data()
+          .As<v8::Function>()
+          ->Call(isolate->GetCurrentContext(), v8::Undefined(isolate), 0,
+                 nullptr)
+          .ToLocal(&value))
+    info.GetReturnValue().Set(value);
+}
+
+// The details object passed to listeners.
+//
+// Only the fields declared by the listener are set, and the fields that are
+// expensive to convert (headers and upload data) are only converted when the
+// listener reads them.
+class Details {
+ public:
+  Details(v8::Isolate* isolate, const std::set<std::string>& fields)
+      : isolate_(isolate),
+        object_(v8::Object::New(isolate)),
+        dict_(isolate, object_),
+        fields_(fields) {}
+
+  bool Wants(const std::string& key) const {
+    return fields_.empty() || base::Contains(fields_, key);
+  }
+
+  template <typename T>
+  void Set(const std::string& key, const T& value) {
+    if (Wants(key))
+      dict_.Set(key, value);
+  }
+
+  void SetLazy(const std::string& key,
+               base::OnceCallback<v8::Local<v8::Value>()> getter) {
+    if (!Wants(key))
+      return;
+    object_
+        ->SetLazyDataProperty(
+            isolate_->GetCurrentContext(), gin::StringToV8(isolate_, key),
+            &GetLazyDetail, gin::ConvertToV8(isolate_, std::move(getter)))
+        .Check();
+  }
+
+  v8::Local<v8::Object> GetHandle() const { return object_; }
+
+ private:
+  v8::Isolate* isolate_;
+  v8::Local<v8::Object> object_;
+  gin::Dictionary dict_;
+  const std::set<std::string>& fields_;
+
+  DISALLOW_COPY_AND_ASSIGN(Details);
+};
+
 // Overloaded by multiple types to fill the |details| object.
-void ToDictionary(gin::Dictionary* details, extensions::WebRequestInfo* info) {
+void ToDictionary(Details* details, extensions::WebRequestInfo* info) {
   details->Set("id", info->id);
   details->Set("url", info->url);
   details->Set("method", info->method);
-  details->Set("timestamp", base::Time::Now().ToDoubleT() * 1000);
+  if (details->Wants("timestamp"))
+    details->Set("timestamp", base::Time::Now().ToDoubleT() * 1000);
   details->Set("resourceType", info->web_request_type);
   if (!info->response_ip.empty())
     details->Set("ip", info->response_ip);
   if (info->response_headers) {
     details->Set("fromCache", info->response_from_cache);
-    details->Set("statusLine", info->response_headers->GetStatusLine());
+    if (details->Wants("statusLine"))
+      details->Set("statusLine", info->response_headers->GetStatusLine());
     details->Set("statusCode", info->response_headers->response_code());
-    details->Set("responseHeaders",
-                 HttpResponseHeadersToV8(info->response_headers.get()));
+    details->SetLazy("responseHeaders",
+                     base::BindOnce(&ResponseHeadersToV8,
+                                    scoped_refptr<net::HttpResponseHeaders>(
+                                        info->response_headers)));
   }
 
+  if (!details->Wants("webContentsId"))
+    return;
   auto* web_contents = content::WebContents::FromRenderFrameHost(
       content::RenderFrameHost::FromID(info->render_process_id,
                                        info->frame_id));
@@ -164,34 +367,35 @@ void ToDictionary(gin::Dictionary* details, extensions::WebRequestInfo* info) {
     details->Set("webContentsId", api_web_contents->ID());
 }
 
-void ToDictionary(gin::Dictionary* details,
-                  const network::ResourceRequest& request) {
+void ToDictionary(Details* details, const network::ResourceRequest& request) {
   details->Set("referrer", request.referrer);
   if (request.request_body)
-    details->Set("uploadData", *request.request_body);
+    details->SetLazy("uploadData",
+                     base::BindOnce(&UploadDataToV8, request.request_body));
 }
 
-void ToDictionary(gin::Dictionary* details,
-                  const net::HttpRequestHeaders& headers) {
-  details->Set("requestHeaders", headers);
+void ToDictionary(Details* details, const net::HttpRequestHeaders& headers) {
+  details->SetLazy("requestHeaders",
+                   base::BindOnce(&RequestHeadersToV8, headers));
 }
 
-void ToDictionary(gin::Dictionary* details, const GURL& location) {
+void ToDictionary(Details* details, const GURL& location) {
   details->Set("redirectURL", location);
 }
 
-void ToDictionary(gin::Dictionary* details, int net_error) {
-  details->Set("error", net::ErrorToString(net_error));
+void ToDictionary(Details* details, int net_error) {
+  if (details->Wants("error"))
+    details->Set("error", net::ErrorToString(net_error));
 }
 
 // Helper function to fill |details| with arbitrary |args|.
 template <typename Arg>
-void FillDetails(gin::Dictionary* details, Arg arg) {
+void FillDetails(Details* details, Arg arg) {
   ToDictionary(details, arg);
 }
 
 template <typename Arg, typename... Args>
-void FillDetails(gin::Dictionary* details, Arg arg, Args... args) {
+void FillDetails(Details* details, Arg arg, Args... args) {
   ToDictionary(details, arg);
   FillDetails(details, args...);
 }
@@ -226,31 +430,121 @@ void ReadFromResponse(v8::Isolate* isolate,
   }
 }
 
+// A message waiting for the result of a webRequest.onWebSocketFrame listener.
+// The connection waits for the result, so the message is forwarded unchanged
+// if the listener drops the callback.
+class PendingWebSocketMessage {
+ public:
+  PendingWebSocketMessage(scoped_refptr<base::RefCountedString> data,
+                          WebSocketFrameMonitor::ResultCallback callback)
+      : data_(std::move(data)), callback_(std::move(callback)) {}
+
+  ~PendingWebSocketMessage() {
+    if (callback_)
+      Forward();
+  }
+
+  void Cancel() { std::move(callback_).Run(true, std::string()); }
+
+  void Replace(std::string data) {
+    std::move(callback_).Run(false, std::move(data));
+  }
+
+  // Forwards the original data, which includes the changes made in place to
+  // the Buffer of a binary message. The data is only copied while that Buffer
+  // is alive.
+  void Forward() {
+    std::string data =
+        data_->HasOneRef() ? std::move(data_->data()) : data_->data();
+    std::move(callback_).Run(false, std::move(data));
+  }
+
+ private:
+  scoped_refptr<base::RefCountedString> data_;
+  WebSocketFrameMonitor::ResultCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingWebSocketMessage);
+};
+
+void ReleaseWebSocketMessage(char* data, void* hint) {
+  static_cast<base::RefCountedString*>(hint)->Release();
+}
+
+// Hands |data| to a node Buffer without copying it, the Buffer keeps a
+// reference to it.
+v8::Local<v8::Value> WebSocketMessageToBuffer(
+    v8::Isolate* isolate,
+    scoped_refptr<base::RefCountedString> data) {
+  if (data->size() == 0)
+    return node::Buffer::New(isolate, 0).ToLocalChecked();
+  char* bytes = &data->data()[0];
+  size_t size = data->size();
+  return node::Buffer::New(isolate, bytes, size, &ReleaseWebSocketMessage,
+                           data.release())
+      .ToLocalChecked();
+}
+
+// Read the result of a webRequest.onWebSocketFrame listener.
+void OnWebSocketFrameResult(std::unique_ptr<PendingWebSocketMessage> message,
+                            v8::Local<v8::Value> response) {
+  if (response->IsObject()) {
+    v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+    gin::Dictionary dict(isolate, response.As<v8::Object>());
+
+    bool cancel = false;
+    dict.Get("cancel", &cancel);
+    if (cancel) {
+      message->Cancel();
+      return;
+    }
+
+    v8::Local<v8::Value> value;
+    if (dict.Get("data", &value)) {
+      std::string data;
+      if (node::Buffer::HasInstance(value))
+        data.assign(node::Buffer::Data(value), node::Buffer::Length(value));
+      else
+        gin::ConvertFromV8(isolate, value, &data);
+      message->Replace(std::move(data));
+      return;
+    }
+  }
+  message->Forward();
+}
+
 }  // namespace
 
 gin::WrapperInfo WebRequest::kWrapperInfo = {gin::kEmbedderNativeGin};
 
 WebRequest::SimpleListenerInfo::SimpleListenerInfo(
     std::set<URLPattern> patterns_,
+    std::set<std::string> fields_,
     SimpleListener listener_)
-    : url_patterns(std::move(patterns_)), listener(listener_) {}
+    : url_patterns(patterns_),
+      fields(std::move(fields_)),
+      listener(listener_) {}
 WebRequest::SimpleListenerInfo::SimpleListenerInfo() = default;
 WebRequest::SimpleListenerInfo::~SimpleListenerInfo() = default;
 
 WebRequest::ResponseListenerInfo::ResponseListenerInfo(
     std::set<URLPattern> patterns_,
+    std::set<std::string> fields_,
     ResponseListener listener_)
-    : url_patterns(std::move(patterns_)), listener(listener_) {}
+    : url_patterns(patterns_),
+      fields(std::move(fields_)),
+      listener(listener_) {}
 WebRequest::ResponseListenerInfo::ResponseListenerInfo() = default;
 WebRequest::ResponseListenerInfo::~ResponseListenerInfo() = default;
 
 WebRequest::WebRequest(v8::Isolate* isolate,
                        content::BrowserContext* browser_context)
-    : browser_context_(browser_context) {
+    : websocket_frame_monitor_(base::MakeRefCounted<WebSocketFrameMonitor>()),
+      browser_context_(browser_context) {
   browser_context_->SetUserData(kUserDataKey, std::make_unique<UserData>(this));
 }
 
 WebRequest::~WebRequest() {
+  websocket_frame_monitor_->ClearHandler();
   browser_context_->RemoveUserData(kUserDataKey);
 }
 
@@ -271,7 +565,12 @@ gin::ObjectTemplateBuilder WebRequest::GetObjectTemplateBuilder(
                  &WebRequest::SetSimpleListener<kOnResponseStarted>)
       .SetMethod("onErrorOccurred",
                  &WebRequest::SetSimpleListener<kOnErrorOccurred>)
-      .SetMethod("onCompleted", &WebRequest::SetSimpleListener<kOnCompleted>);
+      .SetMethod("onCompleted", &WebRequest::SetSimpleListener<kOnCompleted>)
+      .SetMethod("setRules", &WebRequest::SetRules)
+      .SetMethod("onWebSocketFrame", &WebRequest::SetWebSocketFrameListener)
+      .SetMethod("setWebSocketStatsEnabled",
+                 &WebRequest::SetWebSocketStatsEnabled)
+      .SetMethod("getWebSocketStats", &WebRequest::GetWebSocketStats);
 }
 
 const char* WebRequest::GetTypeName() {
@@ -279,7 +578,16 @@ const char* WebRequest::GetTypeName() {
 }
 
 bool WebRequest::HasListener() const {
-  return !(simple_listeners_.empty() && response_listeners_.empty());
+  return !(simple_listeners_.empty() && response_listeners_.empty() &&
+           rules_.empty() && !websocket_frame_monitor_->IsEnabled());
+}
+
+const WebRequestRules& WebRequest::GetRules() const {
+  return rules_;
+}
+
+WebSocketFrameMonitor* WebRequest::GetWebSocketFrameMonitor() {
+  return websocket_frame_monitor_.get();
 }
 
 int WebRequest::OnBeforeRequest(extensions::WebRequestInfo* info,
@@ -353,6 +661,103 @@ void WebRequest::OnRequestWillBeDestroyed(extensions::WebRequestInfo* info) {
   callbacks_.erase(info->id);
 }
 
+void WebRequest::SetRules(gin::Arguments* args) {
+  std::vector<v8::Local<v8::Value>> values;
+  if (!args->GetNext(&values)) {
+    args->ThrowTypeError("Must pass an Array of rules");
+    return;
+  }
+
+  std::vector<WebRequestRule> rules(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    std::string error;
+    if (!ParseRule(args->isolate(), values[i], &rules[i], &error)) {
+      args->ThrowTypeError(error);
+      return;
+    }
+  }
+  rules_.SetRules(std::move(rules));
+}
+
+void WebRequest::SetWebSocketFrameListener(gin::Arguments* args) {
+  v8::Local<v8::Value> arg;
+
+  // { urls, direction, minSize, sampleRate }.
+  WebSocketFrameMonitor::Filter filter;
+  gin::Dictionary dict(args->isolate());
+  if (args->GetNext(&arg) && !arg->IsFunction() &&
+      gin::ConvertFromV8(args->isolate(), arg, &dict)) {
+    std::set<std::string> filter_patterns;
+    std::set<URLPattern> patterns;
+    std::string error;
+    dict.Get("urls", &filter_patterns);
+    if (!ParseURLPatterns(filter_patterns, &patterns, &error)) {
+      args->ThrowTypeError(error);
+      return;
+    }
+    filter.url_patterns = URLPatternMatcher(patterns);
+
+    std::string direction;
+    if (dict.Get("direction", &direction)) {
+      if (direction != "send" && direction != "receive") {
+        args->ThrowTypeError("Direction must be 'send' or 'receive'");
+        return;
+      }
+      filter.send = direction == "send";
+      filter.receive = direction == "receive";
+    }
+
+    double min_size = 0;
+    if (dict.Get("minSize", &min_size))
+      filter.min_size = static_cast<uint64_t>(std::max(min_size, 0.0));
+    if (dict.Get("sampleRate", &filter.sample_rate) &&
+        !(filter.sample_rate > 0 && filter.sample_rate <= 1)) {
+      args->ThrowTypeError("Sample rate must be in (0, 1]");
+      return;
+    }
+    args->GetNext(&arg);
+  }
+
+  // Function or null.
+  ResponseListener listener;
+  if (arg.IsEmpty() ||
+      !(gin::ConvertFromV8(args->isolate(), arg, &listener) || arg->IsNull())) {
+    args->ThrowTypeError("Must pass null or a Function");
+    return;
+  }
+
+  if (listener.is_null()) {
+    websocket_frame_monitor_->ClearHandler();
+  } else {
+    websocket_frame_monitor_->SetHandler(
+        std::move(filter),
+        base::BindRepeating(&WebRequest::OnWebSocketFrame,
+                            base::Unretained(this), std::move(listener)));
+  }
+}
+
+void WebRequest::SetWebSocketStatsEnabled(bool enabled) {
+  websocket_frame_monitor_->SetStatsEnabled(enabled);
+}
+
+v8::Local<v8::Value> WebRequest::GetWebSocketStats(v8::Isolate* isolate) {
+  const base::TimeTicks now = base::TimeTicks::Now();
+  std::vector<v8::Local<v8::Value>> result;
+  for (const auto& stats : websocket_frame_monitor_->GetStats()) {
+    gin::Dictionary dict = gin::Dictionary::CreateEmpty(isolate);
+    dict.Set("id", stats.connection_id);
+    dict.Set("url", stats.url);
+    dict.Set("framesSent", stats.frames_sent);
+    dict.Set("framesReceived", stats.frames_received);
+    dict.Set("bytesSent", stats.bytes_sent);
+    dict.Set("bytesReceived", stats.bytes_received);
+    dict.Set("messagesFiltered", stats.messages_filtered);
+    dict.Set("duration", (now - stats.start_time).InMillisecondsF());
+    result.push_back(gin::ConvertToV8(isolate, dict));
+  }
+  return gin::ConvertToV8(isolate, result);
+}
+
 template <WebRequest::SimpleEvent event>
 void WebRequest::SetSimpleListener(gin::Arguments* args) {
   SetListener<SimpleListener>(event, &simple_listeners_, args);
@@ -369,16 +774,20 @@ void WebRequest::SetListener(Event event,
                              gin::Arguments* args) {
   v8::Local<v8::Value> arg;
 
-  // { urls }.
+  // { urls, fields }.
   std::set<std::string> filter_patterns;
+  std::set<std::string> fields;
   gin::Dictionary dict(args->isolate());
   if (args->GetNext(&arg) && !arg->IsFunction()) {
     // Note that gin treats Function as Dictionary when doing convertions, so we
     // have to explicitly check if the argument is Function before trying to
     // convert it to Dictionary.
     if (gin::ConvertFromV8(args->isolate(), arg, &dict)) {
-      if (!dict.Get("urls", &filter_patterns)) {
-        args->ThrowTypeError("Parameter 'filter' must have property 'urls'.");
+      bool has_urls = dict.Get("urls", &filter_patterns);
+      bool has_fields = dict.Get("fields", &fields);
+      if (!has_urls && !has_fields) {
+        args->ThrowTypeError(
+            "Parameter 'filter' must have property 'urls', 'fields' or both.");
         return;
       }
       args->GetNext(&arg);
@@ -386,17 +795,10 @@ void WebRequest::SetListener(Event event,
   }
 
   std::set<URLPattern> patterns;
-  for (const std::string& filter_pattern : filter_patterns) {
-    URLPattern pattern(URLPattern::SCHEME_ALL);
-    const URLPattern::ParseResult result = pattern.Parse(filter_pattern);
-    if (result == URLPattern::ParseResult::kSuccess) {
-      patterns.insert(pattern);
-    } else {
-      const char* error_type = URLPattern::GetParseResultString(result);
-      args->ThrowTypeError("Invalid url pattern " + filter_pattern + ": " +
-                           error_type);
-      return;
-    }
+  std::string error;
+  if (!ParseURLPatterns(filter_patterns, &patterns, &error)) {
+    args->ThrowTypeError(error);
+    return;
   }
 
   // Function or null.
@@ -410,7 +812,8 @@ void WebRequest::SetListener(Event event,
   if (listener.is_null())
     listeners->erase(event);
   else
-    (*listeners)[event] = {std::move(patterns), std::move(listener)};
+    (*listeners)[event] = {std::move(patterns), std::move(fields),
+                           std::move(listener)};
 }
 
 template <typename... Args>
@@ -427,9 +830,9 @@ void WebRequest::HandleSimpleEvent(SimpleEvent event,
 
   v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
   v8::HandleScope handle_scope(isolate);
-  gin::Dictionary details(isolate, v8::Object::New(isolate));
+  Details details(isolate, info.fields);
   FillDetails(&details, request_info, args...);
-  info.listener.Run(gin::ConvertToV8(isolate, details));
+  info.listener.Run(details.GetHandle());
 }
 
 template <typename Out, typename... Args>
@@ -450,14 +853,21 @@ int WebRequest::HandleResponseEvent(ResponseEvent event,
 
   v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
   v8::HandleScope handle_scope(isolate);
-  gin::Dictionary details(isolate, v8::Object::New(isolate));
+  Details details(isolate, info.fields);
   FillDetails(&details, request_info, args...);
 
   ResponseCallback response =
       base::BindOnce(&WebRequest::OnListenerResult<Out>, base::Unretained(this),
                      request_info->id, out);
-  info.listener.Run(gin::ConvertToV8(isolate, details), std::move(response));
-  return net::ERR_IO_PENDING;
+  RunningListener running_listener = {request_info->id};
+  RunningListener* outer_listener =
+      std::exchange(running_listener_, &running_listener);
+  info.listener.Run(details.GetHandle(), std::move(response));
+  running_listener_ = outer_listener;
+
+  // Listeners that answer right away, like most header injecting ones, let the
+  // request continue without waiting for another UI thread task.
+  return running_listener.result.value_or(net::ERR_IO_PENDING);
 }
 
 template <typename T>
@@ -481,6 +891,12 @@ void WebRequest::OnListenerResult(uint64_t id,
       ReadFromResponse(isolate, &dict, out);
   }
 
+  if (running_listener_ && running_listener_->id == id) {
+    running_listener_->result = result;
+    callbacks_.erase(iter);
+    return;
+  }
+
   // The ProxyingURLLoaderFactory expects the callback to be executed
   // asynchronously, because it used to work on IO thread before NetworkService.
   base::SequencedTaskRunnerHandle::Get()->PostTask(
@@ -488,6 +904,40 @@ void WebRequest::OnListenerResult(uint64_t id,
   callbacks_.erase(iter);
 }
 
+void WebRequest::OnWebSocketFrame(
+    const ResponseListener& listener,
+    WebSocketFrameMonitor::Frame frame,
+    WebSocketFrameMonitor::ResultCallback callback) {
+  v8::Isolate* isolate = JavascriptEnvironment::GetIsolate();
+  v8::HandleScope handle_scope(isolate);
+  const bool is_text =
+      frame.type == network::mojom::WebSocketMessageType::TEXT;
+
+  gin::Dictionary details = gin::Dictionary::CreateEmpty(isolate);
+  details.Set("id", frame.connection_id);
+  details.Set("url", frame.url);
+  details.Set("direction",
+              frame.direction == WebSocketFrameMonitor::Direction::kSend
+                  ? "send"
+                  : "receive");
+  details.Set("type", is_text ? "text" : "binary");
+  auto data = base::RefCountedString::TakeString(&frame.data);
+  if (is_text)
+    details.Set("data", data->data());
+  else
+    details.Set("data", WebSocketMessageToBuffer(isolate, data));
+  auto* web_contents = content::WebContents::FromRenderFrameHost(
+      content::RenderFrameHost::FromID(frame.process_id, frame.frame_id));
+  auto* api_web_contents = WebContents::From(web_contents);
+  if (api_web_contents)
+    details.Set("webContentsId", api_web_contents->ID());
+
+  ResponseCallback response = base::BindOnce(
+      &OnWebSocketFrameResult, std::make_unique<PendingWebSocketMessage>(
+                                   std::move(data), std::move(callback)));
+  listener.Run(gin::ConvertToV8(isolate, details), std::move(response));
+}
+
 // static
 gin::Handle<WebRequest> WebRequest::FromOrCreate(
     v8::Isolate* isolate,
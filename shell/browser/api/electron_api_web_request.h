@@ -7,12 +7,15 @@
 
 #include <map>
 #include <set>
+#include <string>
 
+#include "base/optional.h"
 #include "base/values.h"
 #include "extensions/common/url_pattern.h"
 #include "gin/arguments.h"
 #include "gin/handle.h"
 #include "gin/wrappable.h"
+#include "shell/browser/net/url_pattern_matcher.h"
 #include "shell/browser/net/web_request_api_interface.h"
 
 namespace content {
@@ -51,6 +54,8 @@ class WebRequest : public gin::Wrappable<WebRequest>, public WebRequestAPI {
 
   // WebRequestAPI:
   bool HasListener() const override;
+  const WebRequestRules& GetRules() const override;
+  WebSocketFrameMonitor* GetWebSocketFrameMonitor() override;
   int OnBeforeRequest(extensions::WebRequestInfo* info,
                       const network::ResourceRequest& request,
                       net::CompletionOnceCallback callback,
@@ -108,6 +113,11 @@ class WebRequest : public gin::Wrappable<WebRequest>, public WebRequestAPI {
   void SetSimpleListener(gin::Arguments* args);
   template <ResponseEvent event>
   void SetResponseListener(gin::Arguments* args);
+  void SetRules(gin::Arguments* args);
+  void SetWebSocketFrameListener(gin::Arguments* args);
+  void SetWebSocketStatsEnabled(bool enabled);
+  v8::Local<v8::Value> GetWebSocketStats(v8::Isolate* isolate);
+
   template <typename Listener, typename Listeners, typename Event>
   void SetListener(Event event, Listeners* listeners, gin::Arguments* args);
 
@@ -125,20 +135,32 @@ class WebRequest : public gin::Wrappable<WebRequest>, public WebRequestAPI {
   template <typename T>
   void OnListenerResult(uint64_t id, T out, v8::Local<v8::Value> response);
 
+  void OnWebSocketFrame(const ResponseListener& listener,
+                        WebSocketFrameMonitor::Frame frame,
+                        WebSocketFrameMonitor::ResultCallback callback);
+
   struct SimpleListenerInfo {
-    std::set<URLPattern> url_patterns;
+    URLPatternMatcher url_patterns;
+    // The fields of the details object, empty for all fields.
+    std::set<std::string> fields;
     SimpleListener listener;
 
-    SimpleListenerInfo(std::set<URLPattern>, SimpleListener);
+    SimpleListenerInfo(std::set<URLPattern>,
+                       std::set<std::string>,
+                       SimpleListener);
     SimpleListenerInfo();
     ~SimpleListenerInfo();
   };
 
   struct ResponseListenerInfo {
-    std::set<URLPattern> url_patterns;
+    URLPatternMatcher url_patterns;
+    // The fields of the details object, empty for all fields.
+    std::set<std::string> fields;
     ResponseListener listener;
 
-    ResponseListenerInfo(std::set<URLPattern>, ResponseListener);
+    ResponseListenerInfo(std::set<URLPattern>,
+                         std::set<std::string>,
+                         ResponseListener);
     ResponseListenerInfo();
     ~ResponseListenerInfo();
   };
@@ -147,6 +169,20 @@ class WebRequest : public gin::Wrappable<WebRequest>, public WebRequestAPI {
   std::map<ResponseEvent, ResponseListenerInfo> response_listeners_;
   std::map<uint64_t, net::CompletionOnceCallback> callbacks_;
 
+  // The response listener being run, so that a listener calling its callback
+  // synchronously hands the result back to HandleResponseEvent().
+  struct RunningListener {
+    uint64_t id;
+    base::Optional<int> result;
+  };
+  RunningListener* running_listener_ = nullptr;
+
+  // Declarative rules, applied natively without calling into JavaScript.
+  WebRequestRules rules_;
+
+  // Shared with the interceptors of the WebSocket connections.
+  scoped_refptr<WebSocketFrameMonitor> websocket_frame_monitor_;
+
   // Weak-ref, it manages us.
   content::BrowserContext* browser_context_;
 };
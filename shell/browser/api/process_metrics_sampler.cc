@@ -0,0 +1,232 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/api/process_metrics_sampler.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/process/process_metrics.h"
+#include "base/system/sys_info.h"
+#include "base/task/thread_pool.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/timer/timer.h"
+#include "content/public/common/process_type.h"
+
+#if defined(OS_LINUX)
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#endif
+
+#if defined(OS_MAC)
+#include "content/public/browser/browser_child_process_host.h"
+#endif
+
+namespace electron {
+
+namespace {
+
+// In bytes.
+size_t GetWorkingSetSize(const ProcessMetric& process_metric) {
+#if defined(OS_LINUX)
+  // base::ProcessMetrics does not report the resident set size on Linux.
+  std::string statm;
+  if (!base::ReadFileToString(
+          base::FilePath("/proc")
+              .Append(base::NumberToString(process_metric.process.Pid()))
+              .Append("statm"),
+          &statm))
+    return 0;
+  std::vector<base::StringPiece> fields = base::SplitStringPiece(
+      statm, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  size_t resident_pages = 0;
+  if (fields.size() < 2 || !base::StringToSizeT(fields[1], &resident_pages))
+    return 0;
+  return resident_pages * base::GetPageSize();
+#else
+  return process_metric.GetMemoryInfo().working_set_size;
+#endif
+}
+
+}  // namespace
+
+// Owns a copy of the metrics of each process, since the CPU usage is measured
+// since the previous call. Lives on a pool sequence.
+class ProcessMetricsSampler::Core {
+ public:
+  using SamplesCallback = base::RepeatingCallback<void(
+      std::vector<std::pair<base::ProcessId, Sample>>)>;
+
+  Core(scoped_refptr<base::SequencedTaskRunner> reply_task_runner,
+       SamplesCallback callback)
+      : reply_task_runner_(std::move(reply_task_runner)),
+        callback_(std::move(callback)),
+        processor_count_(base::SysInfo::NumberOfProcessors()) {}
+
+  void Start(base::TimeDelta interval) {
+    timer_.Start(
+        FROM_HERE, interval,
+        base::BindRepeating(&Core::TakeSamples, base::Unretained(this)));
+  }
+
+  void AddProcess(base::ProcessId pid,
+                  std::unique_ptr<ProcessMetric> process_metric) {
+    // The first CPU usage is only measured from now on.
+    process_metric->metrics->GetPlatformIndependentCPUUsage();
+    processes_[pid] = std::move(process_metric);
+  }
+
+  void RemoveProcess(base::ProcessId pid) { processes_.erase(pid); }
+
+ private:
+  void TakeSamples() {
+    std::vector<std::pair<base::ProcessId, Sample>> samples;
+    samples.reserve(processes_.size());
+    base::Time now = base::Time::Now();
+    for (const auto& it : processes_) {
+      const ProcessMetric& process_metric = *it.second;
+      Sample sample;
+      sample.time = now;
+      sample.cpu_usage =
+          process_metric.metrics->GetPlatformIndependentCPUUsage() /
+          processor_count_;
+      sample.working_set_size =
+          static_cast<uint32_t>(GetWorkingSetSize(process_metric) >> 10);
+      base::IoCounters io_counters;
+      if (process_metric.metrics->GetIOCounters(&io_counters)) {
+        sample.io_read_bytes = io_counters.ReadTransferCount;
+        sample.io_write_bytes = io_counters.WriteTransferCount;
+      }
+      samples.emplace_back(it.first, sample);
+    }
+    reply_task_runner_->PostTask(FROM_HERE,
+                                 base::BindOnce(callback_, std::move(samples)));
+  }
+
+  scoped_refptr<base::SequencedTaskRunner> reply_task_runner_;
+  SamplesCallback callback_;
+  int processor_count_;
+  std::map<base::ProcessId, std::unique_ptr<ProcessMetric>> processes_;
+  base::RepeatingTimer timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(Core);
+};
+
+ProcessMetricsSampler::ProcessHistory::ProcessHistory() = default;
+ProcessMetricsSampler::ProcessHistory::ProcessHistory(ProcessHistory&&) =
+    default;
+ProcessMetricsSampler::ProcessHistory&
+ProcessMetricsSampler::ProcessHistory::operator=(ProcessHistory&&) = default;
+ProcessMetricsSampler::ProcessHistory::~ProcessHistory() = default;
+
+ProcessMetricsSampler::ProcessMetricsSampler(base::TimeDelta interval,
+                                             size_t max_samples,
+                                             std::vector<Threshold> thresholds,
+                                             ThresholdCallback callback)
+    : max_samples_(std::max<size_t>(max_samples, 1)),
+      thresholds_(std::move(thresholds)),
+      callback_(std::move(callback)),
+      task_runner_(base::ThreadPool::CreateSequencedTaskRunner(
+          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+           base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN})),
+      core_(nullptr, base::OnTaskRunnerDeleter(nullptr)) {
+  core_ = std::unique_ptr<Core, base::OnTaskRunnerDeleter>(
+      new Core(base::SequencedTaskRunnerHandle::Get(),
+               base::BindRepeating(&ProcessMetricsSampler::OnSamples,
+                                   weak_factory_.GetWeakPtr())),
+      base::OnTaskRunnerDeleter(task_runner_));
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&Core::Start, base::Unretained(core_.get()), interval));
+}
+
+ProcessMetricsSampler::~ProcessMetricsSampler() = default;
+
+void ProcessMetricsSampler::AddProcess(base::ProcessId pid,
+                                       const ProcessMetric& process_metric) {
+  base::ProcessHandle handle = process_metric.process.Handle();
+  std::unique_ptr<base::ProcessMetrics> metrics;
+  if (pid == base::GetCurrentProcId()) {
+    metrics = base::ProcessMetrics::CreateCurrentProcessMetrics();
+  } else {
+#if defined(OS_MAC)
+    metrics = base::ProcessMetrics::CreateProcessMetrics(
+        handle, content::BrowserChildProcessHost::GetPortProvider());
+#else
+    metrics = base::ProcessMetrics::CreateProcessMetrics(handle);
+#endif
+  }
+
+  ProcessHistory& history = histories_[pid];
+  history.type = process_metric.type;
+  history.samples.clear();
+  history.exceeded.assign(thresholds_.size(), false);
+
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&Core::AddProcess, base::Unretained(core_.get()), pid,
+                     std::make_unique<ProcessMetric>(
+                         process_metric.type, handle, std::move(metrics),
+                         process_metric.service_name, process_metric.name)));
+}
+
+void ProcessMetricsSampler::RemoveProcess(base::ProcessId pid) {
+  histories_.erase(pid);
+  task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&Core::RemoveProcess,
+                                base::Unretained(core_.get()), pid));
+}
+
+void ProcessMetricsSampler::OnSamples(
+    std::vector<std::pair<base::ProcessId, Sample>> samples) {
+  struct Crossing {
+    base::ProcessId pid;
+    int type;
+    Threshold threshold;
+    double value;
+  };
+  std::vector<Crossing> crossings;
+
+  for (const auto& it : samples) {
+    auto history = histories_.find(it.first);
+    // The process is gone.
+    if (history == histories_.end())
+      continue;
+
+    const Sample& sample = it.second;
+    history->second.samples.push_back(sample);
+    while (history->second.samples.size() > max_samples_)
+      history->second.samples.pop_front();
+
+    for (size_t i = 0; i < thresholds_.size(); ++i) {
+      const Threshold& threshold = thresholds_[i];
+      if (!threshold.process_type.empty() &&
+          threshold.process_type !=
+              content::GetProcessTypeNameInEnglish(history->second.type))
+        continue;
+      double value = threshold.metric == Metric::kCPUUsage
+                         ? sample.cpu_usage
+                         : sample.working_set_size;
+      bool exceeded = value > threshold.value;
+      if (exceeded && !history->second.exceeded[i])
+        crossings.push_back({it.first, history->second.type, threshold, value});
+      history->second.exceeded[i] = exceeded;
+    }
+  }
+
+  // The callback can destroy |this|.
+  base::WeakPtr<ProcessMetricsSampler> weak_this = weak_factory_.GetWeakPtr();
+  for (const Crossing& crossing : crossings) {
+    callback_.Run(crossing.pid, crossing.type, crossing.threshold,
+                  crossing.value);
+    if (!weak_this)
+      return;
+  }
+}
+
+}  // namespace electron
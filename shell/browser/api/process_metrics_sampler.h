@@ -0,0 +1,102 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_API_PROCESS_METRICS_SAMPLER_H_
+#define SHELL_BROWSER_API_PROCESS_METRICS_SAMPLER_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/circular_deque.h"
+#include "base/memory/weak_ptr.h"
+#include "base/process/process_handle.h"
+#include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "shell/browser/api/process_metric.h"
+
+namespace electron {
+
+// Samples the CPU, memory and I/O usage of the app's processes on a pool
+// thread at a fixed interval, keeping the recent samples of each process on
+// the UI thread so they can be read without touching the processes.
+class ProcessMetricsSampler {
+ public:
+  struct Sample {
+    base::Time time;
+    // Of all the processors, like app.getAppMetrics().
+    float cpu_usage = 0;
+    // In KB.
+    uint32_t working_set_size = 0;
+    // Since the process was launched, zero when not supported.
+    uint64_t io_read_bytes = 0;
+    uint64_t io_write_bytes = 0;
+  };
+
+  struct ProcessHistory {
+    ProcessHistory();
+    ProcessHistory(ProcessHistory&&);
+    ProcessHistory& operator=(ProcessHistory&&);
+    ~ProcessHistory();
+
+    int type = 0;
+    base::circular_deque<Sample> samples;
+    // Whether each threshold is currently exceeded.
+    std::vector<bool> exceeded;
+  };
+
+  enum class Metric {
+    kCPUUsage,
+    kWorkingSetSize,
+  };
+
+  struct Threshold {
+    // The name of the process type, or empty for all processes.
+    std::string process_type;
+    Metric metric = Metric::kWorkingSetSize;
+    double value = 0;
+  };
+
+  // Run when a metric of a process rises above a threshold, it runs again
+  // only after the metric has fallen below the threshold.
+  using ThresholdCallback = base::RepeatingCallback<
+      void(base::ProcessId pid, int type, const Threshold&, double value)>;
+
+  ProcessMetricsSampler(base::TimeDelta interval,
+                        size_t max_samples,
+                        std::vector<Threshold> thresholds,
+                        ThresholdCallback callback);
+  ~ProcessMetricsSampler();
+
+  void AddProcess(base::ProcessId pid, const ProcessMetric& process_metric);
+  void RemoveProcess(base::ProcessId pid);
+
+  const std::unordered_map<base::ProcessId, ProcessHistory>& histories() const {
+    return histories_;
+  }
+
+ private:
+  class Core;
+
+  void OnSamples(std::vector<std::pair<base::ProcessId, Sample>> samples);
+
+  size_t max_samples_;
+  std::vector<Threshold> thresholds_;
+  ThresholdCallback callback_;
+  std::unordered_map<base::ProcessId, ProcessHistory> histories_;
+
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  std::unique_ptr<Core, base::OnTaskRunnerDeleter> core_;
+
+  base::WeakPtrFactory<ProcessMetricsSampler> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessMetricsSampler);
+};
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_API_PROCESS_METRICS_SAMPLER_H_
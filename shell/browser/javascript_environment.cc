@@ -17,6 +17,7 @@
 #include "content/public/common/content_switches.h"
 #include "gin/array_buffer.h"
 #include "gin/v8_initializer.h"
+#include "shell/browser/long_task_monitor.h"
 #include "shell/browser/microtasks_runner.h"
 #include "shell/common/gin_helper/cleaned_up_at_exit.h"
 #include "shell/common/node_includes.h"
@@ -269,7 +270,9 @@ v8::Isolate* JavascriptEnvironment::GetIsolate() {
 
 void JavascriptEnvironment::OnMessageLoopCreated() {
   DCHECK(!microtasks_runner_);
-  microtasks_runner_ = std::make_unique<MicrotasksRunner>(isolate());
+  long_task_monitor_ = std::make_unique<LongTaskMonitor>();
+  microtasks_runner_ =
+      std::make_unique<MicrotasksRunner>(isolate(), long_task_monitor_.get());
   base::CurrentThread::Get()->AddTaskObserver(microtasks_runner_.get());
 }
 
@@ -18,6 +18,7 @@ class MultiIsolatePlatform;
 
 namespace electron {
 
+class LongTaskMonitor;
 class MicrotasksRunner;
 // Manage the V8 isolate and context automatically.
 class JavascriptEnvironment {
@@ -46,6 +47,7 @@ class JavascriptEnvironment {
   v8::Locker locker_;
   v8::Global<v8::Context> context_;
 
+  std::unique_ptr<LongTaskMonitor> long_task_monitor_;
   std::unique_ptr<MicrotasksRunner> microtasks_runner_;
 
   DISALLOW_COPY_AND_ASSIGN(JavascriptEnvironment);
@@ -0,0 +1,147 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/long_task_monitor.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/pending_task.h"
+#include "base/threading/thread_task_runner_handle.h"
+
+namespace electron {
+
+namespace {
+
+LongTaskMonitor* g_long_task_monitor = nullptr;
+
+LongTaskMonitor::Source GetTaskSource(const base::PendingTask& pending_task) {
+  const base::Location& location = pending_task.posted_from;
+  // See NodeBindings::WakeupMainThread().
+  if (location.function_name() &&
+      base::StringPiece(location.function_name()) == "WakeupMainThread")
+    return LongTaskMonitor::Source::kUv;
+  // Chromium restores the IPC hash of the task before the observers run, so
+  // mojo messages are recognized by the watcher that posted them.
+  if (location.file_name() &&
+      base::StringPiece(location.file_name()).find("mojo/") !=
+          base::StringPiece::npos)
+    return LongTaskMonitor::Source::kMojo;
+  if (!pending_task.delayed_run_time.is_null())
+    return LongTaskMonitor::Source::kTimer;
+  return LongTaskMonitor::Source::kTask;
+}
+
+size_t GetBucket(base::TimeDelta duration) {
+  double milliseconds = duration.InMillisecondsF();
+  size_t bucket = 0;
+  while (bucket < LongTaskMonitor::kBucketBoundaries.size() &&
+         milliseconds >= LongTaskMonitor::kBucketBoundaries[bucket])
+    ++bucket;
+  return bucket;
+}
+
+}  // namespace
+
+constexpr size_t LongTaskMonitor::kSourceCount;
+constexpr std::array<int, 12> LongTaskMonitor::kBucketBoundaries;
+
+LongTaskMonitor::LongTaskMonitor() {
+  DCHECK(!g_long_task_monitor);
+  g_long_task_monitor = this;
+}
+
+LongTaskMonitor::~LongTaskMonitor() {
+  g_long_task_monitor = nullptr;
+}
+
+// static
+LongTaskMonitor* LongTaskMonitor::Get() {
+  return g_long_task_monitor;
+}
+
+// static
+void LongTaskMonitor::AnnotateCurrentTask(Source source,
+                                          base::StringPiece detail) {
+  LongTaskMonitor* self = g_long_task_monitor;
+  if (!self || !self->running_ || self->running_tasks_.empty())
+    return;
+  // The outermost annotation wins, the task is what it was dispatched for.
+  RunningTask& task = self->running_tasks_.back();
+  if (task.annotated)
+    return;
+  task.annotated = true;
+  task.source = source;
+  task.detail = detail.as_string();
+}
+
+void LongTaskMonitor::Start(base::TimeDelta threshold,
+                            LongTaskCallback callback) {
+  running_ = true;
+  threshold_ = threshold;
+  callback_ = std::move(callback);
+  // The task that started the monitor is not measured.
+  running_tasks_.clear();
+  stats_ = {};
+}
+
+void LongTaskMonitor::Stop() {
+  running_ = false;
+  callback_.Reset();
+  running_tasks_.clear();
+  weak_factory_.InvalidateWeakPtrs();
+}
+
+void LongTaskMonitor::WillProcessTask(const base::PendingTask& pending_task) {
+  if (!running_)
+    return;
+  RunningTask task;
+  task.start_time = base::TimeTicks::Now();
+  running_tasks_.push_back(std::move(task));
+}
+
+void LongTaskMonitor::DidProcessTask(const base::PendingTask& pending_task) {
+  if (!running_ || running_tasks_.empty())
+    return;
+
+  RunningTask task = std::move(running_tasks_.back());
+  running_tasks_.pop_back();
+  base::TimeDelta duration = base::TimeTicks::Now() - task.start_time;
+  if (!task.annotated)
+    task.source = GetTaskSource(pending_task);
+
+  Stats& stats = stats_[static_cast<size_t>(task.source)];
+  stats.count++;
+  stats.total_time += duration;
+  stats.max_time = std::max(stats.max_time, duration);
+  stats.histogram[GetBucket(duration)]++;
+
+  if (duration < threshold_ || !task.reported)
+    return;
+  stats.long_task_count++;
+
+  LongTask long_task;
+  long_task.source = task.source;
+  long_task.start_time = task.start_time;
+  long_task.duration = duration;
+  if (task.annotated) {
+    long_task.detail = std::move(task.detail);
+  } else if (task.source != Source::kUv) {
+    long_task.detail = pending_task.posted_from.ToString();
+  }
+  // Not run from the observer, so JS does not run outside of a task.
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(&LongTaskMonitor::NotifyLongTask,
+                                weak_factory_.GetWeakPtr(), long_task));
+}
+
+void LongTaskMonitor::NotifyLongTask(const LongTask& long_task) {
+  if (!running_tasks_.empty())
+    running_tasks_.back().reported = false;
+  if (callback_)
+    callback_.Run(long_task);
+}
+
+}  // namespace electron
@@ -0,0 +1,114 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_LONG_TASK_MONITOR_H_
+#define SHELL_BROWSER_LONG_TASK_MONITOR_H_
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+
+namespace base {
+struct PendingTask;
+}
+
+namespace electron {
+
+// Measures how long the tasks of the browser UI thread take, including the
+// microtask checkpoint that follows them, and attributes them to where they
+// came from. Fed by the MicrotasksRunner, does nothing until started.
+class LongTaskMonitor {
+ public:
+  enum class Source {
+    // Any other task posted to the UI thread.
+    kTask,
+    // Node.js callbacks run from the libuv loop.
+    kUv,
+    // ipcMain and ipcMain.handle() messages.
+    kIPC,
+    // Messages of other mojo interfaces.
+    kMojo,
+    // Delayed tasks.
+    kTimer,
+  };
+  static constexpr size_t kSourceCount = 5;
+
+  // In milliseconds, the last bucket has no upper bound.
+  static constexpr std::array<int, 12> kBucketBoundaries = {
+      1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048};
+
+  struct LongTask {
+    Source source = Source::kTask;
+    // The IPC channel, or where the task was posted from.
+    std::string detail;
+    base::TimeTicks start_time;
+    base::TimeDelta duration;
+  };
+
+  struct Stats {
+    size_t count = 0;
+    size_t long_task_count = 0;
+    base::TimeDelta total_time;
+    base::TimeDelta max_time;
+    std::array<size_t, kBucketBoundaries.size() + 1> histogram = {};
+  };
+
+  using LongTaskCallback = base::RepeatingCallback<void(const LongTask&)>;
+
+  LongTaskMonitor();
+  ~LongTaskMonitor();
+
+  // Returns nullptr before the UI thread is running.
+  static LongTaskMonitor* Get();
+
+  // Lets code run by the current task give a better attribution than the
+  // task itself, like the channel of an IPC message.
+  static void AnnotateCurrentTask(Source source, base::StringPiece detail);
+
+  // Resets the stats. |callback| is run asynchronously for each task that
+  // takes at least |threshold|.
+  void Start(base::TimeDelta threshold, LongTaskCallback callback);
+  void Stop();
+  bool IsRunning() const { return running_; }
+
+  // Indexed by Source.
+  const std::array<Stats, kSourceCount>& stats() const { return stats_; }
+
+  void WillProcessTask(const base::PendingTask& pending_task);
+  void DidProcessTask(const base::PendingTask& pending_task);
+
+ private:
+  struct RunningTask {
+    base::TimeTicks start_time;
+    bool annotated = false;
+    // False for the tasks reporting long tasks, so a slow listener does not
+    // keep reporting itself.
+    bool reported = true;
+    Source source = Source::kTask;
+    std::string detail;
+  };
+
+  void NotifyLongTask(const LongTask& long_task);
+
+  bool running_ = false;
+  base::TimeDelta threshold_;
+  LongTaskCallback callback_;
+  // Tasks run by nested run loops are stacked on the task running them.
+  std::vector<RunningTask> running_tasks_;
+  std::array<Stats, kSourceCount> stats_;
+
+  base::WeakPtrFactory<LongTaskMonitor> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(LongTaskMonitor);
+};
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_LONG_TASK_MONITOR_H_
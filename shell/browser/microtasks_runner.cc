@@ -7,15 +7,20 @@
 
 #include "shell/browser/electron_browser_main_parts.h"
 #include "shell/browser/javascript_environment.h"
+#include "shell/browser/long_task_monitor.h"
 #include "shell/common/node_includes.h"
 #include "v8/include/v8.h"
 
 namespace electron {
 
-MicrotasksRunner::MicrotasksRunner(v8::Isolate* isolate) : isolate_(isolate) {}
+MicrotasksRunner::MicrotasksRunner(v8::Isolate* isolate,
+                                   LongTaskMonitor* long_task_monitor)
+    : isolate_(isolate), long_task_monitor_(long_task_monitor) {}
 
 void MicrotasksRunner::WillProcessTask(const base::PendingTask& pending_task,
-                                       bool was_blocked_or_low_priority) {}
+                                       bool was_blocked_or_low_priority) {
+  long_task_monitor_->WillProcessTask(pending_task);
+}
 
 void MicrotasksRunner::DidProcessTask(const base::PendingTask& pending_task) {
   v8::Isolate::Scope scope(isolate_);
@@ -35,6 +40,7 @@ void MicrotasksRunner::DidProcessTask(const base::PendingTask& pending_task) {
         node_env->env(), v8::Object::New(isolate_), {0, 0},
         node::InternalCallbackScope::kNoFlags);
   }
+  long_task_monitor_->DidProcessTask(pending_task);
 }
 
 }  // namespace electron
@@ -13,15 +13,19 @@ class Isolate;
 
 namespace electron {
 
+class LongTaskMonitor;
+
 // Microtasks like promise resolution, are run at the end of the current
 // task. This class implements a task observer that runs tells v8 to run them.
 // Microtasks runner implementation is based on the EndOfTaskRunner in blink.
 // Node follows the kExplicit MicrotasksPolicy, and we do the same in browser
 // process. Hence, we need to have this task observer to flush the queued
 // microtasks.
+// It also feeds the LongTaskMonitor, so the checkpoint is counted as part of
+// the task.
 class MicrotasksRunner : public base::TaskObserver {
  public:
-  explicit MicrotasksRunner(v8::Isolate* isolate);
+  MicrotasksRunner(v8::Isolate* isolate, LongTaskMonitor* long_task_monitor);
 
   // base::TaskObserver
   void WillProcessTask(const base::PendingTask& pending_task,
@@ -30,6 +34,7 @@ class MicrotasksRunner : public base::TaskObserver {
 
  private:
   v8::Isolate* isolate_;
+  LongTaskMonitor* long_task_monitor_;
 };
 
 }  // namespace electron
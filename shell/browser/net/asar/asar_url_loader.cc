@@ -4,11 +4,18 @@
 
 #include "shell/browser/net/asar/asar_url_loader.h"
 
+#include <algorithm>
+#include <cinttypes>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "base/containers/circular_deque.h"
+#include "base/files/file.h"
+#include "base/guid.h"
+#include "base/numerics/ranges.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
@@ -17,10 +24,13 @@
 #include "mojo/public/cpp/bindings/remote.h"
 #include "mojo/public/cpp/system/data_pipe_producer.h"
 #include "mojo/public/cpp/system/file_data_source.h"
+#include "mojo/public/cpp/system/string_data_source.h"
 #include "net/base/filename_util.h"
 #include "net/base/mime_sniffer.h"
 #include "net/base/mime_util.h"
+#include "net/base/net_errors.h"
 #include "net/http/http_byte_range.h"
+#include "net/http/http_response_headers.h"
 #include "net/http/http_util.h"
 #include "services/network/public/mojom/url_response_head.mojom.h"
 #include "shell/common/asar/archive.h"
@@ -30,45 +40,81 @@ namespace asar {
 
 namespace {
 
-net::Error ConvertMojoResultToNetError(MojoResult result) {
-  switch (result) {
-    case MOJO_RESULT_OK:
-      return net::OK;
-    case MOJO_RESULT_NOT_FOUND:
-      return net::ERR_FILE_NOT_FOUND;
-    case MOJO_RESULT_PERMISSION_DENIED:
-      return net::ERR_ACCESS_DENIED;
-    case MOJO_RESULT_RESOURCE_EXHAUSTED:
-      return net::ERR_INSUFFICIENT_RESOURCES;
-    case MOJO_RESULT_ABORTED:
-      return net::ERR_ABORTED;
-    default:
-      return net::ERR_FAILED;
-  }
-}
-
-constexpr size_t kDefaultFileUrlPipeSize = 65536;
+constexpr uint32_t kDefaultFileUrlPipeSize = 65536;
+constexpr uint32_t kMaxFileUrlPipeSize = 2 * 1024 * 1024;
 
 // Because this makes things simpler.
 static_assert(kDefaultFileUrlPipeSize >= net::kMaxBytesToSniff,
               "Default file data pipe size must be at least as large as a MIME-"
               "type sniffing buffer.");
 
+// Large responses are written in fewer, larger chunks by sizing the pipe
+// after the response, unless the caller has asked for a size.
+uint32_t GetFileUrlPipeSize(uint32_t pipe_size, uint64_t bytes_to_send) {
+  if (pipe_size == 0)
+    pipe_size = base::saturated_cast<uint32_t>(bytes_to_send);
+  return base::ClampToRange(pipe_size, kDefaultFileUrlPipeSize,
+                            kMaxFileUrlPipeSize);
+}
+
+// Bounds the parts of multipart responses, so a request cannot make the
+// response much larger than the file.
+constexpr size_t kMaxRanges = 16;
+
+// Sorts |ranges|, whose bounds have been computed, and merges the ones that
+// overlap or are adjacent. Returns false when more than |kMaxRanges| are left.
+bool MergeRanges(std::vector<net::HttpByteRange>* ranges) {
+  std::sort(ranges->begin(), ranges->end(),
+            [](const net::HttpByteRange& a, const net::HttpByteRange& b) {
+              return a.first_byte_position() < b.first_byte_position();
+            });
+  std::vector<net::HttpByteRange> merged;
+  for (const auto& range : *ranges) {
+    if (!merged.empty() && range.first_byte_position() <=
+                               merged.back().last_byte_position() + 1) {
+      merged.back().set_last_byte_position(std::max(
+          merged.back().last_byte_position(), range.last_byte_position()));
+    } else {
+      merged.push_back(range);
+    }
+  }
+  *ranges = std::move(merged);
+  return ranges->size() <= kMaxRanges;
+}
+
+// Opens |path| if it is a regular file that can be served by the
+// |AsarURLLoader|, directories and shortcuts are left to content's loader.
+base::File OpenPlainFile(const base::FilePath& path) {
+#if defined(OS_WIN)
+  if (path.MatchesExtension(FILE_PATH_LITERAL(".lnk")))
+    return base::File();
+#endif
+  base::File file(path, base::File::FLAG_OPEN | base::File::FLAG_READ);
+  base::File::Info info;
+  if (!file.IsValid() || !file.GetInfo(&info) || info.is_directory)
+    return base::File();
+  return file;
+}
+
 // Modified from the |FileURLLoader| in |file_url_loader_factory.cc|, to serve
 // asar files instead of normal files.
+//
+// Plain files are served by it too when a protocol handler sets the size of
+// the pipe, they then also get the support of multiple ranges.
 class AsarURLLoader : public network::mojom::URLLoader {
  public:
   static void CreateAndStart(
       const network::ResourceRequest& request,
       network::mojom::URLLoaderRequest loader,
       mojo::PendingRemote<network::mojom::URLLoaderClient> client,
-      scoped_refptr<net::HttpResponseHeaders> extra_response_headers) {
+      scoped_refptr<net::HttpResponseHeaders> extra_response_headers,
+      uint32_t pipe_size) {
     // Owns itself. Will live as long as its URLLoader and URLLoaderClientPtr
     // bindings are alive - essentially until either the client gives up or all
     // file data has been sent to it.
     auto* asar_url_loader = new AsarURLLoader;
     asar_url_loader->Start(request, std::move(loader), std::move(client),
-                           std::move(extra_response_headers));
+                           std::move(extra_response_headers), pipe_size);
   }
 
   // network::mojom::URLLoader:
@@ -83,13 +129,21 @@ class AsarURLLoader : public network::mojom::URLLoader {
   void ResumeReadingBodyFromNet() override {}
 
  private:
+  // A part of a multipart/byteranges response.
+  struct Part {
+    std::string header;
+    uint64_t begin;
+    uint64_t end;
+  };
+
   AsarURLLoader() {}
   ~AsarURLLoader() override = default;
 
   void Start(const network::ResourceRequest& request,
              mojo::PendingReceiver<network::mojom::URLLoader> loader,
              mojo::PendingRemote<network::mojom::URLLoaderClient> client,
-             scoped_refptr<net::HttpResponseHeaders> extra_response_headers) {
+             scoped_refptr<net::HttpResponseHeaders> extra_response_headers,
+             uint32_t pipe_size) {
     auto head = network::mojom::URLResponseHead::New();
     head->request_start = base::TimeTicks::Now();
     head->response_start = base::TimeTicks::Now();
@@ -107,12 +161,20 @@ class AsarURLLoader : public network::mojom::URLLoader {
 
     // Determine whether it is an asar file.
     base::FilePath asar_path, relative_path;
-    if (!GetAsarArchivePath(path, &asar_path, &relative_path)) {
-      content::CreateFileURLLoaderBypassingSecurityChecks(
-          request, std::move(loader), std::move(client), nullptr, false,
-          extra_response_headers);
-      MaybeDeleteSelf();
-      return;
+    bool is_asar = GetAsarArchivePath(path, &asar_path, &relative_path);
+    base::File file;
+    if (!is_asar) {
+      // Files outside archives are left to content's loader, unless the
+      // protocol handler asked for a pipe size, which only this loader honors.
+      if (pipe_size != 0)
+        file = OpenPlainFile(path);
+      if (!file.IsValid()) {
+        content::CreateFileURLLoaderBypassingSecurityChecks(
+            request, std::move(loader), std::move(client), nullptr, false,
+            extra_response_headers);
+        MaybeDeleteSelf();
+        return;
+      }
     }
 
     client_.Bind(std::move(client));
@@ -120,85 +182,113 @@ class AsarURLLoader : public network::mojom::URLLoader {
     receiver_.set_disconnect_handler(base::BindOnce(
         &AsarURLLoader::OnConnectionError, base::Unretained(this)));
 
-    // Parse asar archive.
-    std::shared_ptr<Archive> archive = GetOrCreateAsarArchive(asar_path);
-    Archive::FileInfo info;
-    if (!archive || !archive->GetFileInfo(relative_path, &info)) {
-      OnClientComplete(net::ERR_FILE_NOT_FOUND);
-      return;
-    }
-
-    // For unpacked path, read like normal file.
-    base::FilePath real_path;
-    if (info.unpacked) {
-      archive->CopyFileOut(relative_path, &real_path);
-      info.offset = 0;
-    }
-
-    mojo::DataPipe pipe(kDefaultFileUrlPipeSize);
-    if (!pipe.consumer_handle.is_valid()) {
-      OnClientComplete(net::ERR_FAILED);
-      return;
-    }
+    uint64_t file_offset = 0;
+    uint64_t file_size = 0;
+    if (is_asar) {
+      // Parse asar archive.
+      std::shared_ptr<Archive> archive = GetOrCreateAsarArchive(asar_path);
+      Archive::FileInfo info;
+      if (!archive || !archive->GetFileInfo(relative_path, &info)) {
+        OnClientComplete(net::ERR_FILE_NOT_FOUND);
+        return;
+      }
 
-    // Note that while the |Archive| already opens a |base::File|, we still need
-    // to create a new |base::File| here, as it might be accessed by multiple
-    // requests at the same time.
-    base::File file(info.unpacked ? real_path : archive->path(),
-                    base::File::FLAG_OPEN | base::File::FLAG_READ);
-    auto file_data_source =
-        std::make_unique<mojo::FileDataSource>(std::move(file));
-    mojo::DataPipeProducer::DataSource* data_source = file_data_source.get();
+      // For unpacked path, read like normal file.
+      base::FilePath real_path;
+      if (info.unpacked) {
+        archive->CopyFileOut(relative_path, &real_path);
+        info.offset = 0;
+      }
 
-    std::vector<char> initial_read_buffer(net::kMaxBytesToSniff);
-    auto read_result =
-        data_source->Read(info.offset, base::span<char>(initial_read_buffer));
-    if (read_result.result != MOJO_RESULT_OK) {
-      OnClientComplete(ConvertMojoResultToNetError(read_result.result));
-      return;
+      // Note that while the |Archive| already opens a |base::File|, we still
+      // need to create a new |base::File| here, as it might be accessed by
+      // multiple requests at the same time.
+      file = base::File(info.unpacked ? real_path : archive->path(),
+                        base::File::FLAG_OPEN | base::File::FLAG_READ);
+      if (!file.IsValid()) {
+        OnClientComplete(net::FileErrorToNetError(file.error_details()));
+        return;
+      }
+      file_offset = info.offset;
+      file_size = info.size;
+    } else {
+      file_size = base::saturated_cast<uint64_t>(file.GetLength());
     }
 
+    std::vector<net::HttpByteRange> ranges;
     std::string range_header;
-    net::HttpByteRange byte_range;
     if (request.headers.GetHeader(net::HttpRequestHeaders::kRange,
                                   &range_header)) {
-      // Handle a simple Range header for a single range.
-      std::vector<net::HttpByteRange> ranges;
-      bool fail = false;
-      if (net::HttpUtil::ParseRangeHeader(range_header, &ranges) &&
-          ranges.size() == 1) {
-        byte_range = ranges[0];
-        if (!byte_range.ComputeBounds(info.size))
-          fail = true;
-      } else {
-        fail = true;
-      }
-
+      bool fail = !net::HttpUtil::ParseRangeHeader(range_header, &ranges);
+      for (auto& range : ranges)
+        fail = fail || !range.ComputeBounds(file_size);
       if (fail) {
         OnClientComplete(net::ERR_REQUEST_RANGE_NOT_SATISFIABLE);
         return;
       }
+      // A server may ignore the Range header, so the whole file is sent when
+      // there are too many ranges.
+      if (!MergeRanges(&ranges))
+        ranges.clear();
+    }
+
+    // Only read the start of the file when its extension does not tell the
+    // MIME type, the data read is then reused for the response body.
+    std::vector<char> initial_read_buffer;
+    if (!net::GetMimeTypeFromFile(path, &head->mime_type)) {
+      initial_read_buffer.resize(
+          std::min<uint64_t>(net::kMaxBytesToSniff, file_size));
+      int bytes_read =
+          file.Read(file_offset, initial_read_buffer.data(),
+                    static_cast<int>(initial_read_buffer.size()));
+      if (bytes_read < 0) {
+        OnClientComplete(
+            net::FileErrorToNetError(base::File::GetLastFileError()));
+        return;
+      }
+      initial_read_buffer.resize(bytes_read);
+
+      std::string new_type;
+      net::SniffMimeType(
+          base::StringPiece(initial_read_buffer.data(), bytes_read),
+          request.url, head->mime_type,
+          net::ForceSniffFileUrlsForHtml::kDisabled, &new_type);
+      head->mime_type.assign(new_type);
+      head->did_mime_sniff = true;
+    }
+
+    if (ranges.size() > 1) {
+      StartMultipartResponse(std::move(head), std::move(file), file_offset,
+                             file_size, ranges, pipe_size);
+      return;
     }
 
     uint64_t first_byte_to_send = 0;
-    uint64_t total_bytes_to_send = info.size;
+    uint64_t total_bytes_to_send = file_size;
 
-    if (byte_range.IsValid()) {
-      first_byte_to_send = byte_range.first_byte_position();
+    if (!ranges.empty()) {
+      first_byte_to_send = ranges[0].first_byte_position();
       total_bytes_to_send =
-          byte_range.last_byte_position() - first_byte_to_send + 1;
+          ranges[0].last_byte_position() - first_byte_to_send + 1;
     }
 
     total_bytes_written_ = total_bytes_to_send;
 
     head->content_length = base::saturated_cast<int64_t>(total_bytes_to_send);
 
-    if (first_byte_to_send < read_result.bytes_read) {
+    mojo::DataPipe pipe(GetFileUrlPipeSize(pipe_size, total_bytes_to_send));
+    if (!pipe.consumer_handle.is_valid()) {
+      OnClientComplete(net::ERR_FAILED);
+      return;
+    }
+
+    if (first_byte_to_send < initial_read_buffer.size()) {
       // Write any data we read for MIME sniffing, constraining by range where
       // applicable. This will always fit in the pipe (see assertion near
       // |kDefaultFileUrlPipeSize| definition).
       uint32_t write_size = std::min(
-          static_cast<uint32_t>(read_result.bytes_read - first_byte_to_send),
+          static_cast<uint32_t>(initial_read_buffer.size() -
+                                first_byte_to_send),
           static_cast<uint32_t>(total_bytes_to_send));
       const uint32_t expected_write_size = write_size;
       MojoResult result = pipe.producer_handle->WriteData(
@@ -210,19 +300,10 @@ class AsarURLLoader : public network::mojom::URLLoader {
       }
 
       // Discount the bytes we just sent from the total range.
-      first_byte_to_send = read_result.bytes_read;
+      first_byte_to_send = initial_read_buffer.size();
       total_bytes_to_send -= write_size;
     }
 
-    if (!net::GetMimeTypeFromFile(path, &head->mime_type)) {
-      std::string new_type;
-      net::SniffMimeType(
-          base::StringPiece(initial_read_buffer.data(), read_result.bytes_read),
-          request.url, head->mime_type,
-          net::ForceSniffFileUrlsForHtml::kDisabled, &new_type);
-      head->mime_type.assign(new_type);
-      head->did_mime_sniff = true;
-    }
     if (head->headers) {
       head->headers->AddHeader(net::HttpRequestHeaders::kContentType,
                                head->mime_type.c_str());
@@ -241,9 +322,14 @@ class AsarURLLoader : public network::mojom::URLLoader {
     // (i.e., no range request) this Seek is effectively a no-op.
     //
     // Note that in Electron we also need to add file offset.
+    //
+    // The |FileDataSource| reads straight into the memory of the data pipe, so
+    // the file is not copied anywhere else on its way to the consumer.
+    auto file_data_source =
+        std::make_unique<mojo::FileDataSource>(std::move(file));
     file_data_source->SetRange(
-        first_byte_to_send + info.offset,
-        first_byte_to_send + info.offset + total_bytes_to_send);
+        first_byte_to_send + file_offset,
+        first_byte_to_send + file_offset + total_bytes_to_send);
 
     data_producer_ = std::make_unique<mojo::DataPipeProducer>(
         std::move(pipe.producer_handle));
@@ -252,6 +338,100 @@ class AsarURLLoader : public network::mojom::URLLoader {
         base::BindOnce(&AsarURLLoader::OnFileWritten, base::Unretained(this)));
   }
 
+  // Sends a 206 response with one part for each of |ranges|.
+  void StartMultipartResponse(network::mojom::URLResponseHeadPtr head,
+                              base::File file,
+                              uint64_t file_offset,
+                              uint64_t file_size,
+                              const std::vector<net::HttpByteRange>& ranges,
+                              uint32_t pipe_size) {
+    const std::string boundary = base::GenerateGUID();
+    uint64_t body_size = 0;
+    for (const auto& range : ranges) {
+      Part part;
+      part.header = base::StringPrintf(
+          "%s--%s\r\nContent-Type: %s\r\nContent-Range: bytes %" PRId64
+          "-%" PRId64 "/%" PRIu64 "\r\n\r\n",
+          parts_.empty() ? "" : "\r\n", boundary.c_str(),
+          head->mime_type.c_str(), range.first_byte_position(),
+          range.last_byte_position(), file_size);
+      part.begin = file_offset + range.first_byte_position();
+      part.end = file_offset + range.last_byte_position() + 1;
+      body_size += part.header.size() + part.end - part.begin;
+      parts_.push_back(std::move(part));
+    }
+    trailer_ = base::StringPrintf("\r\n--%s--\r\n", boundary.c_str());
+    body_size += trailer_.size();
+    file_ = std::move(file);
+    total_bytes_written_ = body_size;
+
+    auto headers = base::MakeRefCounted<net::HttpResponseHeaders>(
+        net::HttpUtil::AssembleRawHeaders("HTTP/1.1 206 Partial Content"));
+    if (head->headers) {
+      size_t iter = 0;
+      std::string name, value;
+      while (head->headers->EnumerateHeaderLines(&iter, &name, &value))
+        headers->AddHeader(name, value);
+    }
+    headers->SetHeader(net::HttpRequestHeaders::kContentType,
+                       "multipart/byteranges; boundary=" + boundary);
+    head->headers = headers;
+    head->mime_type = "multipart/byteranges";
+    head->content_length = base::saturated_cast<int64_t>(body_size);
+
+    mojo::DataPipe pipe(GetFileUrlPipeSize(pipe_size, body_size));
+    if (!pipe.consumer_handle.is_valid()) {
+      OnClientComplete(net::ERR_FAILED);
+      return;
+    }
+
+    client_->OnReceiveResponse(std::move(head));
+    client_->OnStartLoadingResponseBody(std::move(pipe.consumer_handle));
+
+    data_producer_ = std::make_unique<mojo::DataPipeProducer>(
+        std::move(pipe.producer_handle));
+    WriteNextPart(MOJO_RESULT_OK);
+  }
+
+  // Writes the header of the next part, followed by its data.
+  void WriteNextPart(MojoResult result) {
+    if (result != MOJO_RESULT_OK || parts_.empty()) {
+      if (result == MOJO_RESULT_OK && !trailer_.empty()) {
+        data_producer_->Write(
+            std::make_unique<mojo::StringDataSource>(
+                trailer_, mojo::StringDataSource::AsyncWritingMode::
+                              STRING_STAYS_VALID_UNTIL_COMPLETION),
+            base::BindOnce(&AsarURLLoader::OnFileWritten,
+                           base::Unretained(this)));
+        return;
+      }
+      OnFileWritten(result);
+      return;
+    }
+
+    data_producer_->Write(
+        std::make_unique<mojo::StringDataSource>(
+            parts_.front().header,
+            mojo::StringDataSource::AsyncWritingMode::
+                STRING_STAYS_VALID_UNTIL_COMPLETION),
+        base::BindOnce(&AsarURLLoader::WritePartData, base::Unretained(this)));
+  }
+
+  void WritePartData(MojoResult result) {
+    if (result != MOJO_RESULT_OK) {
+      OnFileWritten(result);
+      return;
+    }
+
+    auto file_data_source =
+        std::make_unique<mojo::FileDataSource>(file_.Duplicate());
+    file_data_source->SetRange(parts_.front().begin, parts_.front().end);
+    parts_.pop_front();
+    data_producer_->Write(
+        std::move(file_data_source),
+        base::BindOnce(&AsarURLLoader::WriteNextPart, base::Unretained(this)));
+  }
+
   void OnConnectionError() {
     receiver_.reset();
     MaybeDeleteSelf();
@@ -287,6 +467,13 @@ class AsarURLLoader : public network::mojom::URLLoader {
   }
 
   std::unique_ptr<mojo::DataPipeProducer> data_producer_;
+
+  // The remaining parts of a multipart/byteranges response, and the file
+  // they are read from.
+  base::circular_deque<Part> parts_;
+  std::string trailer_;
+  base::File file_;
+
   mojo::Receiver<network::mojom::URLLoader> receiver_{this};
   mojo::Remote<network::mojom::URLLoaderClient> client_;
 
@@ -306,14 +493,16 @@ void CreateAsarURLLoader(
     const network::ResourceRequest& request,
     network::mojom::URLLoaderRequest loader,
     mojo::PendingRemote<network::mojom::URLLoaderClient> client,
-    scoped_refptr<net::HttpResponseHeaders> extra_response_headers) {
+    scoped_refptr<net::HttpResponseHeaders> extra_response_headers,
+    uint32_t pipe_size) {
   auto task_runner = base::ThreadPool::CreateSequencedTaskRunner(
       {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
        base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN});
   task_runner->PostTask(
       FROM_HERE,
       base::BindOnce(&AsarURLLoader::CreateAndStart, request, std::move(loader),
-                     std::move(client), std::move(extra_response_headers)));
+                     std::move(client), std::move(extra_response_headers),
+                     pipe_size));
 }
 
 }  // namespace asar
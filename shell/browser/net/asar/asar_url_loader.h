@@ -10,11 +10,18 @@
 
 namespace asar {
 
+// Serves the file of a file: URL, reading it from the asar archive when the
+// path points into one. Other files are left to content's file loader, unless
+// |pipe_size| is set.
+//
+// |pipe_size| is the capacity of the data pipe the file is written to, when 0
+// the pipe is sized after the response.
 void CreateAsarURLLoader(
     const network::ResourceRequest& request,
     network::mojom::URLLoaderRequest loader,
     mojo::PendingRemote<network::mojom::URLLoaderClient> client,
-    scoped_refptr<net::HttpResponseHeaders> extra_response_headers);
+    scoped_refptr<net::HttpResponseHeaders> extra_response_headers,
+    uint32_t pipe_size = 0);
 
 }  // namespace asar
 
@@ -6,19 +6,52 @@
 
 #include "shell/browser/net/cert_verifier_client.h"
 
+#include "base/bind.h"
+#include "base/strings/string_number_conversions.h"
+#include "mojo/public/cpp/bindings/callback_helpers.h"
+#include "net/base/hash_value.h"
+
 namespace electron {
 
+namespace {
+
+std::string GetCacheKey(const std::string& hostname,
+                        const net::X509Certificate& certificate,
+                        int default_error) {
+  net::SHA256HashValue fingerprint =
+      net::X509Certificate::CalculateChainFingerprint256(
+          certificate.cert_buffer(), certificate.intermediate_buffers());
+  return hostname + '\n' +
+         base::HexEncode(fingerprint.data, sizeof(fingerprint.data)) + '\n' +
+         base::NumberToString(default_error);
+}
+
+// How long concurrent verifications wait for the call of the proc made for
+// another one, before calling it themselves.
+constexpr base::TimeDelta kCoalescingTimeout = base::TimeDelta::FromSeconds(10);
+
+}  // namespace
+
 VerifyRequestParams::VerifyRequestParams() = default;
 
 VerifyRequestParams::~VerifyRequestParams() = default;
 
 VerifyRequestParams::VerifyRequestParams(const VerifyRequestParams&) = default;
 
-CertVerifierClient::CertVerifierClient(CertVerifyProc proc)
-    : cert_verify_proc_(proc) {}
+CertVerifierClient::CertVerifierClient(CertVerifyProc proc,
+                                       size_t cache_size,
+                                       base::TimeDelta cache_ttl)
+    : cert_verify_proc_(proc),
+      cache_size_(cache_size),
+      cache_ttl_(cache_ttl),
+      cache_(cache_size) {}
 
 CertVerifierClient::~CertVerifierClient() = default;
 
+CertVerifierClient::PendingVerification::PendingVerification() = default;
+
+CertVerifierClient::PendingVerification::~PendingVerification() = default;
+
 void CertVerifierClient::Verify(
     int default_error,
     const net::CertVerifyResult& default_result,
@@ -27,18 +60,96 @@ void CertVerifierClient::Verify(
     int flags,
     const base::Optional<std::string>& ocsp_response,
     VerifyCallback callback) {
+  auto done = base::BindOnce(
+      [](VerifyCallback callback, const net::CertVerifyResult& result,
+         int err) { std::move(callback).Run(err, result); },
+      std::move(callback), default_result);
+
   VerifyRequestParams params;
   params.hostname = hostname;
   params.default_result = net::ErrorToString(default_error);
   params.error_code = default_error;
   params.certificate = certificate;
   params.validated_certificate = default_result.verified_cert;
-  cert_verify_proc_.Run(
-      params,
-      base::AdaptCallbackForRepeating(base::BindOnce(
-          [](VerifyCallback callback, const net::CertVerifyResult& result,
-             int err) { std::move(callback).Run(err, result); },
-          std::move(callback), default_result)));
+
+  if (cache_size_ == 0) {
+    RunProc(std::string(), 0, params, std::move(done));
+    return;
+  }
+
+  std::string key = GetCacheKey(hostname, *certificate, default_error);
+  auto cached = cache_.Get(key);
+  if (cached != cache_.end()) {
+    if (base::TimeTicks::Now() < cached->second.expiration_time) {
+      std::move(done).Run(cached->second.result);
+      return;
+    }
+    cache_.Erase(cached);
+  }
+
+  auto it = pending_.find(key);
+  if (it != pending_.end()) {
+    it->second->waiters.emplace_back(params, std::move(done));
+    return;
+  }
+
+  auto pending = std::make_unique<PendingVerification>();
+  pending->id = next_pending_id_++;
+  pending->timeout.Start(
+      FROM_HERE, kCoalescingTimeout,
+      base::BindOnce(&CertVerifierClient::StopCoalescing,
+                     base::Unretained(this), key, pending->id));
+  uint64_t pending_id = pending->id;
+  pending_[key] = std::move(pending);
+  RunProc(key, pending_id, params, std::move(done));
+}
+
+void CertVerifierClient::RunProc(const std::string& key,
+                                 uint64_t pending_id,
+                                 const VerifyRequestParams& params,
+                                 DoneCallback done) {
+  auto callback =
+      base::BindOnce(&CertVerifierClient::OnVerifyProcResult,
+                     weak_factory_.GetWeakPtr(), key, pending_id,
+                     std::move(done));
+  // The proc may drop the callback without running it, then the waiters must
+  // not wait for it.
+  if (pending_id) {
+    callback = mojo::WrapCallbackWithDropHandler(
+        std::move(callback),
+        base::BindOnce(&CertVerifierClient::StopCoalescing,
+                       weak_factory_.GetWeakPtr(), key, pending_id));
+  }
+  cert_verify_proc_.Run(params,
+                        base::AdaptCallbackForRepeating(std::move(callback)));
+}
+
+void CertVerifierClient::OnVerifyProcResult(const std::string& key,
+                                            uint64_t pending_id,
+                                            DoneCallback done,
+                                            int result) {
+  if (cache_size_ > 0)
+    cache_.Put(key, {result, base::TimeTicks::Now() + cache_ttl_});
+  std::move(done).Run(result);
+
+  auto it = pending_.find(key);
+  if (it == pending_.end() || it->second->id != pending_id)
+    return;
+  auto waiters = std::move(it->second->waiters);
+  pending_.erase(it);
+  for (auto& waiter : waiters)
+    std::move(waiter.second).Run(result);
+}
+
+void CertVerifierClient::StopCoalescing(const std::string& key,
+                                        uint64_t pending_id) {
+  auto it = pending_.find(key);
+  if (it == pending_.end() || it->second->id != pending_id)
+    return;
+  auto waiters = std::move(it->second->waiters);
+  pending_.erase(it);
+  for (auto& waiter : waiters)
+    RunProc(key, 0, waiter.first, std::move(waiter.second));
 }
 
 }  // namespace electron
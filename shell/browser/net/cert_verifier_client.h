@@ -5,8 +5,16 @@
 #ifndef SHELL_BROWSER_NET_CERT_VERIFIER_CLIENT_H_
 #define SHELL_BROWSER_NET_CERT_VERIFIER_CLIENT_H_
 
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "base/containers/mru_cache.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "net/cert/x509_certificate.h"
 #include "services/network/public/mojom/network_context.mojom.h"
 
@@ -30,7 +38,13 @@ class CertVerifierClient : public network::mojom::CertVerifierClient {
       base::RepeatingCallback<void(const VerifyRequestParams& request,
                                    base::RepeatingCallback<void(int)>)>;
 
-  explicit CertVerifierClient(CertVerifyProc proc);
+  // The decisions of |proc| are remembered for |cache_ttl|, for at most
+  // |cache_size| combinations of hostname, certificate chain and default
+  // error. When |cache_size| is not 0, concurrent verifications of the same
+  // combination also share a single call of |proc|.
+  CertVerifierClient(CertVerifyProc proc,
+                     size_t cache_size,
+                     base::TimeDelta cache_ttl);
   ~CertVerifierClient() override;
 
   // network::mojom::CertVerifierClient
@@ -43,7 +57,48 @@ class CertVerifierClient : public network::mojom::CertVerifierClient {
               VerifyCallback callback) override;
 
  private:
+  using DoneCallback = base::OnceCallback<void(int)>;
+
+  struct CachedResult {
+    int result;
+    base::TimeTicks expiration_time;
+  };
+
+  // Verifications waiting for the call of |cert_verify_proc_| made for
+  // another verification of the same key.
+  struct PendingVerification {
+    PendingVerification();
+    ~PendingVerification();
+
+    uint64_t id;
+    std::vector<std::pair<VerifyRequestParams, DoneCallback>> waiters;
+    base::OneShotTimer timeout;
+  };
+
+  // Calls |cert_verify_proc_| for |params|. |pending_id| identifies the
+  // PendingVerification of |key| that gets the result too, 0 for none.
+  void RunProc(const std::string& key,
+               uint64_t pending_id,
+               const VerifyRequestParams& params,
+               DoneCallback done);
+  void OnVerifyProcResult(const std::string& key,
+                          uint64_t pending_id,
+                          DoneCallback done,
+                          int result);
+  // Lets the waiters of |key| call |cert_verify_proc_| on their own, when the
+  // call they wait for will not return in time or at all.
+  void StopCoalescing(const std::string& key, uint64_t pending_id);
+
   CertVerifyProc cert_verify_proc_;
+
+  size_t cache_size_;
+  base::TimeDelta cache_ttl_;
+  base::MRUCache<std::string, CachedResult> cache_;
+
+  std::map<std::string, std::unique_ptr<PendingVerification>> pending_;
+  uint64_t next_pending_id_ = 1;
+
+  base::WeakPtrFactory<CertVerifierClient> weak_factory_{this};
 };
 
 }  // namespace electron
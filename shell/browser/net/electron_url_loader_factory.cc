@@ -9,6 +9,9 @@
 #include <utility>
 
 #include "base/guid.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/numerics/clamped_math.h"
+#include "base/numerics/ranges.h"
 #include "base/strings/string_number_conversions.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/storage_partition.h"
@@ -145,10 +148,51 @@ network::mojom::URLResponseHeadPtr ToResponseHead(
   return head;
 }
 
-// Helper to write string to pipe.
+// The memory of an ArrayBuffer detached from JavaScript, so the response body
+// can be written to the data pipe without copying it first.
+class BufferMemory : public base::RefCountedMemory {
+ public:
+  explicit BufferMemory(std::shared_ptr<v8::BackingStore> backing_store)
+      : backing_store_(std::move(backing_store)) {}
+
+  // base::RefCountedMemory:
+  const unsigned char* front() const override {
+    return static_cast<const unsigned char*>(backing_store_->Data());
+  }
+  size_t size() const override { return backing_store_->ByteLength(); }
+
+ private:
+  ~BufferMemory() override = default;
+
+  std::shared_ptr<v8::BackingStore> backing_store_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferMemory);
+};
+
+// Returns the contents of the Node Buffer |buffer|. JavaScript can still write
+// to the Buffer while the pipe is filled on another sequence, so its memory is
+// only used directly when |transfer| is set and the Buffer spans a whole
+// detachable ArrayBuffer, which is then detached. Copies it otherwise.
+scoped_refptr<base::RefCountedMemory> TakeBufferData(
+    v8::Local<v8::Value> buffer,
+    bool transfer) {
+  v8::Local<v8::ArrayBufferView> view = buffer.As<v8::ArrayBufferView>();
+  v8::Local<v8::ArrayBuffer> array_buffer = view->Buffer();
+  if (transfer && array_buffer->IsDetachable() && view->ByteOffset() == 0 &&
+      view->ByteLength() == array_buffer->ByteLength()) {
+    auto backing_store = array_buffer->GetBackingStore();
+    array_buffer->Detach();
+    return base::MakeRefCounted<BufferMemory>(std::move(backing_store));
+  }
+  return base::MakeRefCounted<base::RefCountedBytes>(
+      reinterpret_cast<const unsigned char*>(node::Buffer::Data(buffer)),
+      node::Buffer::Length(buffer));
+}
+
+// Helper to write data to pipe.
 struct WriteData {
   mojo::Remote<network::mojom::URLLoaderClient> client;
-  std::string data;
+  scoped_refptr<base::RefCountedMemory> data;
   std::unique_ptr<mojo::DataPipeProducer> producer;
 };
 
@@ -156,24 +200,66 @@ void OnWrite(std::unique_ptr<WriteData> write_data, MojoResult result) {
   network::URLLoaderCompletionStatus status(net::ERR_FAILED);
   if (result == MOJO_RESULT_OK) {
     status = network::URLLoaderCompletionStatus(net::OK);
-    status.encoded_data_length = write_data->data.size();
-    status.encoded_body_length = write_data->data.size();
-    status.decoded_body_length = write_data->data.size();
+    status.encoded_data_length = write_data->data->size();
+    status.encoded_body_length = write_data->data->size();
+    status.decoded_body_length = write_data->data->size();
   }
   write_data->client->OnComplete(status);
 }
 
+// Returns a copy of the body of a buffer or string response, the only types
+// whose responses can be cached, unless it is larger than |max_size|.
+scoped_refptr<base::RefCountedMemory> GetCacheableBody(
+    ProtocolType type,
+    v8::Isolate* isolate,
+    v8::Local<v8::Value> response,
+    const gin_helper::Dictionary& dict,
+    size_t max_size) {
+  if (type == ProtocolType::kBuffer) {
+    if (dict.IsEmpty())
+      return nullptr;
+    v8::Local<v8::Value> buffer = dict.GetHandle();
+    dict.Get("data", &buffer);
+    if (!node::Buffer::HasInstance(buffer) ||
+        node::Buffer::Length(buffer) > max_size)
+      return nullptr;
+    return base::MakeRefCounted<base::RefCountedBytes>(
+        reinterpret_cast<const unsigned char*>(node::Buffer::Data(buffer)),
+        node::Buffer::Length(buffer));
+  }
+  if (type == ProtocolType::kString) {
+    std::string contents;
+    if (response->IsString())
+      contents = gin::V8ToString(isolate, response);
+    else if (dict.IsEmpty() || !dict.Get("data", &contents))
+      return nullptr;
+    return base::RefCountedString::TakeString(&contents);
+  }
+  return nullptr;
+}
+
+// Large bodies are written in fewer, larger chunks by sizing the pipe after
+// the body, within the bounds used by Chromium's own loaders.
+constexpr uint32_t kMinPipeCapacity = 64 * 1024;
+constexpr uint32_t kMaxPipeCapacity = 2 * 1024 * 1024;
+
+uint32_t GetPipeCapacity(size_t body_size) {
+  return static_cast<uint32_t>(base::ClampToRange<size_t>(
+      body_size, kMinPipeCapacity, kMaxPipeCapacity));
+}
+
 }  // namespace
 
 // static
 mojo::PendingRemote<network::mojom::URLLoaderFactory>
 ElectronURLLoaderFactory::Create(ProtocolType type,
-                                 const ProtocolHandler& handler) {
+                                 const ProtocolHandler& handler,
+                                 scoped_refptr<ProtocolResponseCache> cache) {
   mojo::PendingRemote<network::mojom::URLLoaderFactory> pending_remote;
 
   // The ElectronURLLoaderFactory will delete itself when there are no more
   // receivers - see the NonNetworkURLLoaderFactoryBase::OnDisconnect method.
-  new ElectronURLLoaderFactory(type, handler,
+  new ElectronURLLoaderFactory(type, handler, std::move(cache),
                                pending_remote.InitWithNewPipeAndPassReceiver());
 
   return pending_remote;
@@ -182,10 +268,12 @@ ElectronURLLoaderFactory::Create(ProtocolType type,
 ElectronURLLoaderFactory::ElectronURLLoaderFactory(
     ProtocolType type,
     const ProtocolHandler& handler,
+    scoped_refptr<ProtocolResponseCache> cache,
     mojo::PendingReceiver<network::mojom::URLLoaderFactory> factory_receiver)
     : content::NonNetworkURLLoaderFactoryBase(std::move(factory_receiver)),
       type_(type),
-      handler_(handler) {}
+      handler_(handler),
+      cache_(std::move(cache)) {}
 
 ElectronURLLoaderFactory::~ElectronURLLoaderFactory() = default;
 
@@ -198,6 +286,24 @@ void ElectronURLLoaderFactory::CreateLoaderAndStart(
     mojo::PendingRemote<network::mojom::URLLoaderClient> client,
     const net::MutableNetworkTrafficAnnotationTag& traffic_annotation) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (cache_ && cache_->enabled() &&
+      ProtocolResponseCache::IsCacheableRequest(request)) {
+    std::string key = cache_->GetKey(request);
+    // Reloads skip the cached entry, but their response replaces it.
+    if (ProtocolResponseCache::IsNoCacheRequest(request)) {
+      OnCacheLookup(std::move(loader), routing_id, request_id, options,
+                    request, std::move(client), traffic_annotation, type_,
+                    handler_, cache_, key, nullptr);
+      return;
+    }
+    cache_->Lookup(
+        key, base::BindOnce(&ElectronURLLoaderFactory::OnCacheLookup,
+                            std::move(loader), routing_id, request_id,
+                            options, request, std::move(client),
+                            traffic_annotation, type_, handler_, cache_, key));
+    return;
+  }
+
   mojo::PendingRemote<network::mojom::URLLoaderFactory> proxy_factory;
   handler_.Run(request, base::BindOnce(&ElectronURLLoaderFactory::StartLoading,
                                        std::move(loader), routing_id,
@@ -206,6 +312,86 @@ void ElectronURLLoaderFactory::CreateLoaderAndStart(
                                        std::move(proxy_factory), type_));
 }
 
+// static
+void ElectronURLLoaderFactory::OnCacheLookup(
+    mojo::PendingReceiver<network::mojom::URLLoader> loader,
+    int32_t routing_id,
+    int32_t request_id,
+    uint32_t options,
+    const network::ResourceRequest& request,
+    mojo::PendingRemote<network::mojom::URLLoaderClient> client,
+    const net::MutableNetworkTrafficAnnotationTag& traffic_annotation,
+    ProtocolType type,
+    const ProtocolHandler& handler,
+    scoped_refptr<ProtocolResponseCache> cache,
+    const std::string& key,
+    scoped_refptr<ProtocolResponseCache::Entry> entry) {
+  if (entry && entry->IsFresh()) {
+    SendContents(std::move(client), entry->CreateResponseHead(), entry->body);
+    return;
+  }
+
+  network::ResourceRequest handler_request = request;
+  if (entry)
+    entry->AddValidationHeaders(&handler_request.headers);
+  handler.Run(handler_request,
+              base::BindOnce(&ElectronURLLoaderFactory::StartLoadingAndCache,
+                             std::move(loader), routing_id, request_id,
+                             options, request, std::move(client),
+                             traffic_annotation, type, std::move(cache), key,
+                             std::move(entry)));
+}
+
+// static
+void ElectronURLLoaderFactory::StartLoadingAndCache(
+    mojo::PendingReceiver<network::mojom::URLLoader> loader,
+    int32_t routing_id,
+    int32_t request_id,
+    uint32_t options,
+    const network::ResourceRequest& request,
+    mojo::PendingRemote<network::mojom::URLLoaderClient> client,
+    const net::MutableNetworkTrafficAnnotationTag& traffic_annotation,
+    ProtocolType type,
+    scoped_refptr<ProtocolResponseCache> cache,
+    const std::string& key,
+    scoped_refptr<ProtocolResponseCache::Entry> entry,
+    gin::Arguments* args) {
+  // Errors and redirects are left to StartLoading, which does not cache them.
+  v8::Local<v8::Value> response = args->PeekNext();
+  if (!response.IsEmpty()) {
+    gin_helper::Dictionary dict = ToDict(args->isolate(), response);
+    int error = net::OK;
+    int status_code = net::HTTP_OK;
+    if (!dict.IsEmpty()) {
+      dict.Get("error", &error);
+      dict.Get("statusCode", &status_code);
+    }
+
+    if (error == net::OK && entry && status_code == net::HTTP_NOT_MODIFIED) {
+      entry = cache->Refresh(key, entry, *ToResponseHead(dict)->headers);
+      SendContents(std::move(client), entry->CreateResponseHead(),
+                   entry->body);
+      return;
+    }
+
+    // The body is only copied when the response is going to be stored.
+    if (error == net::OK) {
+      network::mojom::URLResponseHeadPtr head = ToResponseHead(dict);
+      if (cache->IsCacheableResponse(*head)) {
+        auto body = GetCacheableBody(type, args->isolate(), response, dict,
+                                     cache->max_size());
+        if (body)
+          cache->Store(key, *head, std::move(body));
+      }
+    }
+  }
+
+  mojo::PendingRemote<network::mojom::URLLoaderFactory> proxy_factory;
+  StartLoading(std::move(loader), routing_id, request_id, options, request,
+               std::move(client), traffic_annotation, std::move(proxy_factory),
+               type, args);
+}
+
 // static
 void ElectronURLLoaderFactory::OnComplete(
     mojo::PendingRemote<network::mojom::URLLoaderClient> client,
@@ -365,9 +551,10 @@ void ElectronURLLoaderFactory::StartLoadingBuffer(
     return;
   }
 
-  SendContents(
-      std::move(client), std::move(head),
-      std::string(node::Buffer::Data(buffer), node::Buffer::Length(buffer)));
+  bool transfer = false;
+  dict.Get("transferData", &transfer);
+  SendContents(std::move(client), std::move(head),
+               TakeBufferData(buffer, transfer));
 }
 
 // static
@@ -390,7 +577,8 @@ void ElectronURLLoaderFactory::StartLoadingString(
     return;
   }
 
-  SendContents(std::move(client), std::move(head), std::move(contents));
+  SendContents(std::move(client), std::move(head),
+               base::RefCountedString::TakeString(&contents));
 }
 
 // static
@@ -403,11 +591,13 @@ void ElectronURLLoaderFactory::StartLoadingFile(
     v8::Isolate* isolate,
     v8::Local<v8::Value> response) {
   base::FilePath path;
+  uint32_t pipe_size = 0;
   if (gin::ConvertFromV8(isolate, response, &path)) {
     request.url = net::FilePathToFileURL(path);
   } else if (!dict.IsEmpty()) {
     dict.Get("referrer", &request.referrer);
     dict.Get("method", &request.method);
+    dict.Get("highWaterMark", &pipe_size);
     if (dict.Get("path", &path))
       request.url = net::FilePathToFileURL(path);
   } else {
@@ -421,7 +611,7 @@ void ElectronURLLoaderFactory::StartLoadingFile(
   // Add header to ignore CORS.
   head->headers->AddHeader("Access-Control-Allow-Origin", "*");
   asar::CreateAsarURLLoader(request, std::move(loader), std::move(client),
-                            head->headers);
+                            head->headers, pipe_size);
 }
 
 // static
@@ -516,15 +706,26 @@ void ElectronURLLoaderFactory::StartLoadingStream(
     return;
   }
 
+  // Unless told otherwise, let the pipe hold a few times what the stream
+  // buffers itself, so the stream is read in batches of chunks.
+  uint32_t pipe_capacity = 0;
+  if (stream == dict.GetHandle() ||
+      !dict.Get("highWaterMark", &pipe_capacity)) {
+    uint32_t high_water_mark = 0;
+    data.Get("readableHighWaterMark", &high_water_mark);
+    pipe_capacity = base::ClampMul(high_water_mark, 4);
+  }
+
   new NodeStreamLoader(std::move(head), std::move(loader), std::move(client),
-                       data.isolate(), data.GetHandle());
+                       data.isolate(), data.GetHandle(),
+                       GetPipeCapacity(pipe_capacity));
 }
 
 // static
 void ElectronURLLoaderFactory::SendContents(
     mojo::PendingRemote<network::mojom::URLLoaderClient> client,
     network::mojom::URLResponseHeadPtr head,
-    std::string data) {
+    scoped_refptr<base::RefCountedMemory> data) {
   mojo::Remote<network::mojom::URLLoaderClient> client_remote(
       std::move(client));
 
@@ -533,9 +734,15 @@ void ElectronURLLoaderFactory::SendContents(
   client_remote->OnReceiveResponse(std::move(head));
 
   // Code bellow follows the pattern of data_url_loader_factory.cc.
+  MojoCreateDataPipeOptions options;
+  options.struct_size = sizeof(MojoCreateDataPipeOptions);
+  options.flags = MOJO_CREATE_DATA_PIPE_FLAG_NONE;
+  options.element_num_bytes = 1;
+  options.capacity_num_bytes = GetPipeCapacity(data->size());
+
   mojo::ScopedDataPipeProducerHandle producer;
   mojo::ScopedDataPipeConsumerHandle consumer;
-  if (mojo::CreateDataPipe(nullptr, &producer, &consumer) != MOJO_RESULT_OK) {
+  if (mojo::CreateDataPipe(&options, &producer, &consumer) != MOJO_RESULT_OK) {
     client_remote->OnComplete(
         network::URLLoaderCompletionStatus(net::ERR_INSUFFICIENT_RESOURCES));
     return;
@@ -550,7 +757,10 @@ void ElectronURLLoaderFactory::SendContents(
       std::make_unique<mojo::DataPipeProducer>(std::move(producer));
   auto* producer_ptr = write_data->producer.get();
 
-  base::StringPiece string_piece(write_data->data);
+  // |write_data| keeps the memory alive until the write completes, so the
+  // data is read straight from it.
+  base::StringPiece string_piece(write_data->data->front_as<char>(),
+                                 write_data->data->size());
   producer_ptr->Write(
       std::make_unique<mojo::StringDataSource>(
           string_piece, mojo::StringDataSource::AsyncWritingMode::
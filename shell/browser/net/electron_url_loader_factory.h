@@ -9,6 +9,7 @@
 #include <string>
 #include <utility>
 
+#include "base/memory/ref_counted_memory.h"
 #include "content/public/browser/non_network_url_loader_factory_base.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/pending_remote.h"
@@ -17,6 +18,7 @@
 #include "net/url_request/url_request_job_factory.h"
 #include "services/network/public/mojom/url_loader_factory.mojom.h"
 #include "services/network/public/mojom/url_response_head.mojom.h"
+#include "shell/browser/net/protocol_response_cache.h"
 #include "shell/common/gin_helper/dictionary.h"
 
 namespace electron {
@@ -45,7 +47,8 @@ class ElectronURLLoaderFactory
  public:
   static mojo::PendingRemote<network::mojom::URLLoaderFactory> Create(
       ProtocolType type,
-      const ProtocolHandler& handler);
+      const ProtocolHandler& handler,
+      scoped_refptr<ProtocolResponseCache> cache);
 
   // network::mojom::URLLoaderFactory:
   void CreateLoaderAndStart(
@@ -74,9 +77,40 @@ class ElectronURLLoaderFactory
   ElectronURLLoaderFactory(
       ProtocolType type,
       const ProtocolHandler& handler,
+      scoped_refptr<ProtocolResponseCache> cache,
       mojo::PendingReceiver<network::mojom::URLLoaderFactory> factory_receiver);
   ~ElectronURLLoaderFactory() override;
 
+  // Serves the request from |entry| when it is fresh, otherwise calls the
+  // handler, revalidating |entry| if there is one.
+  static void OnCacheLookup(
+      mojo::PendingReceiver<network::mojom::URLLoader> loader,
+      int32_t routing_id,
+      int32_t request_id,
+      uint32_t options,
+      const network::ResourceRequest& request,
+      mojo::PendingRemote<network::mojom::URLLoaderClient> client,
+      const net::MutableNetworkTrafficAnnotationTag& traffic_annotation,
+      ProtocolType type,
+      const ProtocolHandler& handler,
+      scoped_refptr<ProtocolResponseCache> cache,
+      const std::string& key,
+      scoped_refptr<ProtocolResponseCache::Entry> entry);
+  // Stores the response of the handler in |cache| before loading it.
+  static void StartLoadingAndCache(
+      mojo::PendingReceiver<network::mojom::URLLoader> loader,
+      int32_t routing_id,
+      int32_t request_id,
+      uint32_t options,
+      const network::ResourceRequest& request,
+      mojo::PendingRemote<network::mojom::URLLoaderClient> client,
+      const net::MutableNetworkTrafficAnnotationTag& traffic_annotation,
+      ProtocolType type,
+      scoped_refptr<ProtocolResponseCache> cache,
+      const std::string& key,
+      scoped_refptr<ProtocolResponseCache::Entry> entry,
+      gin::Arguments* args);
+
   static void OnComplete(
       mojo::PendingRemote<network::mojom::URLLoaderClient> client,
       int32_t request_id,
@@ -111,14 +145,15 @@ class ElectronURLLoaderFactory
       network::mojom::URLResponseHeadPtr head,
       const gin_helper::Dictionary& dict);
 
-  // Helper to send string as response.
+  // Helper to send |data| as response.
   static void SendContents(
       mojo::PendingRemote<network::mojom::URLLoaderClient> client,
       network::mojom::URLResponseHeadPtr head,
-      std::string data);
+      scoped_refptr<base::RefCountedMemory> data);
 
   ProtocolType type_;
   ProtocolHandler handler_;
+  scoped_refptr<ProtocolResponseCache> cache_;
 
   DISALLOW_COPY_AND_ASSIGN(ElectronURLLoaderFactory);
 };
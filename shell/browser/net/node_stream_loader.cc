@@ -4,9 +4,11 @@
 
 #include "shell/browser/net/node_stream_loader.h"
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
 
-#include "mojo/public/cpp/system/string_data_source.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "shell/common/gin_converters/callback_converter.h"
 #include "shell/common/node_includes.h"
 
@@ -17,17 +19,21 @@ NodeStreamLoader::NodeStreamLoader(
     network::mojom::URLLoaderRequest loader,
     mojo::PendingRemote<network::mojom::URLLoaderClient> client,
     v8::Isolate* isolate,
-    v8::Local<v8::Object> emitter)
+    v8::Local<v8::Object> emitter,
+    uint32_t pipe_capacity)
     : binding_(this, std::move(loader)),
       client_(std::move(client)),
       isolate_(isolate),
       emitter_(isolate, emitter),
+      producer_watcher_(FROM_HERE,
+                        mojo::SimpleWatcher::ArmingPolicy::MANUAL,
+                        base::SequencedTaskRunnerHandle::Get()),
       weak_factory_(this) {
   binding_.set_connection_error_handler(
       base::BindOnce(&NodeStreamLoader::NotifyComplete,
                      weak_factory_.GetWeakPtr(), net::ERR_FAILED));
 
-  Start(std::move(head));
+  Start(std::move(head), pipe_capacity);
 }
 
 NodeStreamLoader::~NodeStreamLoader() {
@@ -50,20 +56,29 @@ NodeStreamLoader::~NodeStreamLoader() {
   }
 }
 
-void NodeStreamLoader::Start(network::mojom::URLResponseHeadPtr head) {
-  mojo::ScopedDataPipeProducerHandle producer;
+void NodeStreamLoader::Start(network::mojom::URLResponseHeadPtr head,
+                             uint32_t pipe_capacity) {
+  MojoCreateDataPipeOptions options;
+  options.struct_size = sizeof(MojoCreateDataPipeOptions);
+  options.flags = MOJO_CREATE_DATA_PIPE_FLAG_NONE;
+  options.element_num_bytes = 1;
+  options.capacity_num_bytes = pipe_capacity;
+
   mojo::ScopedDataPipeConsumerHandle consumer;
-  MojoResult rv = mojo::CreateDataPipe(nullptr, &producer, &consumer);
+  MojoResult rv = mojo::CreateDataPipe(&options, &producer_, &consumer);
   if (rv != MOJO_RESULT_OK) {
     NotifyComplete(net::ERR_INSUFFICIENT_RESOURCES);
     return;
   }
 
-  producer_ = std::make_unique<mojo::DataPipeProducer>(std::move(producer));
+  auto weak = weak_factory_.GetWeakPtr();
+  producer_watcher_.Watch(
+      producer_.get(), MOJO_HANDLE_SIGNAL_WRITABLE,
+      base::BindRepeating(&NodeStreamLoader::OnWritable, weak));
+
   client_->OnReceiveResponse(std::move(head));
   client_->OnStartLoadingResponseBody(std::move(consumer));
 
-  auto weak = weak_factory_.GetWeakPtr();
   On("end",
      base::BindRepeating(&NodeStreamLoader::NotifyComplete, weak, net::OK));
   On("error", base::BindRepeating(&NodeStreamLoader::NotifyComplete, weak,
@@ -72,11 +87,20 @@ void NodeStreamLoader::Start(network::mojom::URLResponseHeadPtr head) {
 }
 
 void NodeStreamLoader::NotifyReadable() {
-  if (!readable_)
-    ReadMore();
-  else if (is_reading_)
+  if (is_reading_) {
+    // The event was emitted inside read(), so read again before deciding that
+    // the stream has been drained.
     has_read_waiting_ = true;
+    return;
+  }
+
+  // Otherwise we are either writing what was read or waiting for the pipe,
+  // and will keep reading once the pipe has room.
+  if (readable_)
+    return;
+
   readable_ = true;
+  ReadMore();
 }
 
 void NodeStreamLoader::NotifyComplete(int result) {
@@ -98,59 +122,92 @@ void NodeStreamLoader::ReadMore() {
     // a nested read, so short-circuit.
     return;
   }
+
+  void* data = nullptr;
+  uint32_t available = 0;
+  MojoResult rv =
+      producer_->BeginWriteData(&data, &available, MOJO_WRITE_DATA_FLAG_NONE);
+  if (rv == MOJO_RESULT_SHOULD_WAIT) {
+    is_writing_ = true;
+    producer_watcher_.ArmOrNotify();
+    return;
+  } else if (rv != MOJO_RESULT_OK) {
+    NotifyComplete(net::ERR_FAILED);
+    return;
+  }
+
+  // Fill the pipe with the chunk left from last time, followed by as many
+  // chunks as the stream has available.
   is_reading_ = true;
-  auto weak = weak_factory_.GetWeakPtr();
   v8::HandleScope scope(isolate_);
-  // buffer = emitter.read()
-  v8::MaybeLocal<v8::Value> ret = node::MakeCallback(
-      isolate_, emitter_.Get(isolate_), "read", 0, nullptr, {0, 0});
-  DCHECK(weak) << "We shouldn't have been destroyed when calling read()";
-
-  // If there is no buffer read, wait until |readable| is emitted again.
-  v8::Local<v8::Value> buffer;
-  if (!ret.ToLocal(&buffer) || !node::Buffer::HasInstance(buffer)) {
-    is_reading_ = false;
-
-    // If 'readable' was called after 'read()', try again
-    if (has_read_waiting_) {
-      has_read_waiting_ = false;
-      ReadMore();
-      return;
+  uint32_t written = 0;
+  bool drained = false;
+  while (written < available) {
+    if (buffer_.IsEmpty() && !ReadChunk()) {
+      drained = true;
+      break;
     }
 
-    readable_ = false;
-    if (ended_) {
-      NotifyComplete(result_);
+    v8::Local<v8::Value> buffer = buffer_.Get(isolate_);
+    size_t length = node::Buffer::Length(buffer);
+    size_t size =
+        std::min<size_t>(length - buffer_offset_, available - written);
+    memcpy(static_cast<char*>(data) + written,
+           node::Buffer::Data(buffer) + buffer_offset_, size);
+    written += size;
+    buffer_offset_ += size;
+    if (buffer_offset_ == length) {
+      buffer_.Reset();
+      buffer_offset_ = 0;
     }
+  }
+  producer_->EndWriteData(written);
+  is_reading_ = false;
+
+  if (!drained) {
+    // The pipe is full, continue when the consumer has read from it.
+    is_writing_ = true;
+    producer_watcher_.ArmOrNotify();
     return;
   }
 
-  // Hold the buffer until the write is done.
-  buffer_.Reset(isolate_, buffer);
+  // Wait until |readable| is emitted again.
+  readable_ = false;
+  if (ended_)
+    NotifyComplete(result_);
+}
+
+bool NodeStreamLoader::ReadChunk() {
+  for (;;) {
+    auto weak = weak_factory_.GetWeakPtr();
+    // buffer = emitter.read()
+    v8::MaybeLocal<v8::Value> ret = node::MakeCallback(
+        isolate_, emitter_.Get(isolate_), "read", 0, nullptr, {0, 0});
+    DCHECK(weak) << "We shouldn't have been destroyed when calling read()";
+
+    v8::Local<v8::Value> buffer;
+    if (ret.ToLocal(&buffer) && node::Buffer::HasInstance(buffer)) {
+      // Hold the buffer until it has been copied to the pipe.
+      buffer_.Reset(isolate_, buffer);
+      buffer_offset_ = 0;
+      return true;
+    }
 
-  // Write buffer to mojo pipe asynchronously.
-  is_reading_ = false;
-  is_writing_ = true;
-  producer_->Write(std::make_unique<mojo::StringDataSource>(
-                       base::StringPiece(node::Buffer::Data(buffer),
-                                         node::Buffer::Length(buffer)),
-                       mojo::StringDataSource::AsyncWritingMode::
-                           STRING_STAYS_VALID_UNTIL_COMPLETION),
-                   base::BindOnce(&NodeStreamLoader::DidWrite, weak));
+    // If 'readable' was called after 'read()', try again.
+    if (!has_read_waiting_)
+      return false;
+    has_read_waiting_ = false;
+  }
 }
 
-void NodeStreamLoader::DidWrite(MojoResult result) {
+void NodeStreamLoader::OnWritable(MojoResult result) {
   is_writing_ = false;
-  // We were told to end streaming.
-  if (ended_) {
-    NotifyComplete(result_);
+  if (result != MOJO_RESULT_OK) {
+    NotifyComplete(net::ERR_FAILED);
     return;
   }
 
-  if (result == MOJO_RESULT_OK && readable_)
-    ReadMore();
-  else
-    NotifyComplete(net::ERR_FAILED);
+  ReadMore();
 }
 
 void NodeStreamLoader::On(const char* event, EventCallback callback) {
@@ -13,7 +13,8 @@
 #include "mojo/public/cpp/bindings/pending_remote.h"
 #include "mojo/public/cpp/bindings/remote.h"
 #include "mojo/public/cpp/bindings/strong_binding.h"
-#include "mojo/public/cpp/system/data_pipe_producer.h"
+#include "mojo/public/cpp/system/data_pipe.h"
+#include "mojo/public/cpp/system/simple_watcher.h"
 #include "services/network/public/mojom/url_loader.mojom.h"
 #include "services/network/public/mojom/url_response_head.mojom.h"
 #include "v8/include/v8.h"
@@ -28,24 +29,34 @@ namespace electron {
 // We use |paused mode| to read data from |Readable| stream, so we don't need to
 // copy data from buffer and hold it in memory, and we only need to make sure
 // the passed |Buffer| is alive while writing data to pipe.
+//
+// Data is only read from the stream when the pipe has room for it, so the
+// stream's own high water mark bounds what is buffered in memory, and all the
+// chunks available at that time are copied into the pipe with a single
+// two-phase write.
 class NodeStreamLoader : public network::mojom::URLLoader {
  public:
   NodeStreamLoader(network::mojom::URLResponseHeadPtr head,
                    network::mojom::URLLoaderRequest loader,
                    mojo::PendingRemote<network::mojom::URLLoaderClient> client,
                    v8::Isolate* isolate,
-                   v8::Local<v8::Object> emitter);
+                   v8::Local<v8::Object> emitter,
+                   uint32_t pipe_capacity);
 
  private:
   ~NodeStreamLoader() override;
 
   using EventCallback = base::RepeatingCallback<void()>;
 
-  void Start(network::mojom::URLResponseHeadPtr head);
+  void Start(network::mojom::URLResponseHeadPtr head, uint32_t pipe_capacity);
   void NotifyReadable();
   void NotifyComplete(int result);
   void ReadMore();
-  void DidWrite(MojoResult result);
+  void OnWritable(MojoResult result);
+
+  // Calls emitter.read() and stores the returned chunk in |buffer_|, returns
+  // false if the stream has no data available.
+  bool ReadChunk();
 
   // Subscribe to events of |emitter|.
   void On(const char* event, EventCallback callback);
@@ -68,10 +79,14 @@ class NodeStreamLoader : public network::mojom::URLLoader {
   v8::Global<v8::Object> emitter_;
   v8::Global<v8::Value> buffer_;
 
+  // How much of |buffer_| has been written to the pipe.
+  size_t buffer_offset_ = 0;
+
   // Mojo data pipe where the data that is being read is written to.
-  std::unique_ptr<mojo::DataPipeProducer> producer_;
+  mojo::ScopedDataPipeProducerHandle producer_;
+  mojo::SimpleWatcher producer_watcher_;
 
-  // Whether we are in the middle of write.
+  // Whether we are waiting for the pipe to become writable.
   bool is_writing_ = false;
 
   // Whether we are in the middle of a stream.read().
@@ -0,0 +1,500 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/net/protocol_response_cache.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/hash/md5.h"
+#include "base/pickle.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/task/post_task.h"
+#include "base/task/thread_pool.h"
+#include "net/base/load_flags.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_status_code.h"
+#include "services/network/public/cpp/resource_request.h"
+
+namespace electron {
+
+namespace {
+
+bool HasValidator(const net::HttpResponseHeaders& headers) {
+  return headers.HasHeader("etag") || headers.HasHeader("last-modified");
+}
+
+base::TimeDelta GetFreshness(const net::HttpResponseHeaders& headers,
+                             base::Time response_time) {
+  return headers.GetFreshnessLifetimes(response_time).freshness;
+}
+
+// Returns the headers of a stored response updated with the ones of the 304
+// response that revalidated it, as described in RFC 7234 section 4.3.4. The
+// headers describing the body are kept, since the body is not replaced.
+scoped_refptr<net::HttpResponseHeaders> MergeNotModifiedHeaders(
+    const std::string& raw_headers,
+    const net::HttpResponseHeaders& not_modified) {
+  auto merged = base::MakeRefCounted<net::HttpResponseHeaders>(raw_headers);
+  std::set<std::string> replaced;
+  size_t iter = 0;
+  std::string name;
+  std::string value;
+  while (not_modified.EnumerateHeaderLines(&iter, &name, &value)) {
+    std::string lower_name = base::ToLowerASCII(name);
+    if (lower_name == "content-length" || lower_name == "content-type")
+      continue;
+    // Headers with several lines replace all the stored lines at once.
+    if (replaced.insert(lower_name).second)
+      merged->RemoveHeader(name);
+    merged->AddHeader(name, value);
+  }
+  return merged;
+}
+
+bool HasDirective(const net::HttpRequestHeaders& headers,
+                  base::StringPiece name,
+                  base::StringPiece directive) {
+  std::string value;
+  if (!headers.GetHeader(name, &value))
+    return false;
+  for (base::StringPiece token : base::SplitStringPiece(
+           value, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (base::EqualsCaseInsensitiveASCII(token, directive))
+      return true;
+  }
+  return false;
+}
+
+// Disk entries are named after the MD5 of their key.
+bool IsDiskEntryName(const std::string& name) {
+  return name.size() == 32 &&
+         std::all_of(name.begin(), name.end(), base::IsHexDigit<char>);
+}
+
+// Disk entries are a pickle of the entry followed by its body.
+base::Pickle PickleEntry(const ProtocolResponseCache::Entry& entry) {
+  base::Pickle pickle;
+  pickle.WriteString(entry.raw_headers);
+  pickle.WriteString(entry.mime_type);
+  pickle.WriteString(entry.charset);
+  pickle.WriteInt64(
+      entry.expiration_time.ToDeltaSinceWindowsEpoch().InMicroseconds());
+  pickle.WriteData(entry.body->front_as<char>(), entry.body->size());
+  return pickle;
+}
+
+scoped_refptr<ProtocolResponseCache::Entry> ReadEntryFromDisk(
+    const base::FilePath& path) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return nullptr;
+
+  base::Pickle pickle(contents.data(), contents.size());
+  base::PickleIterator iter(pickle);
+  auto entry = base::MakeRefCounted<ProtocolResponseCache::Entry>();
+  int64_t expiration_time;
+  const char* body;
+  int body_size;
+  if (!iter.ReadString(&entry->raw_headers) ||
+      !iter.ReadString(&entry->mime_type) ||
+      !iter.ReadString(&entry->charset) || !iter.ReadInt64(&expiration_time) ||
+      !iter.ReadData(&body, &body_size))
+    return nullptr;
+
+  entry->expiration_time = base::Time::FromDeltaSinceWindowsEpoch(
+      base::TimeDelta::FromMicroseconds(expiration_time));
+  std::string body_string(body, body_size);
+  entry->body = base::RefCountedString::TakeString(&body_string);
+  return entry;
+}
+
+}  // namespace
+
+class ProtocolResponseCache::DiskCache {
+ public:
+  DiskCache(const base::FilePath& path, size_t max_size)
+      : path_(path),
+        max_size_(max_size),
+        files_(decltype(files_)::NO_AUTO_EVICT) {}
+  ~DiskCache() = default;
+
+  // Indexes the entries left by previous runs, the least recently used first.
+  void Init() {
+    struct File {
+      base::Time last_used;
+      std::string name;
+      int64_t size;
+    };
+    std::vector<File> files;
+    base::FileEnumerator enumerator(path_, false, base::FileEnumerator::FILES);
+    for (base::FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      std::string name = path.BaseName().AsUTF8Unsafe();
+      if (!IsDiskEntryName(name))
+        continue;
+      base::FileEnumerator::FileInfo info = enumerator.GetInfo();
+      files.push_back({info.GetLastModifiedTime(), name, info.GetSize()});
+    }
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+      return a.last_used < b.last_used;
+    });
+    for (const File& file : files) {
+      files_.Put(file.name, file.size);
+      total_size_ += file.size;
+    }
+    EvictToSize(max_size_);
+  }
+
+  void SetMaxSize(size_t max_size) {
+    max_size_ = max_size;
+    EvictToSize(max_size_);
+  }
+
+  // Returns nullptr when there is no usable entry for |name|, unusable
+  // entries are deleted.
+  scoped_refptr<Entry> Read(const std::string& name) {
+    auto iter = files_.Get(name);
+    if (iter == files_.end())
+      return nullptr;
+
+    base::FilePath path = path_.AppendASCII(name);
+    scoped_refptr<Entry> entry = ReadEntryFromDisk(path);
+    if (!entry || !entry->IsUsable()) {
+      Delete(iter);
+      return nullptr;
+    }
+    // Keeps the order of use across restarts.
+    base::Time now = base::Time::Now();
+    base::TouchFile(path, now, now);
+    return entry;
+  }
+
+  void Write(const std::string& name, scoped_refptr<Entry> entry) {
+    base::Pickle pickle = PickleEntry(*entry);
+    auto iter = files_.Peek(name);
+    if (iter != files_.end())
+      Delete(iter);
+    if (pickle.size() > max_size_)
+      return;
+
+    EvictToSize(max_size_ - pickle.size());
+    if (!base::CreateDirectory(path_))
+      return;
+    base::FilePath path = path_.AppendASCII(name);
+    if (base::WriteFile(path, static_cast<const char*>(pickle.data()),
+                        pickle.size()) != static_cast<int>(pickle.size())) {
+      base::DeleteFile(path);
+      return;
+    }
+    files_.Put(name, pickle.size());
+    total_size_ += pickle.size();
+  }
+
+  void Remove(const std::string& name) {
+    auto iter = files_.Peek(name);
+    if (iter != files_.end())
+      Delete(iter);
+  }
+
+  // Deletes all the entries, and the directory if nothing else is left in it.
+  void DeleteAll() {
+    while (!files_.empty())
+      Delete(files_.begin());
+    base::DeleteFile(path_);
+  }
+
+ private:
+  using Files = base::MRUCache<std::string, int64_t>;
+
+  void Delete(Files::iterator iter) {
+    base::DeleteFile(path_.AppendASCII(iter->first));
+    total_size_ -= iter->second;
+    files_.Erase(iter);
+  }
+
+  void EvictToSize(size_t size) {
+    while (total_size_ > static_cast<int64_t>(size) && !files_.empty()) {
+      auto last = files_.rbegin();
+      base::DeleteFile(path_.AppendASCII(last->first));
+      total_size_ -= last->second;
+      files_.Erase(last);
+    }
+  }
+
+  base::FilePath path_;
+  size_t max_size_;
+  // The size of each file, keyed by its name.
+  Files files_;
+  int64_t total_size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(DiskCache);
+};
+
+ProtocolResponseCache::Options::Options() = default;
+ProtocolResponseCache::Options::Options(const Options&) = default;
+ProtocolResponseCache::Options::~Options() = default;
+
+ProtocolResponseCache::Entry::Entry() = default;
+ProtocolResponseCache::Entry::~Entry() = default;
+
+network::mojom::URLResponseHeadPtr
+ProtocolResponseCache::Entry::CreateResponseHead() const {
+  auto head = network::mojom::URLResponseHead::New();
+  head->headers = base::MakeRefCounted<net::HttpResponseHeaders>(raw_headers);
+  head->mime_type = mime_type;
+  head->charset = charset;
+  return head;
+}
+
+bool ProtocolResponseCache::Entry::IsFresh() const {
+  return base::Time::Now() < expiration_time;
+}
+
+bool ProtocolResponseCache::Entry::IsUsable() const {
+  return IsFresh() ||
+         HasValidator(*base::MakeRefCounted<net::HttpResponseHeaders>(
+             raw_headers));
+}
+
+void ProtocolResponseCache::Entry::AddValidationHeaders(
+    net::HttpRequestHeaders* headers) const {
+  auto response_headers =
+      base::MakeRefCounted<net::HttpResponseHeaders>(raw_headers);
+  std::string value;
+  if (response_headers->EnumerateHeader(nullptr, "etag", &value))
+    headers->SetHeader(net::HttpRequestHeaders::kIfNoneMatch, value);
+  if (response_headers->EnumerateHeader(nullptr, "last-modified", &value))
+    headers->SetHeader(net::HttpRequestHeaders::kIfModifiedSince, value);
+}
+
+ProtocolResponseCache::ProtocolResponseCache()
+    : entries_(decltype(entries_)::NO_AUTO_EVICT),
+      disk_cache_(nullptr, base::OnTaskRunnerDeleter(nullptr)) {}
+
+ProtocolResponseCache::~ProtocolResponseCache() = default;
+
+void ProtocolResponseCache::Enable(const Options& options) {
+  if (disk_cache_ && options.disk_path != options_->disk_path)
+    ResetDiskCache();
+
+  options_ = options;
+  entries_.Clear();
+  total_size_ = 0;
+  if (options.disk_path.empty())
+    return;
+
+  if (!disk_task_runner_) {
+    disk_task_runner_ = base::ThreadPool::CreateSequencedTaskRunner(
+        {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+         base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN});
+  }
+  if (disk_cache_) {
+    disk_task_runner_->PostTask(
+        FROM_HERE, base::BindOnce(&DiskCache::SetMaxSize,
+                                  base::Unretained(disk_cache_.get()),
+                                  options.max_disk_size));
+    return;
+  }
+  disk_cache_ = std::unique_ptr<DiskCache, base::OnTaskRunnerDeleter>(
+      new DiskCache(options.disk_path, options.max_disk_size),
+      base::OnTaskRunnerDeleter(disk_task_runner_));
+  disk_task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&DiskCache::Init, base::Unretained(disk_cache_.get())));
+}
+
+void ProtocolResponseCache::Disable() {
+  ResetDiskCache();
+  options_.reset();
+  entries_.Clear();
+  total_size_ = 0;
+}
+
+// static
+bool ProtocolResponseCache::IsCacheableRequest(
+    const network::ResourceRequest& request) {
+  return request.method == net::HttpRequestHeaders::kGetMethod &&
+         !request.request_body &&
+         !request.headers.HasHeader(net::HttpRequestHeaders::kRange) &&
+         !(request.load_flags & net::LOAD_DISABLE_CACHE) &&
+         !HasDirective(request.headers, net::HttpRequestHeaders::kCacheControl,
+                       "no-store");
+}
+
+// static
+bool ProtocolResponseCache::IsNoCacheRequest(
+    const network::ResourceRequest& request) {
+  return (request.load_flags &
+          (net::LOAD_BYPASS_CACHE | net::LOAD_VALIDATE_CACHE)) ||
+         HasDirective(request.headers, net::HttpRequestHeaders::kCacheControl,
+                      "no-cache") ||
+         HasDirective(request.headers, net::HttpRequestHeaders::kPragma,
+                      "no-cache");
+}
+
+std::string ProtocolResponseCache::GetKey(
+    const network::ResourceRequest& request) const {
+  std::string key = request.url.spec();
+  if (!options_)
+    return key;
+  for (const auto& name : options_->vary_headers) {
+    std::string value;
+    request.headers.GetHeader(name, &value);
+    key += "\n" + name + ":" + value;
+  }
+  return key;
+}
+
+bool ProtocolResponseCache::IsCacheableResponse(
+    const network::mojom::URLResponseHead& head) const {
+  if (!options_ || !head.headers)
+    return false;
+
+  const net::HttpResponseHeaders& headers = *head.headers;
+  if (headers.response_code() != net::HTTP_OK ||
+      headers.HasHeaderValue("cache-control", "no-store"))
+    return false;
+
+  return GetFreshness(headers, base::Time::Now()) > base::TimeDelta() ||
+         HasValidator(headers);
+}
+
+void ProtocolResponseCache::Lookup(const std::string& key,
+                                   LookupCallback callback) {
+  if (!options_) {
+    std::move(callback).Run(nullptr);
+    return;
+  }
+
+  auto iter = entries_.Get(key);
+  if (iter != entries_.end()) {
+    if (iter->second->IsUsable()) {
+      std::move(callback).Run(iter->second);
+      return;
+    }
+    // Expired without a way to revalidate it.
+    Remove(key);
+  }
+
+  if (!disk_cache_) {
+    std::move(callback).Run(nullptr);
+    return;
+  }
+
+  base::PostTaskAndReplyWithResult(
+      disk_task_runner_.get(), FROM_HERE,
+      base::BindOnce(&DiskCache::Read, base::Unretained(disk_cache_.get()),
+                     base::MD5String(key)),
+      base::BindOnce(&ProtocolResponseCache::OnReadFromDisk,
+                     base::WrapRefCounted(this), key, std::move(callback)));
+}
+
+void ProtocolResponseCache::Store(const std::string& key,
+                                  const network::mojom::URLResponseHead& head,
+                                  scoped_refptr<base::RefCountedMemory> body) {
+  if (!IsCacheableResponse(head) || body->size() > options_->max_size)
+    return;
+
+  base::Time now = base::Time::Now();
+  auto entry = base::MakeRefCounted<Entry>();
+  entry->raw_headers = head.headers->raw_headers();
+  entry->mime_type = head.mime_type;
+  entry->charset = head.charset;
+  entry->expiration_time = now + GetFreshness(*head.headers, now);
+  entry->body = std::move(body);
+  Insert(key, entry);
+  WriteToDisk(key, entry);
+}
+
+scoped_refptr<ProtocolResponseCache::Entry> ProtocolResponseCache::Refresh(
+    const std::string& key,
+    scoped_refptr<Entry> entry,
+    const net::HttpResponseHeaders& headers) {
+  // The entry may be read on the disk sequence, so it is replaced rather than
+  // updated in place.
+  scoped_refptr<net::HttpResponseHeaders> merged =
+      MergeNotModifiedHeaders(entry->raw_headers, headers);
+  base::Time now = base::Time::Now();
+  auto refreshed = base::MakeRefCounted<Entry>();
+  refreshed->raw_headers = merged->raw_headers();
+  refreshed->mime_type = entry->mime_type;
+  refreshed->charset = entry->charset;
+  refreshed->expiration_time = now + GetFreshness(*merged, now);
+  refreshed->body = entry->body;
+
+  if (options_) {
+    Insert(key, refreshed);
+    WriteToDisk(key, refreshed);
+  }
+  return refreshed;
+}
+
+void ProtocolResponseCache::OnReadFromDisk(const std::string& key,
+                                           LookupCallback callback,
+                                           scoped_refptr<Entry> entry) {
+  if (entry && options_)
+    Insert(key, entry);
+  std::move(callback).Run(std::move(entry));
+}
+
+void ProtocolResponseCache::Insert(const std::string& key,
+                                   scoped_refptr<Entry> entry) {
+  auto iter = entries_.Peek(key);
+  if (iter != entries_.end()) {
+    total_size_ -= iter->second->body->size();
+    entries_.Erase(iter);
+  }
+
+  total_size_ += entry->body->size();
+  entries_.Put(key, std::move(entry));
+
+  while (total_size_ > options_->max_size && !entries_.empty()) {
+    auto last = entries_.rbegin();
+    total_size_ -= last->second->body->size();
+    entries_.Erase(last);
+  }
+}
+
+void ProtocolResponseCache::Remove(const std::string& key) {
+  auto iter = entries_.Peek(key);
+  if (iter != entries_.end()) {
+    total_size_ -= iter->second->body->size();
+    entries_.Erase(iter);
+  }
+  if (disk_cache_) {
+    disk_task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&DiskCache::Remove, base::Unretained(disk_cache_.get()),
+                       base::MD5String(key)));
+  }
+}
+
+void ProtocolResponseCache::WriteToDisk(const std::string& key,
+                                        scoped_refptr<Entry> entry) {
+  if (!disk_cache_)
+    return;
+  // Entries are not changed once stored, Refresh() replaces them.
+  disk_task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&DiskCache::Write, base::Unretained(disk_cache_.get()),
+                     base::MD5String(key), entry));
+}
+
+void ProtocolResponseCache::ResetDiskCache() {
+  if (!disk_cache_)
+    return;
+  disk_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&DiskCache::DeleteAll,
+                                base::Unretained(disk_cache_.get())));
+  disk_cache_.reset();
+}
+
+}  // namespace electron
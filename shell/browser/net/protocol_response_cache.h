@@ -0,0 +1,152 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
+#define SHELL_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/optional.h"
+#include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+
+namespace net {
+class HttpRequestHeaders;
+class HttpResponseHeaders;
+}  // namespace net
+
+namespace network {
+struct ResourceRequest;
+}
+
+namespace electron {
+
+// An opt-in cache of the responses of a custom protocol handler, so repeated
+// requests for the same resource can be served without calling into JS.
+//
+// Entries live in a memory LRU bounded by size, and optionally in a directory
+// on disk that survives restarts, which is an LRU with its own size bound.
+// Freshness follows the Cache-Control and Expires headers of the handler's
+// response, and stale entries that have an ETag or Last-Modified header are
+// revalidated by calling the handler with If-None-Match and If-Modified-Since
+// request headers; a 304 response then serves the cached body. Expired
+// entries that cannot be revalidated are deleted when they are looked up.
+class ProtocolResponseCache
+    : public base::RefCounted<ProtocolResponseCache> {
+ public:
+  struct Options {
+    Options();
+    Options(const Options&);
+    ~Options();
+
+    // The maximum size of the bodies kept in memory.
+    size_t max_size = 32 * 1024 * 1024;
+    // Request headers that are part of the cache key.
+    std::vector<std::string> vary_headers;
+    // Where entries are persisted, empty to only cache in memory.
+    base::FilePath disk_path;
+    // The maximum size of the files kept in |disk_path|.
+    size_t max_disk_size = 128 * 1024 * 1024;
+  };
+
+  class Entry : public base::RefCountedThreadSafe<Entry> {
+   public:
+    Entry();
+
+    // Creates a new response head for serving this entry.
+    network::mojom::URLResponseHeadPtr CreateResponseHead() const;
+
+    bool IsFresh() const;
+    // Whether the entry can still be served, either because it is fresh or
+    // because it can be revalidated.
+    bool IsUsable() const;
+    // Adds the conditional request headers for revalidating this entry.
+    void AddValidationHeaders(net::HttpRequestHeaders* headers) const;
+
+    std::string raw_headers;
+    std::string mime_type;
+    std::string charset;
+    base::Time expiration_time;
+    scoped_refptr<base::RefCountedMemory> body;
+
+   private:
+    friend class base::RefCountedThreadSafe<Entry>;
+    ~Entry();
+
+    DISALLOW_COPY_AND_ASSIGN(Entry);
+  };
+
+  using LookupCallback = base::OnceCallback<void(scoped_refptr<Entry>)>;
+
+  ProtocolResponseCache();
+
+  void Enable(const Options& options);
+  void Disable();
+  bool enabled() const { return options_.has_value(); }
+
+  // Only bodiless GET requests without a Range header or "no-store" are
+  // cached.
+  static bool IsCacheableRequest(const network::ResourceRequest& request);
+  // Whether the cached entry must not be used for |request|, because it asks
+  // for an end-to-end reload with "no-cache". Its response is still stored.
+  static bool IsNoCacheRequest(const network::ResourceRequest& request);
+  std::string GetKey(const network::ResourceRequest& request) const;
+
+  // Whether the headers of |head| allow storing it, checked before copying the
+  // body of the response.
+  bool IsCacheableResponse(const network::mojom::URLResponseHead& head) const;
+  size_t max_size() const { return options_ ? options_->max_size : 0; }
+
+  // Runs |callback| with the entry for |key|, or nullptr when there is none.
+  // Runs synchronously unless the entry has to be read from disk.
+  void Lookup(const std::string& key, LookupCallback callback);
+
+  // Stores a response of the handler, if its headers and size allow it.
+  void Store(const std::string& key,
+             const network::mojom::URLResponseHead& head,
+             scoped_refptr<base::RefCountedMemory> body);
+
+  // Renews |entry| after the handler answered a revalidation with a 304
+  // response carrying |headers|, which are merged into the stored ones.
+  // Returns the renewed entry.
+  scoped_refptr<Entry> Refresh(const std::string& key,
+                               scoped_refptr<Entry> entry,
+                               const net::HttpResponseHeaders& headers);
+
+ private:
+  friend class base::RefCounted<ProtocolResponseCache>;
+  ~ProtocolResponseCache();
+
+  // The files of |Options::disk_path|, lives on |disk_task_runner_|.
+  class DiskCache;
+
+  void OnReadFromDisk(const std::string& key,
+                      LookupCallback callback,
+                      scoped_refptr<Entry> entry);
+  void Insert(const std::string& key, scoped_refptr<Entry> entry);
+  void Remove(const std::string& key);
+  void WriteToDisk(const std::string& key, scoped_refptr<Entry> entry);
+  // Deletes the files of the disk cache, if any, and stops using it.
+  void ResetDiskCache();
+
+  base::Optional<Options> options_;
+  base::MRUCache<std::string, scoped_refptr<Entry>> entries_;
+  size_t total_size_ = 0;
+  scoped_refptr<base::SequencedTaskRunner> disk_task_runner_;
+  std::unique_ptr<DiskCache, base::OnTaskRunnerDeleter> disk_cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProtocolResponseCache);
+};
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_NET_PROTOCOL_RESPONSE_CACHE_H_
@@ -139,8 +139,14 @@ void ProxyingURLLoaderFactory::InProgressRequest::RestartInternal() {
                             weak_factory_.GetWeakPtr());
   }
   redirect_url_ = GURL();
-  int result = factory_->web_request_api()->OnBeforeRequest(
-      &info_.value(), request_, continuation, &redirect_url_);
+  // Declarative rules are applied first, requests they block or redirect are
+  // not passed to the onBeforeRequest listener.
+  int result = factory_->web_request_api()->GetRules().OnBeforeRequest(
+      info_.value(), &redirect_url_);
+  if (result == net::OK && redirect_url_.is_empty()) {
+    result = factory_->web_request_api()->OnBeforeRequest(
+        &info_.value(), request_, continuation, &redirect_url_);
+  }
   if (result == net::ERR_BLOCKED_BY_CLIENT) {
     // The request was cancelled synchronously. Dispatch an error notification
     // and terminate the request.
@@ -396,6 +402,13 @@ void ProxyingURLLoaderFactory::InProgressRequest::ContinueToBeforeSendHeaders(
   if (proxied_client_receiver_.is_bound())
     proxied_client_receiver_.Resume();
 
+  std::set<std::string> removed_headers;
+  std::set<std::string> set_headers;
+  factory_->web_request_api()->GetRules().OnBeforeSendHeaders(
+      info_.value(), &request_.headers, &removed_headers, &set_headers);
+  if (pending_follow_redirect_params_)
+    AddPendingHeaderChanges(removed_headers, set_headers);
+
   auto continuation = base::BindRepeating(
       &InProgressRequest::ContinueToSendHeaders, weak_factory_.GetWeakPtr());
   // Note: In Electron onBeforeSendHeaders is called for all protocols.
@@ -439,19 +452,7 @@ void ProxyingURLLoaderFactory::InProgressRequest::ContinueToSendHeaders(
     std::move(on_before_send_headers_callback_)
         .Run(error_code, request_.headers);
   } else if (pending_follow_redirect_params_) {
-    pending_follow_redirect_params_->removed_headers.insert(
-        pending_follow_redirect_params_->removed_headers.end(),
-        removed_headers.begin(), removed_headers.end());
-
-    for (auto& set_header : set_headers) {
-      std::string header_value;
-      if (request_.headers.GetHeader(set_header, &header_value)) {
-        pending_follow_redirect_params_->modified_headers.SetHeader(
-            set_header, header_value);
-      } else {
-        NOTREACHED();
-      }
-    }
+    AddPendingHeaderChanges(removed_headers, set_headers);
 
     if (target_loader_.is_bound()) {
       target_loader_->FollowRedirect(
@@ -475,6 +476,24 @@ void ProxyingURLLoaderFactory::InProgressRequest::ContinueToSendHeaders(
     ContinueToStartRequest(net::OK);
 }
 
+void ProxyingURLLoaderFactory::InProgressRequest::AddPendingHeaderChanges(
+    const std::set<std::string>& removed_headers,
+    const std::set<std::string>& set_headers) {
+  pending_follow_redirect_params_->removed_headers.insert(
+      pending_follow_redirect_params_->removed_headers.end(),
+      removed_headers.begin(), removed_headers.end());
+
+  for (auto& set_header : set_headers) {
+    std::string header_value;
+    if (request_.headers.GetHeader(set_header, &header_value)) {
+      pending_follow_redirect_params_->modified_headers.SetHeader(
+          set_header, header_value);
+    } else {
+      NOTREACHED();
+    }
+  }
+}
+
 void ProxyingURLLoaderFactory::InProgressRequest::ContinueToStartRequest(
     int error_code) {
   if (error_code != net::OK) {
@@ -699,6 +718,11 @@ void ProxyingURLLoaderFactory::InProgressRequest::
 
   info_->AddResponseInfoFromResourceResponse(*current_response_);
 
+  // A listener that returns |responseHeaders| replaces the headers produced by
+  // the declarative rules.
+  factory_->web_request_api()->GetRules().OnHeadersReceived(
+      info_.value(), current_response_->headers.get(), &override_headers_);
+
   net::CompletionRepeatingCallback copyable_callback =
       base::AdaptCallbackForRepeating(std::move(continuation));
   DCHECK(info_.has_value());
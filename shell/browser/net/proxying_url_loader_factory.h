@@ -105,6 +105,8 @@ class ProxyingURLLoaderFactory
     void ContinueToSendHeaders(const std::set<std::string>& removed_headers,
                                const std::set<std::string>& set_headers,
                                int error_code);
+    void AddPendingHeaderChanges(const std::set<std::string>& removed_headers,
+                                 const std::set<std::string>& set_headers);
     void ContinueToStartRequest(int error_code);
     void ContinueToHandleOverrideHeaders(int error_code);
     void ContinueToResponseStarted(int error_code);
@@ -14,6 +14,7 @@
 #include "extensions/browser/extension_navigation_ui_data.h"
 #include "net/base/ip_endpoint.h"
 #include "net/http/http_util.h"
+#include "shell/browser/net/websocket_frame_interceptor.h"
 
 namespace electron {
 
@@ -161,6 +162,15 @@ void ProxyingWebSocket::ContinueToCompleted() {
   DCHECK(forwarding_handshake_client_);
   DCHECK(is_done_);
   web_request_api_->OnCompleted(&info_, request_, net::ERR_WS_UPGRADE);
+
+  WebSocketFrameMonitor* monitor = web_request_api_->GetWebSocketFrameMonitor();
+  if (monitor->IsEnabled()) {
+    WebSocketFrameInterceptor::Intercept(
+        base::WrapRefCounted(monitor), info_.id, info_.url,
+        info_.render_process_id, info_.frame_id, &websocket_,
+        &client_receiver_, &readable_, &writable_);
+  }
+
   forwarding_handshake_client_->OnConnectionEstablished(
       std::move(websocket_), std::move(client_receiver_),
       std::move(handshake_response_), std::move(readable_),
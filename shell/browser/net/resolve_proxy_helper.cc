@@ -4,98 +4,223 @@
 
 #include "shell/browser/net/resolve_proxy_helper.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "base/bind.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/storage_partition.h"
 #include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/receiver.h"
 #include "net/proxy_resolution/proxy_info.h"
 #include "services/network/public/mojom/network_context.mojom.h"
+#include "services/network/public/mojom/proxy_lookup_client.mojom.h"
 #include "shell/browser/electron_browser_context.h"
 
 using content::BrowserThread;
 
 namespace electron {
 
+namespace {
+
+// Bounds the memory used by the cache.
+constexpr size_t kMaxCacheSize = 1000;
+
+// Strips the parts of |url| the proxy resolution never looks at, the same way
+// the network service does before running PAC scripts, so the URLs sharing a
+// key always resolve to the same proxy.
+GURL GetLookupKey(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearUsername();
+  replacements.ClearPassword();
+  replacements.ClearRef();
+  if (url.SchemeIsCryptographic()) {
+    replacements.ClearPath();
+    replacements.ClearQuery();
+  }
+  return url.ReplaceComponents(replacements);
+}
+
+// Collects the results of ResolveProxies() in the order of the URLs.
+class ProxyBatch : public base::RefCounted<ProxyBatch> {
+ public:
+  ProxyBatch(size_t size, ResolveProxyHelper::ResolveProxiesCallback callback)
+      : results_(size), remaining_(size), callback_(std::move(callback)) {}
+
+  void SetResult(size_t index, std::string proxy) {
+    results_[index] = std::move(proxy);
+    if (--remaining_ == 0)
+      std::move(callback_).Run(std::move(results_));
+  }
+
+ private:
+  friend class base::RefCounted<ProxyBatch>;
+  ~ProxyBatch() = default;
+
+  std::vector<std::string> results_;
+  size_t remaining_;
+  ResolveProxyHelper::ResolveProxiesCallback callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProxyBatch);
+};
+
+}  // namespace
+
+class ResolveProxyHelper::ProxyLookup
+    : public network::mojom::ProxyLookupClient {
+ public:
+  ProxyLookup(ResolveProxyHelper* helper, const GURL& url, int generation)
+      : helper_(helper), url_(url), generation_(generation) {}
+
+  void Start(network::mojom::NetworkContext* network_context) {
+    start_time_ = base::TimeTicks::Now();
+    mojo::PendingRemote<network::mojom::ProxyLookupClient>
+        proxy_lookup_client = receiver_.BindNewPipeAndPassRemote();
+    receiver_.set_disconnect_handler(base::BindOnce(
+        &ProxyLookup::OnProxyLookupComplete, base::Unretained(this),
+        net::ERR_ABORTED, base::nullopt));
+    network_context->LookUpProxyForURL(url_, net::NetworkIsolationKey::Todo(),
+                                       std::move(proxy_lookup_client));
+  }
+
+  void AddCallback(ResolveProxyCallback callback) {
+    callbacks_.push_back(std::move(callback));
+  }
+
+  // network::mojom::ProxyLookupClient implementation.
+  void OnProxyLookupComplete(
+      int32_t net_error,
+      const base::Optional<net::ProxyInfo>& proxy_info) override {
+    std::string proxy;
+    if (proxy_info)
+      proxy = proxy_info->ToPacString();
+
+    // |this| is destroyed by the helper.
+    auto callbacks = std::move(callbacks_);
+    helper_->OnProxyLookupComplete(url_, generation_,
+                                   base::TimeTicks::Now() - start_time_,
+                                   net_error == net::OK, proxy);
+    for (auto& callback : callbacks)
+      std::move(callback).Run(proxy);
+  }
+
+ private:
+  ResolveProxyHelper* helper_;
+  GURL url_;
+  int generation_;
+  base::TimeTicks start_time_;
+  std::vector<ResolveProxyCallback> callbacks_;
+  mojo::Receiver<network::mojom::ProxyLookupClient> receiver_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(ProxyLookup);
+};
+
 ResolveProxyHelper::ResolveProxyHelper(ElectronBrowserContext* browser_context)
-    : browser_context_(browser_context) {}
+    : cache_(kMaxCacheSize), browser_context_(browser_context) {}
 
 ResolveProxyHelper::~ResolveProxyHelper() {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
-  DCHECK(!owned_self_);
-  DCHECK(!receiver_.is_bound());
   // Clear all pending requests if the ProxyService is still alive.
-  pending_requests_.clear();
+  lookups_.clear();
 }
 
 void ResolveProxyHelper::ResolveProxy(const GURL& url,
                                       ResolveProxyCallback callback) {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
-  // Enqueue the pending request.
-  pending_requests_.emplace_back(url, std::move(callback));
+  const GURL key = GetLookupKey(url);
+  if (!cache_ttl_.is_zero()) {
+    auto cached = cache_.Get(key);
+    if (cached != cache_.end()) {
+      if (base::TimeTicks::Now() < cached->second.expiration_time) {
+        metrics_.cache_hit_count++;
+        std::move(callback).Run(cached->second.proxy);
+        return;
+      }
+      cache_.Erase(cached);
+    }
+  }
 
-  // If nothing is in progress, start.
-  if (!receiver_.is_bound()) {
-    DCHECK_EQ(1u, pending_requests_.size());
-    StartPendingRequest();
+  // Requests with the same key share the lookup in progress, the others are
+  // looked up in parallel.
+  auto& lookup = lookups_[key];
+  if (lookup) {
+    lookup->AddCallback(std::move(callback));
+    return;
   }
-}
 
-void ResolveProxyHelper::StartPendingRequest() {
-  DCHECK_CURRENTLY_ON(BrowserThread::UI);
-  DCHECK(!receiver_.is_bound());
-  DCHECK(!pending_requests_.empty());
-
-  // Start the request.
-  mojo::PendingRemote<network::mojom::ProxyLookupClient> proxy_lookup_client =
-      receiver_.BindNewPipeAndPassRemote();
-  receiver_.set_disconnect_handler(
-      base::BindOnce(&ResolveProxyHelper::OnProxyLookupComplete,
-                     base::Unretained(this), net::ERR_ABORTED, base::nullopt));
-  content::BrowserContext::GetDefaultStoragePartition(browser_context_)
-      ->GetNetworkContext()
-      ->LookUpProxyForURL(pending_requests_.front().url,
-                          net::NetworkIsolationKey::Todo(),
-                          std::move(proxy_lookup_client));
+  lookup = std::make_unique<ProxyLookup>(this, key, cache_generation_);
+  lookup->AddCallback(std::move(callback));
+  lookup->Start(content::BrowserContext::GetDefaultStoragePartition(
+                    browser_context_)
+                    ->GetNetworkContext());
 }
 
-void ResolveProxyHelper::OnProxyLookupComplete(
-    int32_t net_error,
-    const base::Optional<net::ProxyInfo>& proxy_info) {
-  DCHECK_CURRENTLY_ON(BrowserThread::UI);
-  DCHECK(!pending_requests_.empty());
+void ResolveProxyHelper::ResolveProxies(const std::vector<GURL>& urls,
+                                        ResolveProxiesCallback callback) {
+  if (urls.empty()) {
+    std::move(callback).Run({});
+    return;
+  }
 
-  receiver_.reset();
+  auto batch =
+      base::MakeRefCounted<ProxyBatch>(urls.size(), std::move(callback));
+  for (size_t i = 0; i < urls.size(); ++i)
+    ResolveProxy(urls[i], base::BindOnce(&ProxyBatch::SetResult, batch, i));
+}
 
-  // Clear the current (completed) request.
-  PendingRequest completed_request = std::move(pending_requests_.front());
-  pending_requests_.pop_front();
+void ResolveProxyHelper::SetCacheTTL(base::TimeDelta ttl) {
+  cache_ttl_ = ttl;
+  ClearCache();
+}
 
-  std::string proxy;
-  if (proxy_info)
-    proxy = proxy_info->ToPacString();
+void ResolveProxyHelper::ClearCache() {
+  cache_.Clear();
+  // Lookups in progress may have used the old configuration.
+  cache_generation_++;
+}
 
-  if (!completed_request.callback.is_null())
-    std::move(completed_request.callback).Run(proxy);
+void ResolveProxyHelper::ReloadProxyConfig(base::OnceClosure callback) {
+  ClearCache();
+  pending_config_changes_++;
+  // The pref store notifies the proxy config monitor asynchronously, so the
+  // reload is sent after it had a chance to forward the new configuration.
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE,
+      base::BindOnce(&ResolveProxyHelper::SendReloadProxyConfig,
+                     base::RetainedRef(this), std::move(callback)));
+}
 
-  // Start the next request.
-  if (!pending_requests_.empty())
-    StartPendingRequest();
+void ResolveProxyHelper::SendReloadProxyConfig(base::OnceClosure callback) {
+  content::BrowserContext::GetDefaultStoragePartition(browser_context_)
+      ->GetNetworkContext()
+      ->ForceReloadProxyConfig(
+          base::BindOnce(&ResolveProxyHelper::OnProxyConfigReloaded,
+                         base::RetainedRef(this), std::move(callback)));
 }
 
-ResolveProxyHelper::PendingRequest::PendingRequest(
-    const GURL& url,
-    ResolveProxyCallback callback)
-    : url(url), callback(std::move(callback)) {}
+void ResolveProxyHelper::OnProxyConfigReloaded(base::OnceClosure callback) {
+  pending_config_changes_--;
+  ClearCache();
+  std::move(callback).Run();
+}
 
-ResolveProxyHelper::PendingRequest::PendingRequest(
-    ResolveProxyHelper::PendingRequest&& pending_request) = default;
+void ResolveProxyHelper::OnProxyLookupComplete(const GURL& key,
+                                               int generation,
+                                               base::TimeDelta elapsed,
+                                               bool succeeded,
+                                               const std::string& proxy) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  metrics_.lookup_count++;
+  metrics_.total_time += elapsed;
+  metrics_.max_time = std::max(metrics_.max_time, elapsed);
+  metrics_.last_time = elapsed;
 
-ResolveProxyHelper::PendingRequest::~PendingRequest() noexcept = default;
+  if (succeeded && !cache_ttl_.is_zero() && generation == cache_generation_ &&
+      pending_config_changes_ == 0)
+    cache_.Put(key, {proxy, base::TimeTicks::Now() + cache_ttl_});
 
-ResolveProxyHelper::PendingRequest&
-ResolveProxyHelper::PendingRequest::operator=(
-    ResolveProxyHelper::PendingRequest&& pending_request) noexcept = default;
+  lookups_.erase(key);
+}
 
 }  // namespace electron
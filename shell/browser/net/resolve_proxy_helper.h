@@ -5,13 +5,15 @@
 #ifndef SHELL_BROWSER_NET_RESOLVE_PROXY_HELPER_H_
 #define SHELL_BROWSER_NET_RESOLVE_PROXY_HELPER_H_
 
-#include <deque>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/optional.h"
-#include "mojo/public/cpp/bindings/receiver.h"
-#include "services/network/public/mojom/proxy_lookup_client.mojom.h"
+#include "base/time/time.h"
 #include "url/gurl.h"
 
 namespace electron {
@@ -19,50 +21,77 @@ namespace electron {
 class ElectronBrowserContext;
 
 class ResolveProxyHelper
-    : public base::RefCountedThreadSafe<ResolveProxyHelper>,
-      network::mojom::ProxyLookupClient {
+    : public base::RefCountedThreadSafe<ResolveProxyHelper> {
  public:
   using ResolveProxyCallback = base::OnceCallback<void(std::string)>;
+  using ResolveProxiesCallback =
+      base::OnceCallback<void(std::vector<std::string>)>;
+
+  // Statistics of the lookups sent to the network service. The times are
+  // measured from the UI thread, so they include the IPC round trip besides
+  // the resolution itself.
+  struct Metrics {
+    uint64_t lookup_count = 0;
+    uint64_t cache_hit_count = 0;
+    base::TimeDelta total_time;
+    base::TimeDelta max_time;
+    base::TimeDelta last_time;
+  };
 
   explicit ResolveProxyHelper(ElectronBrowserContext* browser_context);
 
   void ResolveProxy(const GURL& url, ResolveProxyCallback callback);
+  void ResolveProxies(const std::vector<GURL>& urls,
+                      ResolveProxiesCallback callback);
+
+  // Results are cached for |ttl| per URL, as seen by PAC scripts, a zero |ttl|
+  // disables the cache.
+  void SetCacheTTL(base::TimeDelta ttl);
+  // Called when the proxy configuration may have changed.
+  void ClearCache();
+  // Called after the proxy configuration of the session was changed. Makes the
+  // network service reload it, and runs |callback| once it did. Nothing is
+  // cached until then, as lookups may still use the old configuration.
+  void ReloadProxyConfig(base::OnceClosure callback);
+
+  const Metrics& metrics() const { return metrics_; }
 
  protected:
   ~ResolveProxyHelper() override;
 
  private:
   friend class base::RefCountedThreadSafe<ResolveProxyHelper>;
-  // A PendingRequest is a resolve request that is in progress, or queued.
-  struct PendingRequest {
-   public:
-    PendingRequest(const GURL& url, ResolveProxyCallback callback);
-    PendingRequest(PendingRequest&& pending_request) noexcept;
-    ~PendingRequest();
 
-    PendingRequest& operator=(PendingRequest&& pending_request) noexcept;
+  // A lookup in progress, shared by the requests with the same key.
+  class ProxyLookup;
 
-    GURL url;
-    ResolveProxyCallback callback;
-
-   private:
-    DISALLOW_COPY_AND_ASSIGN(PendingRequest);
+  struct CachedProxy {
+    std::string proxy;
+    base::TimeTicks expiration_time;
   };
 
-  // Starts the first pending request.
-  void StartPendingRequest();
+  // Called by |ProxyLookup| before it is destroyed.
+  void OnProxyLookupComplete(const GURL& key,
+                             int generation,
+                             base::TimeDelta elapsed,
+                             bool succeeded,
+                             const std::string& proxy);
+
+  void SendReloadProxyConfig(base::OnceClosure callback);
+  void OnProxyConfigReloaded(base::OnceClosure callback);
 
-  // network::mojom::ProxyLookupClient implementation.
-  void OnProxyLookupComplete(
-      int32_t net_error,
-      const base::Optional<net::ProxyInfo>& proxy_info) override;
+  // Both are keyed by GetLookupKey().
+  std::map<GURL, std::unique_ptr<ProxyLookup>> lookups_;
 
-  // Self-reference. Owned as long as there's an outstanding proxy lookup.
-  scoped_refptr<ResolveProxyHelper> owned_self_;
+  base::TimeDelta cache_ttl_;
+  base::MRUCache<GURL, CachedProxy> cache_;
+  // Incremented when the cache is cleared.
+  int cache_generation_ = 0;
+  // The number of configuration changes the network service has not reloaded
+  // yet.
+  int pending_config_changes_ = 0;
 
-  std::deque<PendingRequest> pending_requests_;
-  // Receiver for the currently in-progress request, if any.
-  mojo::Receiver<network::mojom::ProxyLookupClient> receiver_{this};
+  Metrics metrics_;
 
   // Weak Ref
   ElectronBrowserContext* browser_context_;
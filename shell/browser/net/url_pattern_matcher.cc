@@ -0,0 +1,92 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/net/url_pattern_matcher.h"
+
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
+#include "url/gurl.h"
+#include "url/url_constants.h"
+
+namespace electron {
+
+namespace {
+
+// URLPattern ignores a trailing dot on both sides when comparing hosts, and
+// GURL hosts are always lowercase.
+std::string HostKey(base::StringPiece host) {
+  if (base::EndsWith(host, "."))
+    host.remove_suffix(1);
+  return base::ToLowerASCII(host);
+}
+
+}  // namespace
+
+URLPatternMatcher::URLPatternMatcher() = default;
+
+URLPatternMatcher::URLPatternMatcher(const std::set<URLPattern>& patterns)
+    : patterns_(patterns.begin(), patterns.end()) {
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    const URLPattern& pattern = patterns_[i];
+    // URLPattern ignores the host of file: URLs, so file: patterns have to be
+    // tested against UNC URLs like "file://server/share" too.
+    if (pattern.match_all_urls() || pattern.MatchesScheme(url::kFileScheme) ||
+        (pattern.match_subdomains() && pattern.host().empty())) {
+      any_host_.push_back(i);
+    } else if (pattern.match_subdomains()) {
+      domains_[HostKey(pattern.host())].push_back(i);
+    } else {
+      hosts_[HostKey(pattern.host())].push_back(i);
+    }
+  }
+}
+
+URLPatternMatcher::URLPatternMatcher(const URLPatternMatcher&) = default;
+URLPatternMatcher::URLPatternMatcher(URLPatternMatcher&&) = default;
+URLPatternMatcher& URLPatternMatcher::operator=(const URLPatternMatcher&) =
+    default;
+URLPatternMatcher& URLPatternMatcher::operator=(URLPatternMatcher&&) = default;
+URLPatternMatcher::~URLPatternMatcher() = default;
+
+bool URLPatternMatcher::MatchesURL(const GURL& url) const {
+  if (MatchesAny(any_host_, url))
+    return true;
+
+  // URLPattern matches filesystem: URLs against their inner URL.
+  const GURL* host_url = &url;
+  if (url.SchemeIsFileSystem() && url.inner_url())
+    host_url = url.inner_url();
+  const std::string host = HostKey(host_url->host_piece());
+
+  auto iter = hosts_.find(host);
+  if (iter != hosts_.end() && MatchesAny(iter->second, url))
+    return true;
+
+  if (domains_.empty())
+    return false;
+
+  // Walk "a.b.example.com", "b.example.com", "example.com", "com".
+  base::StringPiece domain(host);
+  while (true) {
+    iter = domains_.find(domain.as_string());
+    if (iter != domains_.end() && MatchesAny(iter->second, url))
+      return true;
+    size_t dot = domain.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    domain.remove_prefix(dot + 1);
+  }
+  return false;
+}
+
+bool URLPatternMatcher::MatchesAny(const Bucket& bucket,
+                                   const GURL& url) const {
+  for (size_t index : bucket) {
+    if (patterns_[index].MatchesURL(url))
+      return true;
+  }
+  return false;
+}
+
+}  // namespace electron
@@ -0,0 +1,60 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_NET_URL_PATTERN_MATCHER_H_
+#define SHELL_BROWSER_NET_URL_PATTERN_MATCHER_H_
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace electron {
+
+// Matches URLs against a set of URLPatterns without trying every pattern.
+//
+// The patterns are bucketed by host when the matcher is built, so a lookup
+// only has to test the patterns whose host can match the URL: those with the
+// exact same host, those matching subdomains of one of the URL's parent
+// domains, and those matching any host. The candidates are then tested with
+// URLPattern::MatchesURL, so the result is always the same as testing every
+// pattern.
+class URLPatternMatcher {
+ public:
+  URLPatternMatcher();
+  explicit URLPatternMatcher(const std::set<URLPattern>& patterns);
+  URLPatternMatcher(const URLPatternMatcher&);
+  URLPatternMatcher(URLPatternMatcher&&);
+  URLPatternMatcher& operator=(const URLPatternMatcher&);
+  URLPatternMatcher& operator=(URLPatternMatcher&&);
+  ~URLPatternMatcher();
+
+  bool empty() const { return patterns_.empty(); }
+
+  // Returns whether any of the patterns matches |url|.
+  bool MatchesURL(const GURL& url) const;
+
+ private:
+  using Bucket = std::vector<size_t>;
+
+  bool MatchesAny(const Bucket& bucket, const GURL& url) const;
+
+  std::vector<URLPattern> patterns_;
+
+  // Patterns keyed by their host, for patterns that match the host only.
+  std::unordered_map<std::string, Bucket> hosts_;
+  // Patterns keyed by their host, for patterns that also match subdomains.
+  std::unordered_map<std::string, Bucket> domains_;
+  // Patterns that match every host, e.g. "<all_urls>" or "*://*/*", and the
+  // file: patterns.
+  Bucket any_host_;
+};
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_NET_URL_PATTERN_MATCHER_H_
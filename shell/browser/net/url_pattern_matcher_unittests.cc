@@ -0,0 +1,107 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/net/url_pattern_matcher.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace electron {
+
+namespace {
+
+std::set<URLPattern> ParsePatterns(const std::vector<std::string>& patterns) {
+  std::set<URLPattern> result;
+  for (const auto& pattern : patterns) {
+    URLPattern url_pattern(URLPattern::SCHEME_ALL);
+    EXPECT_EQ(URLPattern::ParseResult::kSuccess, url_pattern.Parse(pattern))
+        << pattern;
+    result.insert(url_pattern);
+  }
+  return result;
+}
+
+// What the matcher has to return, testing every pattern.
+bool MatchesAnyPattern(const std::set<URLPattern>& patterns, const GURL& url) {
+  for (const auto& pattern : patterns) {
+    if (pattern.MatchesURL(url))
+      return true;
+  }
+  return false;
+}
+
+const char* const kURLs[] = {
+    "http://example.com/",
+    "https://example.com/path?query",
+    "http://EXAMPLE.com./",
+    "http://www.example.com/",
+    "https://a.b.example.com/",
+    "http://notexample.com/",
+    "http://example.org/",
+    "http://127.0.0.1/",
+    "ws://example.com/socket",
+    "file:///home/user/file.txt",
+    "file:///tmp/",
+    "file://server/share/file.txt",
+    "filesystem:http://example.com/temporary/file",
+    "filesystem:http://www.example.com/persistent/file",
+    "filesystem:http://example.org/temporary/file",
+    "data:text/plain,hello",
+    "about:blank",
+};
+
+void ExpectSameAsURLPattern(const std::vector<std::string>& pattern_strings) {
+  std::set<URLPattern> patterns = ParsePatterns(pattern_strings);
+  URLPatternMatcher matcher(patterns);
+  for (const char* spec : kURLs) {
+    GURL url(spec);
+    EXPECT_EQ(MatchesAnyPattern(patterns, url), matcher.MatchesURL(url))
+        << spec;
+  }
+}
+
+}  // namespace
+
+TEST(URLPatternMatcherTest, Empty) {
+  URLPatternMatcher matcher;
+  EXPECT_TRUE(matcher.empty());
+  EXPECT_FALSE(matcher.MatchesURL(GURL("http://example.com/")));
+}
+
+TEST(URLPatternMatcherTest, AllURLs) {
+  ExpectSameAsURLPattern({"<all_urls>"});
+  ExpectSameAsURLPattern({"*://*/*"});
+}
+
+TEST(URLPatternMatcherTest, Hosts) {
+  ExpectSameAsURLPattern({"http://example.com/*"});
+  ExpectSameAsURLPattern({"*://example.com/path*", "https://example.org/*"});
+  ExpectSameAsURLPattern({"http://example.com./*", "http://127.0.0.1/*"});
+}
+
+TEST(URLPatternMatcherTest, Subdomains) {
+  ExpectSameAsURLPattern({"*://*.example.com/*"});
+  ExpectSameAsURLPattern({"http://*.b.example.com/*", "http://*.com/*"});
+  ExpectSameAsURLPattern({"http://*.0.0.1/*"});
+}
+
+// URLPattern ignores the host of file: URLs, so "file:///*" matches UNC URLs
+// like "file://server/share/file.txt".
+TEST(URLPatternMatcherTest, File) {
+  ExpectSameAsURLPattern({"file:///*"});
+  ExpectSameAsURLPattern({"file:///home/*", "http://example.com/*"});
+  ExpectSameAsURLPattern({"file://server/*"});
+}
+
+TEST(URLPatternMatcherTest, FileSystem) {
+  ExpectSameAsURLPattern({"filesystem:http://example.com/*"});
+  ExpectSameAsURLPattern({"http://example.com/*"});
+  ExpectSameAsURLPattern({"*://*.example.com/*"});
+}
+
+}  // namespace electron
@@ -11,6 +11,8 @@
 #include "extensions/browser/api/web_request/web_request_info.h"
 #include "net/base/completion_once_callback.h"
 #include "services/network/public/cpp/resource_request.h"
+#include "shell/browser/net/web_request_rules.h"
+#include "shell/browser/net/websocket_frame_monitor.h"
 
 namespace electron {
 
@@ -25,6 +27,8 @@ class WebRequestAPI {
                               int error_code)>;
 
   virtual bool HasListener() const = 0;
+  virtual const WebRequestRules& GetRules() const = 0;
+  virtual WebSocketFrameMonitor* GetWebSocketFrameMonitor() = 0;
   virtual int OnBeforeRequest(extensions::WebRequestInfo* info,
                               const network::ResourceRequest& request,
                               net::CompletionOnceCallback callback,
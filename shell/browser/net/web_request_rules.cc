@@ -0,0 +1,141 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/net/web_request_rules.h"
+
+#include <utility>
+
+#include "base/stl_util.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+
+namespace electron {
+
+namespace {
+
+// The resource types exposed to JavaScript, everything else is "other".
+extensions::WebRequestResourceType NormalizeResourceType(
+    extensions::WebRequestResourceType type) {
+  switch (type) {
+    case extensions::WebRequestResourceType::MAIN_FRAME:
+    case extensions::WebRequestResourceType::SUB_FRAME:
+    case extensions::WebRequestResourceType::STYLESHEET:
+    case extensions::WebRequestResourceType::SCRIPT:
+    case extensions::WebRequestResourceType::IMAGE:
+    case extensions::WebRequestResourceType::OBJECT:
+    case extensions::WebRequestResourceType::XHR:
+      return type;
+    default:
+      return extensions::WebRequestResourceType::OTHER;
+  }
+}
+
+}  // namespace
+
+WebRequestRule::WebRequestRule() = default;
+WebRequestRule::WebRequestRule(const WebRequestRule&) = default;
+WebRequestRule& WebRequestRule::operator=(const WebRequestRule&) = default;
+WebRequestRule::~WebRequestRule() = default;
+
+bool WebRequestRule::Matches(const extensions::WebRequestInfo& info) const {
+  if (!methods.empty() && !base::Contains(methods, info.method))
+    return false;
+
+  if (!resource_types.empty() &&
+      !base::Contains(resource_types,
+                      NormalizeResourceType(info.web_request_type)))
+    return false;
+
+  return url_patterns.empty() || url_patterns.MatchesURL(info.url);
+}
+
+WebRequestRules::WebRequestRules() = default;
+WebRequestRules::~WebRequestRules() = default;
+
+void WebRequestRules::SetRules(std::vector<WebRequestRule> rules) {
+  request_rules_.clear();
+  request_header_rules_.clear();
+  response_header_rules_.clear();
+  for (auto& rule : rules) {
+    if (rule.action != WebRequestRule::Action::kModifyHeaders) {
+      request_rules_.push_back(std::move(rule));
+      continue;
+    }
+    if (!rule.set_request_headers.empty() ||
+        !rule.remove_request_headers.empty())
+      request_header_rules_.push_back(rule);
+    if (!rule.set_response_headers.empty() ||
+        !rule.remove_response_headers.empty())
+      response_header_rules_.push_back(std::move(rule));
+  }
+}
+
+bool WebRequestRules::empty() const {
+  return request_rules_.empty() && request_header_rules_.empty() &&
+         response_header_rules_.empty();
+}
+
+int WebRequestRules::OnBeforeRequest(const extensions::WebRequestInfo& info,
+                                     GURL* new_url) const {
+  for (const auto& rule : request_rules_) {
+    if (!rule.Matches(info))
+      continue;
+    if (rule.action == WebRequestRule::Action::kBlock)
+      return net::ERR_BLOCKED_BY_CLIENT;
+    // Do not redirect a request that has already been redirected by this
+    // rule, otherwise a pattern matching the target would loop forever.
+    if (rule.redirect_url != info.url)
+      *new_url = rule.redirect_url;
+    return net::OK;
+  }
+  return net::OK;
+}
+
+void WebRequestRules::OnBeforeSendHeaders(
+    const extensions::WebRequestInfo& info,
+    net::HttpRequestHeaders* headers,
+    std::set<std::string>* removed_headers,
+    std::set<std::string>* set_headers) const {
+  for (const auto& rule : request_header_rules_) {
+    if (!rule.Matches(info))
+      continue;
+    for (const auto& name : rule.remove_request_headers) {
+      if (!headers->HasHeader(name))
+        continue;
+      headers->RemoveHeader(name);
+      removed_headers->insert(name);
+      set_headers->erase(name);
+    }
+    for (const auto& header : rule.set_request_headers) {
+      headers->SetHeader(header.first, header.second);
+      set_headers->insert(header.first);
+      removed_headers->erase(header.first);
+    }
+  }
+}
+
+void WebRequestRules::OnHeadersReceived(
+    const extensions::WebRequestInfo& info,
+    const net::HttpResponseHeaders* original_response_headers,
+    scoped_refptr<net::HttpResponseHeaders>* override_response_headers) const {
+  if (!original_response_headers)
+    return;
+
+  for (const auto& rule : response_header_rules_) {
+    if (!rule.Matches(info))
+      continue;
+    if (!*override_response_headers) {
+      *override_response_headers =
+          base::MakeRefCounted<net::HttpResponseHeaders>(
+              original_response_headers->raw_headers());
+    }
+    for (const auto& name : rule.remove_response_headers)
+      (*override_response_headers)->RemoveHeader(name);
+    for (const auto& header : rule.set_response_headers)
+      (*override_response_headers)->SetHeader(header.first, header.second);
+  }
+}
+
+}  // namespace electron
@@ -0,0 +1,98 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_NET_WEB_REQUEST_RULES_H_
+#define SHELL_BROWSER_NET_WEB_REQUEST_RULES_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+#include "extensions/browser/api/web_request/web_request_info.h"
+#include "extensions/browser/api/web_request/web_request_resource_type.h"
+#include "shell/browser/net/url_pattern_matcher.h"
+#include "url/gurl.h"
+
+namespace net {
+class HttpRequestHeaders;
+class HttpResponseHeaders;
+}  // namespace net
+
+namespace electron {
+
+// A declarative webRequest rule, set with |webRequest.setRules|.
+struct WebRequestRule {
+  enum class Action {
+    kBlock,
+    kRedirect,
+    kModifyHeaders,
+  };
+
+  WebRequestRule();
+  WebRequestRule(const WebRequestRule&);
+  WebRequestRule& operator=(const WebRequestRule&);
+  ~WebRequestRule();
+
+  // Returns whether the request described by |info| satisfies all conditions.
+  bool Matches(const extensions::WebRequestInfo& info) const;
+
+  // Conditions, an empty set matches every request.
+  URLPatternMatcher url_patterns;
+  std::set<extensions::WebRequestResourceType> resource_types;
+  std::set<std::string> methods;
+
+  Action action = Action::kBlock;
+  GURL redirect_url;
+  std::map<std::string, std::string> set_request_headers;
+  std::set<std::string> remove_request_headers;
+  std::map<std::string, std::string> set_response_headers;
+  std::set<std::string> remove_response_headers;
+};
+
+// The compiled form of the declarative rules, evaluated by the
+// ProxyingURLLoaderFactory before any JavaScript listener is consulted.
+class WebRequestRules {
+ public:
+  WebRequestRules();
+  ~WebRequestRules();
+
+  void SetRules(std::vector<WebRequestRule> rules);
+  bool empty() const;
+
+  // Returns net::ERR_BLOCKED_BY_CLIENT if the first matching block or redirect
+  // rule blocks the request, otherwise net::OK with |new_url| set when the
+  // rule redirects it.
+  int OnBeforeRequest(const extensions::WebRequestInfo& info,
+                      GURL* new_url) const;
+
+  // Applies the request header changes of all matching rules to |headers|,
+  // recording the names of the headers that were removed and set.
+  void OnBeforeSendHeaders(const extensions::WebRequestInfo& info,
+                           net::HttpRequestHeaders* headers,
+                           std::set<std::string>* removed_headers,
+                           std::set<std::string>* set_headers) const;
+
+  // Sets |override_response_headers| to a modified copy of
+  // |original_response_headers| when a matching rule changes them.
+  void OnHeadersReceived(
+      const extensions::WebRequestInfo& info,
+      const net::HttpResponseHeaders* original_response_headers,
+      scoped_refptr<net::HttpResponseHeaders>* override_response_headers) const;
+
+ private:
+  // Rules are split by the stage they act in, so that each stage only walks
+  // the rules that can affect it. Each list keeps the order of |setRules|.
+  std::vector<WebRequestRule> request_rules_;
+  std::vector<WebRequestRule> request_header_rules_;
+  std::vector<WebRequestRule> response_header_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebRequestRules);
+};
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_NET_WEB_REQUEST_RULES_H_
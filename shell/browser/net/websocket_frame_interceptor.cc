@@ -0,0 +1,559 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/net/websocket_frame_interceptor.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/auto_reset.h"
+#include "base/bind.h"
+#include "base/containers/circular_deque.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+#include "mojo/public/cpp/system/simple_watcher.h"
+
+namespace electron {
+
+namespace {
+
+// The capacity of the data pipes between the renderer and the interceptor.
+constexpr uint32_t kDataPipeCapacity = 64 * 1024;
+
+// Larger messages are forwarded without being passed to the handler, which
+// bounds the memory used to collect a message.
+constexpr size_t kMaxFilteredMessageSize = 1024 * 1024;
+
+}  // namespace
+
+// The pending endpoints, passed from the UI thread to the IO thread.
+struct WebSocketFrameInterceptor::Endpoints {
+  mojo::PendingReceiver<network::mojom::WebSocket> renderer_websocket;
+  mojo::PendingRemote<network::mojom::WebSocket> network_websocket;
+  mojo::PendingReceiver<network::mojom::WebSocketClient> network_client;
+  mojo::PendingRemote<network::mojom::WebSocketClient> renderer_client;
+
+  // Only set when the data is relayed.
+  mojo::ScopedDataPipeConsumerHandle network_readable;
+  mojo::ScopedDataPipeProducerHandle renderer_readable;
+  mojo::ScopedDataPipeConsumerHandle renderer_writable;
+  mojo::ScopedDataPipeProducerHandle network_writable;
+};
+
+// Relays the frames of one direction from a source data pipe to a destination
+// data pipe.
+//
+// Messages are forwarded frame by frame, unless the handler wants them, in
+// which case the frames of the message are collected and the message passed to
+// the handler is forwarded as a single frame. Control messages are queued
+// behind the frames so they keep their order.
+class WebSocketFrameInterceptor::MessageRelay {
+ public:
+  using EmitCallback =
+      base::RepeatingCallback<void(bool fin,
+                                   network::mojom::WebSocketMessageType type,
+                                   uint64_t data_length)>;
+
+  MessageRelay(WebSocketFrameInterceptor* owner,
+               WebSocketFrameMonitor::Direction direction,
+               mojo::ScopedDataPipeConsumerHandle source,
+               mojo::ScopedDataPipeProducerHandle destination,
+               EmitCallback emit)
+      : owner_(owner),
+        direction_(direction),
+        source_(std::move(source)),
+        destination_(std::move(destination)),
+        emit_(std::move(emit)),
+        source_watcher_(FROM_HERE, mojo::SimpleWatcher::ArmingPolicy::MANUAL),
+        destination_watcher_(FROM_HERE,
+                             mojo::SimpleWatcher::ArmingPolicy::MANUAL) {
+    source_watcher_.Watch(source_.get(), MOJO_HANDLE_SIGNAL_READABLE,
+                          base::BindRepeating(&MessageRelay::OnPipeReady,
+                                              base::Unretained(this)));
+    destination_watcher_.Watch(destination_.get(), MOJO_HANDLE_SIGNAL_WRITABLE,
+                               base::BindRepeating(&MessageRelay::OnPipeReady,
+                                                   base::Unretained(this)));
+  }
+
+  // Queues a frame of |data_length| bytes written to the source pipe.
+  void OnFrame(bool fin,
+               network::mojom::WebSocketMessageType type,
+               uint64_t data_length) {
+    items_.push_back({fin, type, data_length, base::OnceClosure()});
+    Pump();
+  }
+
+  // Runs |closure| once the frames queued before it are forwarded.
+  void OnControl(base::OnceClosure closure) {
+    items_.push_back({true, network::mojom::WebSocketMessageType::CONTINUATION,
+                      0, std::move(closure)});
+    Pump();
+  }
+
+ private:
+  struct Item {
+    bool fin;
+    network::mojom::WebSocketMessageType type;
+    uint64_t data_length;
+    base::OnceClosure control;
+  };
+
+  void Pump() {
+    // The handler may reply synchronously while the loop below is running.
+    if (in_pump_)
+      return;
+    base::AutoReset<bool> in_pump(&in_pump_, true);
+    while (!waiting_for_handler_ && !failed_) {
+      if (pending_offset_ < pending_.size()) {
+        if (!WritePending())
+          return;
+        continue;
+      }
+      if (has_frame_) {
+        if (remaining_ > 0) {
+          if (!(collecting_ ? CollectData() : ForwardData()))
+            return;
+          continue;
+        }
+        has_frame_ = false;
+        if (collecting_ && frame_fin_)
+          FinishMessage();
+        continue;
+      }
+      if (items_.empty())
+        return;
+
+      Item item = std::move(items_.front());
+      items_.pop_front();
+      if (item.control)
+        std::move(item.control).Run();
+      else
+        StartFrame(item);
+    }
+  }
+
+  void StartFrame(const Item& item) {
+    has_frame_ = true;
+    frame_fin_ = item.fin;
+    remaining_ = item.data_length;
+    if (!in_message_) {
+      message_type_ = item.type;
+      collecting_ = item.data_length <= kMaxFilteredMessageSize &&
+                    owner_->WantsMessages();
+    }
+    in_message_ = !item.fin;
+    if (!collecting_)
+      emit_.Run(item.fin, item.type, item.data_length);
+  }
+
+  // Copies the current frame from the source to the destination.
+  bool ForwardData() {
+    const void* in = nullptr;
+    uint32_t readable = 0;
+    MojoResult rv =
+        source_->BeginReadData(&in, &readable, MOJO_READ_DATA_FLAG_NONE);
+    if (rv == MOJO_RESULT_SHOULD_WAIT) {
+      source_watcher_.ArmOrNotify();
+      return false;
+    } else if (rv != MOJO_RESULT_OK) {
+      return Fail();
+    }
+
+    void* out = nullptr;
+    uint32_t writable = 0;
+    rv = destination_->BeginWriteData(&out, &writable,
+                                      MOJO_WRITE_DATA_FLAG_NONE);
+    if (rv == MOJO_RESULT_SHOULD_WAIT) {
+      // Leave the data in the source pipe until the destination has room.
+      source_->EndReadData(0);
+      destination_watcher_.ArmOrNotify();
+      return false;
+    } else if (rv != MOJO_RESULT_OK) {
+      source_->EndReadData(0);
+      return Fail();
+    }
+
+    uint32_t size = static_cast<uint32_t>(
+        std::min<uint64_t>(std::min(readable, writable), remaining_));
+    memcpy(out, in, size);
+    destination_->EndWriteData(size);
+    source_->EndReadData(size);
+    remaining_ -= size;
+    return true;
+  }
+
+  // Appends the current frame to |message_|.
+  bool CollectData() {
+    const void* in = nullptr;
+    uint32_t readable = 0;
+    MojoResult rv =
+        source_->BeginReadData(&in, &readable, MOJO_READ_DATA_FLAG_NONE);
+    if (rv == MOJO_RESULT_SHOULD_WAIT) {
+      source_watcher_.ArmOrNotify();
+      return false;
+    } else if (rv != MOJO_RESULT_OK) {
+      return Fail();
+    }
+
+    uint32_t size =
+        static_cast<uint32_t>(std::min<uint64_t>(readable, remaining_));
+    message_.append(static_cast<const char*>(in), size);
+    source_->EndReadData(size);
+    remaining_ -= size;
+
+    if (message_.size() > kMaxFilteredMessageSize) {
+      // The message is fragmented and too large, forward what was collected
+      // and the rest of the message as it comes.
+      collecting_ = false;
+      emit_.Run(false, message_type_, message_.size());
+      SetPending(std::move(message_));
+      if (remaining_ > 0 || frame_fin_) {
+        emit_.Run(frame_fin_,
+                  network::mojom::WebSocketMessageType::CONTINUATION,
+                  remaining_);
+      }
+    }
+    return true;
+  }
+
+  void FinishMessage() {
+    collecting_ = false;
+    waiting_for_handler_ = true;
+    owner_->Dispatch(direction_, message_type_, std::move(message_),
+                     base::BindOnce(&MessageRelay::OnHandlerResult,
+                                    weak_factory_.GetWeakPtr()));
+    message_.clear();
+  }
+
+  void OnHandlerResult(bool cancel, std::string data) {
+    waiting_for_handler_ = false;
+    if (!cancel) {
+      emit_.Run(true, message_type_, data.size());
+      SetPending(std::move(data));
+    }
+    Pump();
+  }
+
+  void SetPending(std::string data) {
+    pending_ = std::move(data);
+    pending_offset_ = 0;
+  }
+
+  // Writes |pending_| to the destination.
+  bool WritePending() {
+    void* out = nullptr;
+    uint32_t writable = 0;
+    MojoResult rv = destination_->BeginWriteData(&out, &writable,
+                                                 MOJO_WRITE_DATA_FLAG_NONE);
+    if (rv == MOJO_RESULT_SHOULD_WAIT) {
+      destination_watcher_.ArmOrNotify();
+      return false;
+    } else if (rv != MOJO_RESULT_OK) {
+      return Fail();
+    }
+
+    uint32_t size = static_cast<uint32_t>(
+        std::min<size_t>(writable, pending_.size() - pending_offset_));
+    memcpy(out, pending_.data() + pending_offset_, size);
+    destination_->EndWriteData(size);
+    pending_offset_ += size;
+    if (pending_offset_ == pending_.size())
+      SetPending(std::string());
+    return true;
+  }
+
+  // One of the pipes is closed, the connection is going away.
+  bool Fail() {
+    failed_ = true;
+    owner_->Close(0u, std::string());
+    return false;
+  }
+
+  void OnPipeReady(MojoResult result, const mojo::HandleSignalsState& state) {
+    Pump();
+  }
+
+  WebSocketFrameInterceptor* owner_;
+  WebSocketFrameMonitor::Direction direction_;
+  mojo::ScopedDataPipeConsumerHandle source_;
+  mojo::ScopedDataPipeProducerHandle destination_;
+  EmitCallback emit_;
+  mojo::SimpleWatcher source_watcher_;
+  mojo::SimpleWatcher destination_watcher_;
+
+  base::circular_deque<Item> items_;
+
+  // The frame being read from the source.
+  bool has_frame_ = false;
+  bool frame_fin_ = false;
+  uint64_t remaining_ = 0;
+
+  // The message being read from the source.
+  bool in_message_ = false;
+  bool collecting_ = false;
+  network::mojom::WebSocketMessageType message_type_ =
+      network::mojom::WebSocketMessageType::CONTINUATION;
+  std::string message_;
+
+  // Data being written to the destination.
+  std::string pending_;
+  size_t pending_offset_ = 0;
+
+  bool in_pump_ = false;
+  bool waiting_for_handler_ = false;
+  bool failed_ = false;
+
+  base::WeakPtrFactory<MessageRelay> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(MessageRelay);
+};
+
+// static
+void WebSocketFrameInterceptor::Intercept(
+    scoped_refptr<WebSocketFrameMonitor> monitor,
+    uint64_t connection_id,
+    const GURL& url,
+    int process_id,
+    int frame_id,
+    mojo::PendingRemote<network::mojom::WebSocket>* websocket,
+    mojo::PendingReceiver<network::mojom::WebSocketClient>* client_receiver,
+    mojo::ScopedDataPipeConsumerHandle* readable,
+    mojo::ScopedDataPipeProducerHandle* writable) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto endpoints = std::make_unique<Endpoints>();
+  endpoints->network_websocket = std::move(*websocket);
+  endpoints->renderer_websocket = websocket->InitWithNewPipeAndPassReceiver();
+  endpoints->network_client = std::move(*client_receiver);
+  *client_receiver =
+      endpoints->renderer_client.InitWithNewPipeAndPassReceiver();
+
+  if (monitor->MatchesURL(url)) {
+    MojoCreateDataPipeOptions options;
+    options.struct_size = sizeof(MojoCreateDataPipeOptions);
+    options.flags = MOJO_CREATE_DATA_PIPE_FLAG_NONE;
+    options.element_num_bytes = 1;
+    options.capacity_num_bytes = kDataPipeCapacity;
+
+    mojo::ScopedDataPipeConsumerHandle renderer_readable;
+    mojo::ScopedDataPipeProducerHandle renderer_writable;
+    if (mojo::CreateDataPipe(&options, &endpoints->renderer_readable,
+                             &renderer_readable) == MOJO_RESULT_OK &&
+        mojo::CreateDataPipe(&options, &renderer_writable,
+                             &endpoints->renderer_writable) == MOJO_RESULT_OK) {
+      endpoints->network_readable = std::move(*readable);
+      endpoints->network_writable = std::move(*writable);
+      *readable = std::move(renderer_readable);
+      *writable = std::move(renderer_writable);
+    } else {
+      // Fall back to counting the frames only.
+      endpoints->renderer_readable.reset();
+      endpoints->renderer_writable.reset();
+    }
+  }
+
+  monitor->AddConnection(connection_id, url);
+  content::GetIOThreadTaskRunner({})->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebSocketFrameInterceptor::Create, std::move(monitor),
+                     connection_id, url, process_id, frame_id,
+                     std::move(endpoints)));
+}
+
+// static
+void WebSocketFrameInterceptor::Create(
+    scoped_refptr<WebSocketFrameMonitor> monitor,
+    uint64_t connection_id,
+    const GURL& url,
+    int process_id,
+    int frame_id,
+    std::unique_ptr<Endpoints> endpoints) {
+  // Deletes itself when the connection is closed.
+  new WebSocketFrameInterceptor(std::move(monitor), connection_id, url,
+                                process_id, frame_id, std::move(endpoints));
+}
+
+WebSocketFrameInterceptor::WebSocketFrameInterceptor(
+    scoped_refptr<WebSocketFrameMonitor> monitor,
+    uint64_t connection_id,
+    const GURL& url,
+    int process_id,
+    int frame_id,
+    std::unique_ptr<Endpoints> endpoints)
+    : monitor_(std::move(monitor)),
+      connection_id_(connection_id),
+      url_(url),
+      process_id_(process_id),
+      frame_id_(frame_id),
+      network_websocket_(std::move(endpoints->network_websocket)),
+      renderer_client_(std::move(endpoints->renderer_client)) {
+  renderer_websocket_.Bind(std::move(endpoints->renderer_websocket));
+  network_client_.Bind(std::move(endpoints->network_client));
+
+  if (endpoints->network_readable) {
+    send_relay_ = std::make_unique<MessageRelay>(
+        this, WebSocketFrameMonitor::Direction::kSend,
+        std::move(endpoints->renderer_writable),
+        std::move(endpoints->network_writable),
+        base::BindRepeating(&WebSocketFrameInterceptor::SendToNetwork,
+                            base::Unretained(this)));
+    receive_relay_ = std::make_unique<MessageRelay>(
+        this, WebSocketFrameMonitor::Direction::kReceive,
+        std::move(endpoints->network_readable),
+        std::move(endpoints->renderer_readable),
+        base::BindRepeating(&WebSocketFrameInterceptor::SendToRenderer,
+                            base::Unretained(this)));
+  }
+
+  renderer_websocket_.set_disconnect_handler(
+      base::BindOnce(&WebSocketFrameInterceptor::Close, base::Unretained(this),
+                     0u, std::string()));
+  renderer_client_.set_disconnect_handler(
+      base::BindOnce(&WebSocketFrameInterceptor::Close, base::Unretained(this),
+                     0u, std::string()));
+  network_websocket_.set_disconnect_with_reason_handler(
+      base::BindOnce(&WebSocketFrameInterceptor::OnNetworkDisconnect,
+                     base::Unretained(this)));
+  network_client_.set_disconnect_handler(
+      base::BindOnce(&WebSocketFrameInterceptor::OnNetworkDisconnect,
+                     base::Unretained(this), 0u, std::string()));
+}
+
+WebSocketFrameInterceptor::~WebSocketFrameInterceptor() {
+  monitor_->RemoveConnection(connection_id_);
+}
+
+void WebSocketFrameInterceptor::SendMessage(
+    network::mojom::WebSocketMessageType type,
+    uint64_t data_length) {
+  monitor_->RecordFrame(connection_id_, WebSocketFrameMonitor::Direction::kSend,
+                        data_length);
+  if (send_relay_)
+    send_relay_->OnFrame(true, type, data_length);
+  else
+    network_websocket_->SendMessage(type, data_length);
+}
+
+void WebSocketFrameInterceptor::StartReceiving() {
+  network_websocket_->StartReceiving();
+}
+
+void WebSocketFrameInterceptor::StartClosingHandshake(
+    uint16_t code,
+    const std::string& reason) {
+  if (send_relay_) {
+    send_relay_->OnControl(base::BindOnce(
+        &network::mojom::WebSocket::StartClosingHandshake,
+        base::Unretained(network_websocket_.get()), code, reason));
+  } else {
+    network_websocket_->StartClosingHandshake(code, reason);
+  }
+}
+
+void WebSocketFrameInterceptor::OnDataFrame(
+    bool fin,
+    network::mojom::WebSocketMessageType type,
+    uint64_t data_length) {
+  monitor_->RecordFrame(connection_id_,
+                        WebSocketFrameMonitor::Direction::kReceive,
+                        data_length);
+  if (receive_relay_)
+    receive_relay_->OnFrame(fin, type, data_length);
+  else
+    renderer_client_->OnDataFrame(fin, type, data_length);
+}
+
+void WebSocketFrameInterceptor::OnDropChannel(bool was_clean,
+                                              uint16_t code,
+                                              const std::string& reason) {
+  if (receive_relay_) {
+    receive_relay_->OnControl(base::BindOnce(
+        &network::mojom::WebSocketClient::OnDropChannel,
+        base::Unretained(renderer_client_.get()), was_clean, code, reason));
+  } else {
+    renderer_client_->OnDropChannel(was_clean, code, reason);
+  }
+}
+
+void WebSocketFrameInterceptor::OnClosingHandshake() {
+  if (receive_relay_) {
+    receive_relay_->OnControl(
+        base::BindOnce(&network::mojom::WebSocketClient::OnClosingHandshake,
+                       base::Unretained(renderer_client_.get())));
+  } else {
+    renderer_client_->OnClosingHandshake();
+  }
+}
+
+bool WebSocketFrameInterceptor::WantsMessages() const {
+  return monitor_->MatchesURL(url_);
+}
+
+void WebSocketFrameInterceptor::Dispatch(
+    WebSocketFrameMonitor::Direction direction,
+    network::mojom::WebSocketMessageType type,
+    std::string data,
+    WebSocketFrameMonitor::ResultCallback callback) {
+  double* sampling_credit =
+      direction == WebSocketFrameMonitor::Direction::kSend
+          ? &send_sampling_credit_
+          : &receive_sampling_credit_;
+  if (!monitor_->ShouldDispatch(direction, data.size(), sampling_credit)) {
+    std::move(callback).Run(false, std::move(data));
+    return;
+  }
+
+  monitor_->RecordFilteredMessage(connection_id_);
+  WebSocketFrameMonitor::Frame frame;
+  frame.connection_id = connection_id_;
+  frame.url = url_;
+  frame.process_id = process_id_;
+  frame.frame_id = frame_id_;
+  frame.direction = direction;
+  frame.type = type;
+  frame.data = std::move(data);
+  monitor_->Dispatch(std::move(frame), std::move(callback));
+}
+
+void WebSocketFrameInterceptor::SendToNetwork(
+    bool fin,
+    network::mojom::WebSocketMessageType type,
+    uint64_t data_length) {
+  // Messages from the renderer are never fragmented.
+  DCHECK(fin);
+  network_websocket_->SendMessage(type, data_length);
+}
+
+void WebSocketFrameInterceptor::SendToRenderer(
+    bool fin,
+    network::mojom::WebSocketMessageType type,
+    uint64_t data_length) {
+  renderer_client_->OnDataFrame(fin, type, data_length);
+}
+
+void WebSocketFrameInterceptor::OnNetworkDisconnect(
+    uint32_t reason,
+    const std::string& description) {
+  // Forward the frames that were received before closing the connection.
+  if (receive_relay_) {
+    receive_relay_->OnControl(base::BindOnce(&WebSocketFrameInterceptor::Close,
+                                             base::Unretained(this), reason,
+                                             description));
+  } else {
+    Close(reason, description);
+  }
+}
+
+void WebSocketFrameInterceptor::Close(uint32_t reason,
+                                      const std::string& description) {
+  if (closing_)
+    return;
+  closing_ = true;
+  if (reason)
+    renderer_websocket_.ResetWithReason(reason, description);
+  base::SequencedTaskRunnerHandle::Get()->DeleteSoon(FROM_HERE, this);
+}
+
+}  // namespace electron
@@ -0,0 +1,127 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_NET_WEBSOCKET_FRAME_INTERCEPTOR_H_
+#define SHELL_BROWSER_NET_WEBSOCKET_FRAME_INTERCEPTOR_H_
+
+#include <memory>
+#include <string>
+
+#include "base/memory/scoped_refptr.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "mojo/public/cpp/system/data_pipe.h"
+#include "services/network/public/mojom/websocket.mojom.h"
+#include "shell/browser/net/websocket_frame_monitor.h"
+#include "url/gurl.h"
+
+namespace electron {
+
+// Sits between the renderer and the network service once a WebSocket
+// connection is established, counting the frames and passing the messages
+// that match the filter of the webRequest API to its handler.
+//
+// It lives on the IO thread and only posts to the UI thread for the messages
+// that are passed to the handler. When the connection does not match the
+// filter, the data pipes of the network service are handed to the renderer
+// untouched and only the frame notifications go through the interceptor.
+// Otherwise the data is relayed between two pairs of data pipes, reading from
+// one side only when the other side can take the data, so the flow control of
+// the pipes is preserved.
+class WebSocketFrameInterceptor : public network::mojom::WebSocket,
+                                  public network::mojom::WebSocketClient {
+ public:
+  // Replaces the endpoints of an established connection that are passed to
+  // the renderer with the ones of a new interceptor. Called on the UI thread.
+  static void Intercept(
+      scoped_refptr<WebSocketFrameMonitor> monitor,
+      uint64_t connection_id,
+      const GURL& url,
+      int process_id,
+      int frame_id,
+      mojo::PendingRemote<network::mojom::WebSocket>* websocket,
+      mojo::PendingReceiver<network::mojom::WebSocketClient>* client_receiver,
+      mojo::ScopedDataPipeConsumerHandle* readable,
+      mojo::ScopedDataPipeProducerHandle* writable);
+
+  ~WebSocketFrameInterceptor() override;
+
+  // network::mojom::WebSocket:
+  void SendMessage(network::mojom::WebSocketMessageType type,
+                   uint64_t data_length) override;
+  void StartReceiving() override;
+  void StartClosingHandshake(uint16_t code, const std::string& reason) override;
+
+  // network::mojom::WebSocketClient:
+  void OnDataFrame(bool fin,
+                   network::mojom::WebSocketMessageType type,
+                   uint64_t data_length) override;
+  void OnDropChannel(bool was_clean,
+                     uint16_t code,
+                     const std::string& reason) override;
+  void OnClosingHandshake() override;
+
+ private:
+  struct Endpoints;
+  class MessageRelay;
+
+  WebSocketFrameInterceptor(scoped_refptr<WebSocketFrameMonitor> monitor,
+                            uint64_t connection_id,
+                            const GURL& url,
+                            int process_id,
+                            int frame_id,
+                            std::unique_ptr<Endpoints> endpoints);
+
+  static void Create(scoped_refptr<WebSocketFrameMonitor> monitor,
+                     uint64_t connection_id,
+                     const GURL& url,
+                     int process_id,
+                     int frame_id,
+                     std::unique_ptr<Endpoints> endpoints);
+
+  // Called by the relays.
+  bool WantsMessages() const;
+  void Dispatch(WebSocketFrameMonitor::Direction direction,
+                network::mojom::WebSocketMessageType type,
+                std::string data,
+                WebSocketFrameMonitor::ResultCallback callback);
+  void SendToNetwork(bool fin,
+                     network::mojom::WebSocketMessageType type,
+                     uint64_t data_length);
+  void SendToRenderer(bool fin,
+                      network::mojom::WebSocketMessageType type,
+                      uint64_t data_length);
+
+  void OnNetworkDisconnect(uint32_t reason, const std::string& description);
+  // Deletes |this| soon, so it can be called by the relays.
+  void Close(uint32_t reason, const std::string& description);
+
+  scoped_refptr<WebSocketFrameMonitor> monitor_;
+  uint64_t connection_id_;
+  GURL url_;
+  int process_id_;
+  int frame_id_;
+  bool closing_ = false;
+  // The sampling state of each direction, see
+  // WebSocketFrameMonitor::ShouldDispatch.
+  double send_sampling_credit_ = 0;
+  double receive_sampling_credit_ = 0;
+
+  mojo::Receiver<network::mojom::WebSocket> renderer_websocket_{this};
+  mojo::Remote<network::mojom::WebSocket> network_websocket_;
+  mojo::Receiver<network::mojom::WebSocketClient> network_client_{this};
+  mojo::Remote<network::mojom::WebSocketClient> renderer_client_;
+
+  // Only set when the data is relayed.
+  std::unique_ptr<MessageRelay> send_relay_;
+  std::unique_ptr<MessageRelay> receive_relay_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebSocketFrameInterceptor);
+};
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_NET_WEBSOCKET_FRAME_INTERCEPTOR_H_
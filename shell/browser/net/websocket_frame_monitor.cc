@@ -0,0 +1,163 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/net/websocket_frame_monitor.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+
+namespace electron {
+
+namespace {
+
+// Runs |callback| on |task_runner|.
+void ReplyOnSequence(scoped_refptr<base::SequencedTaskRunner> task_runner,
+                     WebSocketFrameMonitor::ResultCallback callback,
+                     bool cancel,
+                     std::string data) {
+  task_runner->PostTask(FROM_HERE, base::BindOnce(std::move(callback), cancel,
+                                                  std::move(data)));
+}
+
+}  // namespace
+
+WebSocketFrameMonitor::Filter::Filter() = default;
+WebSocketFrameMonitor::Filter::Filter(const Filter&) = default;
+WebSocketFrameMonitor::Filter& WebSocketFrameMonitor::Filter::operator=(
+    const Filter&) = default;
+WebSocketFrameMonitor::Filter::~Filter() = default;
+
+WebSocketFrameMonitor::Frame::Frame() = default;
+WebSocketFrameMonitor::Frame::Frame(Frame&&) = default;
+WebSocketFrameMonitor::Frame& WebSocketFrameMonitor::Frame::operator=(
+    Frame&&) = default;
+WebSocketFrameMonitor::Frame::~Frame() = default;
+
+WebSocketFrameMonitor::WebSocketFrameMonitor() = default;
+
+WebSocketFrameMonitor::~WebSocketFrameMonitor() = default;
+
+void WebSocketFrameMonitor::SetHandler(Filter filter, Handler handler) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  handler_ = std::move(handler);
+  base::AutoLock auto_lock(lock_);
+  filter_ = std::move(filter);
+  has_handler_ = true;
+}
+
+void WebSocketFrameMonitor::ClearHandler() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  handler_.Reset();
+  base::AutoLock auto_lock(lock_);
+  filter_ = Filter();
+  has_handler_ = false;
+}
+
+void WebSocketFrameMonitor::SetStatsEnabled(bool enabled) {
+  base::AutoLock auto_lock(lock_);
+  stats_enabled_ = enabled;
+}
+
+bool WebSocketFrameMonitor::IsEnabled() const {
+  base::AutoLock auto_lock(lock_);
+  return has_handler_ || stats_enabled_;
+}
+
+std::vector<WebSocketFrameMonitor::Stats> WebSocketFrameMonitor::GetStats()
+    const {
+  base::AutoLock auto_lock(lock_);
+  std::vector<Stats> stats;
+  stats.reserve(stats_.size());
+  for (const auto& it : stats_)
+    stats.push_back(it.second);
+  return stats;
+}
+
+bool WebSocketFrameMonitor::MatchesURL(const GURL& url) const {
+  base::AutoLock auto_lock(lock_);
+  return has_handler_ &&
+         (filter_.url_patterns.empty() || filter_.url_patterns.MatchesURL(url));
+}
+
+bool WebSocketFrameMonitor::ShouldDispatch(Direction direction,
+                                           uint64_t size,
+                                           double* sampling_credit) const {
+  base::AutoLock auto_lock(lock_);
+  if (!has_handler_ || size < filter_.min_size)
+    return false;
+  if (!(direction == Direction::kSend ? filter_.send : filter_.receive))
+    return false;
+
+  // Pass every 1/sample_rate-th message, which spreads the samples evenly
+  // without a random number generator.
+  *sampling_credit += filter_.sample_rate;
+  if (*sampling_credit < 1)
+    return false;
+  *sampling_credit -= 1;
+  return true;
+}
+
+void WebSocketFrameMonitor::Dispatch(Frame frame, ResultCallback callback) {
+  content::GetUIThreadTaskRunner({})->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebSocketFrameMonitor::DispatchOnUIThread, this,
+                     std::move(frame),
+                     base::BindOnce(&ReplyOnSequence,
+                                    base::SequencedTaskRunnerHandle::Get(),
+                                    std::move(callback))));
+}
+
+void WebSocketFrameMonitor::DispatchOnUIThread(Frame frame,
+                                               ResultCallback callback) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (!handler_) {
+    std::move(callback).Run(false, std::move(frame.data));
+    return;
+  }
+  handler_.Run(std::move(frame), std::move(callback));
+}
+
+void WebSocketFrameMonitor::AddConnection(uint64_t connection_id,
+                                          const GURL& url) {
+  base::AutoLock auto_lock(lock_);
+  Stats& stats = stats_[connection_id];
+  stats.connection_id = connection_id;
+  stats.url = url;
+  stats.start_time = base::TimeTicks::Now();
+}
+
+void WebSocketFrameMonitor::RemoveConnection(uint64_t connection_id) {
+  base::AutoLock auto_lock(lock_);
+  stats_.erase(connection_id);
+}
+
+void WebSocketFrameMonitor::RecordFrame(uint64_t connection_id,
+                                        Direction direction,
+                                        uint64_t size) {
+  base::AutoLock auto_lock(lock_);
+  auto it = stats_.find(connection_id);
+  if (it == stats_.end())
+    return;
+  Stats& stats = it->second;
+  if (direction == Direction::kSend) {
+    stats.frames_sent++;
+    stats.bytes_sent += size;
+  } else {
+    stats.frames_received++;
+    stats.bytes_received += size;
+  }
+}
+
+void WebSocketFrameMonitor::RecordFilteredMessage(uint64_t connection_id) {
+  base::AutoLock auto_lock(lock_);
+  auto it = stats_.find(connection_id);
+  if (it != stats_.end())
+    it->second.messages_filtered++;
+}
+
+}  // namespace electron
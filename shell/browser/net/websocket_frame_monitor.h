@@ -0,0 +1,132 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_BROWSER_NET_WEBSOCKET_FRAME_MONITOR_H_
+#define SHELL_BROWSER_NET_WEBSOCKET_FRAME_MONITOR_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "services/network/public/mojom/websocket.mojom.h"
+#include "shell/browser/net/url_pattern_matcher.h"
+#include "url/gurl.h"
+
+namespace electron {
+
+// The state shared by the WebSocket frame interceptors of a session, which
+// live on the IO thread, and the webRequest API, which lives on the UI thread.
+class WebSocketFrameMonitor
+    : public base::RefCountedThreadSafe<WebSocketFrameMonitor> {
+ public:
+  enum class Direction {
+    kSend,
+    kReceive,
+  };
+
+  struct Filter {
+    Filter();
+    Filter(const Filter&);
+    Filter& operator=(const Filter&);
+    ~Filter();
+
+    URLPatternMatcher url_patterns;
+    bool send = true;
+    bool receive = true;
+    // Smaller messages are not passed to the handler.
+    uint64_t min_size = 0;
+    // The fraction of the matching messages passed to the handler.
+    double sample_rate = 1;
+  };
+
+  // A complete message passed to the handler.
+  struct Frame {
+    Frame();
+    Frame(Frame&&);
+    Frame& operator=(Frame&&);
+    ~Frame();
+
+    uint64_t connection_id = 0;
+    GURL url;
+    int process_id = 0;
+    int frame_id = 0;
+    Direction direction = Direction::kSend;
+    network::mojom::WebSocketMessageType type =
+        network::mojom::WebSocketMessageType::TEXT;
+    std::string data;
+  };
+
+  struct Stats {
+    uint64_t connection_id = 0;
+    GURL url;
+    base::TimeTicks start_time;
+    uint64_t frames_sent = 0;
+    uint64_t frames_received = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    // Messages passed to the handler.
+    uint64_t messages_filtered = 0;
+  };
+
+  // Called with |cancel| set to drop the message, otherwise with the data to
+  // forward.
+  using ResultCallback = base::OnceCallback<void(bool cancel, std::string)>;
+  using Handler = base::RepeatingCallback<void(Frame, ResultCallback)>;
+
+  WebSocketFrameMonitor();
+
+  // Must be called on the UI thread, |handler| is run on the UI thread.
+  void SetHandler(Filter filter, Handler handler);
+  void ClearHandler();
+  void SetStatsEnabled(bool enabled);
+
+  // Returns whether the WebSocket connections should be intercepted at all.
+  bool IsEnabled() const;
+  std::vector<Stats> GetStats() const;
+
+  // The methods below can be called on any thread.
+
+  // Returns whether the messages of the connection to |url| may have to be
+  // passed to the handler, in which case their data must be relayed instead
+  // of handing the data pipes of the network service to the renderer.
+  bool MatchesURL(const GURL& url) const;
+  // Returns whether a complete message of |size| bytes should be passed to the
+  // handler, |sampling_credit| is the connection's state for the sampling.
+  bool ShouldDispatch(Direction direction,
+                      uint64_t size,
+                      double* sampling_credit) const;
+  // Passes |frame| to the handler, |callback| is run on the calling sequence
+  // with the data unchanged if the handler is gone.
+  void Dispatch(Frame frame, ResultCallback callback);
+
+  void AddConnection(uint64_t connection_id, const GURL& url);
+  void RemoveConnection(uint64_t connection_id);
+  void RecordFrame(uint64_t connection_id, Direction direction, uint64_t size);
+  void RecordFilteredMessage(uint64_t connection_id);
+
+ private:
+  friend class base::RefCountedThreadSafe<WebSocketFrameMonitor>;
+  ~WebSocketFrameMonitor();
+
+  void DispatchOnUIThread(Frame frame, ResultCallback callback);
+
+  mutable base::Lock lock_;
+  bool has_handler_ = false;
+  bool stats_enabled_ = false;
+  Filter filter_;
+  std::map<uint64_t, Stats> stats_;
+
+  // Only accessed on the UI thread.
+  Handler handler_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebSocketFrameMonitor);
+};
+
+}  // namespace electron
+
+#endif  // SHELL_BROWSER_NET_WEBSOCKET_FRAME_MONITOR_H_
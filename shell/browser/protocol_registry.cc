@@ -80,21 +80,42 @@ void ProtocolRegistry::RegisterURLLoaderFactories(
   }
 
   for (const auto& it : handlers_) {
-    factories->emplace(it.first, ElectronURLLoaderFactory::Create(
-                                     it.second.first, it.second.second));
+    auto cache = response_caches_.find(it.first);
+    factories->emplace(
+        it.first, ElectronURLLoaderFactory::Create(
+                      it.second.first, it.second.second,
+                      cache == response_caches_.end() ? nullptr
+                                                      : cache->second));
   }
 }
 
 bool ProtocolRegistry::RegisterProtocol(ProtocolType type,
                                         const std::string& scheme,
                                         const ProtocolHandler& handler) {
-  return base::TryEmplace(handlers_, scheme, type, handler).second;
+  if (!base::TryEmplace(handlers_, scheme, type, handler).second)
+    return false;
+  // Only the bodies of buffer and string responses can be cached.
+  if (type == ProtocolType::kBuffer || type == ProtocolType::kString)
+    response_caches_[scheme] = base::MakeRefCounted<ProtocolResponseCache>();
+  return true;
 }
 
 bool ProtocolRegistry::UnregisterProtocol(const std::string& scheme) {
+  auto iter = response_caches_.find(scheme);
+  if (iter != response_caches_.end()) {
+    // Factories created for the old handler may still hold the cache.
+    iter->second->Disable();
+    response_caches_.erase(iter);
+  }
   return handlers_.erase(scheme) != 0;
 }
 
+ProtocolResponseCache* ProtocolRegistry::GetResponseCache(
+    const std::string& scheme) {
+  auto iter = response_caches_.find(scheme);
+  return iter == response_caches_.end() ? nullptr : iter->second.get();
+}
+
 bool ProtocolRegistry::IsProtocolRegistered(const std::string& scheme) {
   return base::Contains(handlers_, scheme);
 }
@@ -5,10 +5,12 @@
 #ifndef SHELL_BROWSER_PROTOCOL_REGISTRY_H_
 #define SHELL_BROWSER_PROTOCOL_REGISTRY_H_
 
+#include <map>
 #include <string>
 
 #include "content/public/browser/content_browser_client.h"
 #include "shell/browser/net/electron_url_loader_factory.h"
+#include "shell/browser/net/protocol_response_cache.h"
 
 namespace content {
 class BrowserContext;
@@ -37,6 +39,10 @@ class ProtocolRegistry {
   bool UnregisterProtocol(const std::string& scheme);
   bool IsProtocolRegistered(const std::string& scheme);
 
+  // Returns the response cache of the registered protocol |scheme|, or nullptr
+  // if it is not registered as a buffer or string protocol.
+  ProtocolResponseCache* GetResponseCache(const std::string& scheme);
+
   bool InterceptProtocol(ProtocolType type,
                          const std::string& scheme,
                          const ProtocolHandler& handler);
@@ -50,6 +56,10 @@ class ProtocolRegistry {
 
   HandlersMap handlers_;
   HandlersMap intercept_handlers_;
+
+  // scheme => response cache of the registered buffer or string protocol,
+  // disabled by default.
+  std::map<std::string, scoped_refptr<ProtocolResponseCache>> response_caches_;
 };
 
 }  // namespace electron
@@ -6,6 +6,8 @@
 
 #include <dlfcn.h>
 #include <gtk/gtk.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <string>
@@ -14,12 +16,12 @@
 #include "base/bind.h"
 #include "base/environment.h"
 #include "base/files/file_util.h"
-#include "base/hash/md5.h"
 #include "base/memory/ref_counted_memory.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
-#include "base/task/post_task.h"
+#include "base/task/thread_pool.h"
+#include "base/task_runner_util.h"
 #include "content/public/browser/browser_thread.h"
 #include "shell/browser/ui/gtk/app_indicator_icon_menu.h"
 #include "third_party/skia/include/core/SkBitmap.h"
@@ -143,10 +145,53 @@ bool WriteFile(const base::FilePath& path, const SkBitmap& bitmap) {
   return (bytes_written == static_cast<int>(png_data.size()));
 }
 
-void DeleteTempDirectory(const base::FilePath& dir_path) {
-  if (dir_path.empty())
+void DeleteTempPath(const base::FilePath& path) {
+  if (path.empty())
     return;
-  base::DeletePathRecursively(dir_path);
+  base::DeletePathRecursively(path);
+}
+
+// Number of distinct images kept on disk per icon, enough for the frames of a
+// typical tray icon animation.
+constexpr size_t kMaxCachedFrames = 64;
+
+// Creates the directory the images of an icon are written to, unless
+// |icon_dir| was created already. A tmpfs is preferred so that animating an
+// icon does not cause disk writes.
+bool EnsureIconDirectory(base::FilePath* icon_dir) {
+  if (!icon_dir->empty())
+    return true;
+
+  base::FilePath base_dir;
+  std::unique_ptr<base::Environment> env(base::Environment::Create());
+  std::string runtime_dir;
+  if (env->GetVar("XDG_RUNTIME_DIR", &runtime_dir) && !runtime_dir.empty())
+    base_dir = base::FilePath(runtime_dir);
+  else if (!base::GetShmemTempDir(false, &base_dir))
+    base::GetTempDir(&base_dir);
+
+  // The directory gets an unpredictable name and mode 0700, and creating it
+  // fails if anything exists at that path already.
+  base::FilePath dir;
+  if (!base::CreateTemporaryDirInDir(base_dir, "electron_app_indicator_",
+                                     &dir)) {
+    LOG(WARNING) << "Could not create temporary directory";
+    return false;
+  }
+
+  struct stat info;
+  if (lstat(dir.value().c_str(), &info) != 0 || !S_ISDIR(info.st_mode) ||
+      info.st_uid != geteuid() || (info.st_mode & (S_IRWXG | S_IRWXO))) {
+    LOG(WARNING) << "Temporary directory is not private: " << dir.value();
+    return false;
+  }
+
+  *icon_dir = dir;
+  return true;
+}
+
+void DeleteIconDirectory(std::unique_ptr<base::FilePath> icon_dir) {
+  DeleteTempPath(*icon_dir);
 }
 
 }  // namespace
@@ -158,7 +203,15 @@ namespace gtkui {
 AppIndicatorIcon::AppIndicatorIcon(std::string id,
                                    const gfx::ImageSkia& image,
                                    const base::string16& tool_tip)
-    : id_(id), icon_(nullptr), menu_model_(nullptr), icon_change_count_(0) {
+    : id_(id),
+      icon_(nullptr),
+      menu_model_(nullptr),
+      temp_dir_(std::make_unique<base::FilePath>()),
+      icon_change_count_(0),
+      frames_(kMaxCachedFrames),
+      file_task_runner_(base::ThreadPool::CreateSequencedTaskRunner(
+          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+           base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN})) {
   std::unique_ptr<base::Environment> env(base::Environment::Create());
   desktop_env_ = base::nix::GetDesktopEnvironment(env.get());
 
@@ -170,11 +223,10 @@ AppIndicatorIcon::~AppIndicatorIcon() {
   if (icon_) {
     app_indicator_set_status(icon_, APP_INDICATOR_STATUS_PASSIVE);
     g_object_unref(icon_);
-    base::PostTask(
-        FROM_HERE,
-        {base::ThreadPool(), base::MayBlock(), base::TaskPriority::BEST_EFFORT},
-        base::BindOnce(&DeleteTempDirectory, temp_dir_));
   }
+  // Runs after any pending write to the directory.
+  file_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&DeleteIconDirectory, std::move(temp_dir_)));
 }
 
 // static
@@ -193,26 +245,79 @@ void AppIndicatorIcon::SetIcon(const gfx::ImageSkia& image) {
   // another thread.
   SkBitmap safe_bitmap = *image.bitmap();
 
-  const base::TaskTraits kTraits = {
-      base::ThreadPool(), base::MayBlock(), base::TaskPriority::USER_VISIBLE,
-      base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN};
+  // Images that were shown before are still on disk, reuse them instead of
+  // encoding and writing them again. Copies of a bitmap share its generation
+  // ID, which changes whenever its pixels do.
+  uint32_t frame_id = safe_bitmap.getGenerationID();
+  auto it = frames_.Get(frame_id);
+  if (it != frames_.end()) {
+    SetImageFromFile(it->second);
+    return;
+  }
+
+  WriteFrame(safe_bitmap, frame_id, icon_change_count_);
+}
+
+void AppIndicatorIcon::PreloadIcons(const std::vector<gfx::ImageSkia>& images) {
+  if (!g_opened)
+    return;
+
+  for (const auto& image : images) {
+    if (image.isNull())
+      continue;
+    SkBitmap safe_bitmap = *image.bitmap();
+    uint32_t frame_id = safe_bitmap.getGenerationID();
+    if (frames_.Peek(frame_id) == frames_.end())
+      WriteFrame(safe_bitmap, frame_id, -1);
+  }
+}
 
+void AppIndicatorIcon::WriteFrame(const SkBitmap& bitmap,
+                                  uint32_t frame_id,
+                                  int icon_change_count) {
+  // |temp_dir_| is only accessed on |file_task_runner_|, and deleted by a task
+  // posted after this one.
   if (desktop_env_ == base::nix::DESKTOP_ENVIRONMENT_KDE4 ||
       desktop_env_ == base::nix::DESKTOP_ENVIRONMENT_KDE5) {
     base::PostTaskAndReplyWithResult(
-        FROM_HERE, kTraits,
+        file_task_runner_.get(), FROM_HERE,
         base::BindOnce(AppIndicatorIcon::WriteKDE4TempImageOnWorkerThread,
-                       safe_bitmap, temp_dir_),
-        base::BindOnce(&AppIndicatorIcon::SetImageFromFile,
-                       weak_factory_.GetWeakPtr()));
+                       bitmap, base::Unretained(temp_dir_.get()), frame_id),
+        base::BindOnce(&AppIndicatorIcon::OnFrameWritten,
+                       weak_factory_.GetWeakPtr(), frame_id,
+                       icon_change_count));
   } else {
     base::PostTaskAndReplyWithResult(
-        FROM_HERE, kTraits,
+        file_task_runner_.get(), FROM_HERE,
         base::BindOnce(AppIndicatorIcon::WriteUnityTempImageOnWorkerThread,
-                       safe_bitmap, icon_change_count_, id_),
-        base::BindOnce(&AppIndicatorIcon::SetImageFromFile,
-                       weak_factory_.GetWeakPtr()));
+                       bitmap, base::Unretained(temp_dir_.get()), frame_id),
+        base::BindOnce(&AppIndicatorIcon::OnFrameWritten,
+                       weak_factory_.GetWeakPtr(), frame_id,
+                       icon_change_count));
+  }
+}
+
+void AppIndicatorIcon::OnFrameWritten(uint32_t frame_id,
+                                      int icon_change_count,
+                                      const SetImageFromFileParams& params) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (params.icon_theme_path.empty())
+    return;
+
+  if (frames_.Peek(frame_id) == frames_.end()) {
+    if (frames_.size() == kMaxCachedFrames) {
+      auto oldest = frames_.rbegin();
+      file_task_runner_->PostTask(
+          FROM_HERE,
+          base::BindOnce(&DeleteTempPath, oldest->second.frame_path));
+      frames_.Erase(oldest);
+    }
+    frames_.Put(frame_id, params);
   }
+
+  // A newer icon may have been set while this one was being written.
+  if (icon_change_count == icon_change_count_)
+    SetImageFromFile(params);
 }
 
 void AppIndicatorIcon::SetToolTip(const base::string16& tool_tip) {
@@ -241,15 +346,11 @@ void AppIndicatorIcon::RefreshPlatformContextMenu() {
 AppIndicatorIcon::SetImageFromFileParams
 AppIndicatorIcon::WriteKDE4TempImageOnWorkerThread(
     const SkBitmap& bitmap,
-    const base::FilePath& existing_temp_dir) {
-  base::FilePath temp_dir = existing_temp_dir;
-  if (temp_dir.empty() &&
-      !base::CreateNewTempDirectory(base::FilePath::StringType(), &temp_dir)) {
-    LOG(WARNING) << "Could not create temporary directory";
+    base::FilePath* icon_dir,
+    uint32_t frame_id) {
+  if (!EnsureIconDirectory(icon_dir))
     return SetImageFromFileParams();
-  }
-
-  base::FilePath icon_theme_path = temp_dir.AppendASCII("icons");
+  base::FilePath icon_theme_path = icon_dir->AppendASCII("icons");
 
   // On KDE4, an image located in a directory ending with
   // "icons/hicolor/22x22/apps" can be used as the app indicator image because
@@ -258,39 +359,36 @@ AppIndicatorIcon::WriteKDE4TempImageOnWorkerThread(
       icon_theme_path.AppendASCII("hicolor").AppendASCII("22x22").AppendASCII(
           "apps");
 
-  if (!base::CreateDirectory(image_dir))
-    return SetImageFromFileParams();
-
   // On KDE4, the name of the image file for each different looking bitmap must
-  // be unique. It must also be unique across runs of Chrome.
-  std::vector<unsigned char> bitmap_png_data;
-  if (!gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &bitmap_png_data)) {
-    LOG(WARNING) << "Could not encode icon";
-    return SetImageFromFileParams();
-  }
-  base::MD5Digest digest;
-  base::MD5Sum(reinterpret_cast<char*>(&bitmap_png_data[0]),
-               bitmap_png_data.size(), &digest);
+  // be unique. It must also be unique across runs of Chrome, which the random
+  // name of |icon_dir| takes care of.
   std::string icon_name = base::StringPrintf(
-      "electron_app_indicator2_%s", base::MD5DigestToBase16(digest).c_str());
-
-  // If |bitmap| is smaller than 22x22, KDE does some really ugly resizing.
-  // Pad |bitmap| with transparent pixels to make it 22x22.
-  const int kMinimalSize = 22;
-  SkBitmap scaled_bitmap;
-  scaled_bitmap.allocN32Pixels(std::max(bitmap.width(), kMinimalSize),
-                               std::max(bitmap.height(), kMinimalSize));
-  scaled_bitmap.eraseARGB(0, 0, 0, 0);
-  SkCanvas canvas(scaled_bitmap);
-  canvas.drawBitmap(bitmap, (scaled_bitmap.width() - bitmap.width()) / 2,
-                    (scaled_bitmap.height() - bitmap.height()) / 2);
-
+      "%s_%u", icon_dir->BaseName().value().c_str(), frame_id);
   base::FilePath image_path = image_dir.Append(icon_name + ".png");
-  if (!WriteFile(image_path, scaled_bitmap))
-    return SetImageFromFileParams();
+
+  if (!base::PathExists(image_path)) {
+    if (!base::CreateDirectory(image_dir)) {
+      LOG(WARNING) << "Could not create temporary directory";
+      return SetImageFromFileParams();
+    }
+
+    // If |bitmap| is smaller than 22x22, KDE does some really ugly resizing.
+    // Pad |bitmap| with transparent pixels to make it 22x22.
+    const int kMinimalSize = 22;
+    SkBitmap scaled_bitmap;
+    scaled_bitmap.allocN32Pixels(std::max(bitmap.width(), kMinimalSize),
+                                 std::max(bitmap.height(), kMinimalSize));
+    scaled_bitmap.eraseARGB(0, 0, 0, 0);
+    SkCanvas canvas(scaled_bitmap);
+    canvas.drawBitmap(bitmap, (scaled_bitmap.width() - bitmap.width()) / 2,
+                      (scaled_bitmap.height() - bitmap.height()) / 2);
+
+    if (!WriteFile(image_path, scaled_bitmap))
+      return SetImageFromFileParams();
+  }
 
   SetImageFromFileParams params;
-  params.parent_temp_dir = temp_dir;
+  params.frame_path = image_path;
   params.icon_theme_path = icon_theme_path.value();
   params.icon_name = icon_name;
   return params;
@@ -298,27 +396,33 @@ AppIndicatorIcon::WriteKDE4TempImageOnWorkerThread(
 
 // static
 AppIndicatorIcon::SetImageFromFileParams
-AppIndicatorIcon::WriteUnityTempImageOnWorkerThread(const SkBitmap& bitmap,
-                                                    int icon_change_count,
-                                                    const std::string& id) {
-  // Create a new temporary directory for each image on Unity since using a
-  // single temporary directory seems to have issues when changing icons in
-  // quick succession.
-  base::FilePath temp_dir;
-  if (!base::CreateNewTempDirectory(base::FilePath::StringType(), &temp_dir)) {
-    LOG(WARNING) << "Could not create temporary directory";
+AppIndicatorIcon::WriteUnityTempImageOnWorkerThread(
+    const SkBitmap& bitmap,
+    base::FilePath* icon_dir,
+    uint32_t frame_id) {
+  if (!EnsureIconDirectory(icon_dir))
     return SetImageFromFileParams();
+  // Use a separate directory for each image on Unity since using a single
+  // directory seems to have issues when changing icons in quick succession.
+  base::FilePath frame_dir =
+      icon_dir->AppendASCII(base::NumberToString(frame_id));
+  std::string icon_name = base::StringPrintf(
+      "%s_%u", icon_dir->BaseName().value().c_str(), frame_id);
+  base::FilePath image_path = frame_dir.Append(icon_name + ".png");
+
+  if (!base::PathExists(image_path)) {
+    if (!base::CreateDirectory(frame_dir)) {
+      LOG(WARNING) << "Could not create temporary directory";
+      return SetImageFromFileParams();
+    }
+    if (!WriteFile(image_path, bitmap))
+      return SetImageFromFileParams();
   }
 
-  std::string icon_name =
-      base::StringPrintf("%s_%d", id.c_str(), icon_change_count);
-  base::FilePath image_path = temp_dir.Append(icon_name + ".png");
   SetImageFromFileParams params;
-  if (WriteFile(image_path, bitmap)) {
-    params.parent_temp_dir = temp_dir;
-    params.icon_theme_path = temp_dir.value();
-    params.icon_name = icon_name;
-  }
+  params.frame_path = frame_dir;
+  params.icon_theme_path = frame_dir.value();
+  params.icon_name = icon_name;
   return params;
 }
 
@@ -338,14 +442,6 @@ void AppIndicatorIcon::SetImageFromFile(const SetImageFromFileParams& params) {
     app_indicator_set_icon_theme_path(icon_, params.icon_theme_path.c_str());
     app_indicator_set_icon_full(icon_, params.icon_name.c_str(), "icon");
   }
-
-  if (temp_dir_ != params.parent_temp_dir) {
-    base::PostTask(
-        FROM_HERE,
-        {base::ThreadPool(), base::MayBlock(), base::TaskPriority::BEST_EFFORT},
-        base::BindOnce(&DeleteTempDirectory, temp_dir_));
-    temp_dir_ = params.parent_temp_dir;
-  }
 }
 
 void AppIndicatorIcon::SetMenu() {
@@ -7,9 +7,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/files/file_path.h"
 #include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/nix/xdg_util.h"
 #include "ui/base/glib/glib_signal.h"
@@ -20,6 +23,10 @@ typedef struct _GtkWidget GtkWidget;
 
 class SkBitmap;
 
+namespace base {
+class SequencedTaskRunner;
+}
+
 namespace gfx {
 class ImageSkia;
 }
@@ -47,6 +54,10 @@ class AppIndicatorIcon : public views::StatusIconLinux {
   // Indicates whether libappindicator so could be opened.
   static bool CouldOpen();
 
+  // Writes |images| to disk ahead of time, so that later switching to any of
+  // them with SetIcon() does not need to encode or write anything.
+  void PreloadIcons(const std::vector<gfx::ImageSkia>& images);
+
   // Overridden from views::StatusIconLinux:
   void SetIcon(const gfx::ImageSkia& image) override;
   void SetToolTip(const base::string16& tool_tip) override;
@@ -55,8 +66,9 @@ class AppIndicatorIcon : public views::StatusIconLinux {
 
  private:
   struct SetImageFromFileParams {
-    // The temporary directory in which the icon(s) were written.
-    base::FilePath parent_temp_dir;
+    // The file or directory holding this image, deleted when the image is
+    // evicted from |frames_|.
+    base::FilePath frame_path;
 
     // The icon theme path to pass to libappindicator.
     std::string icon_theme_path;
@@ -65,18 +77,32 @@ class AppIndicatorIcon : public views::StatusIconLinux {
     std::string icon_name;
   };
 
-  // Writes |bitmap| to a temporary directory on a worker thread. The temporary
-  // directory is selected based on KDE's quirks.
+  // Writes |bitmap| into |icon_dir| on a worker thread, unless an image with
+  // the same |frame_id| was written already. |icon_dir| is created first if
+  // it is empty. The layout is selected based on KDE's quirks.
   static SetImageFromFileParams WriteKDE4TempImageOnWorkerThread(
       const SkBitmap& bitmap,
-      const base::FilePath& existing_temp_dir);
+      base::FilePath* icon_dir,
+      uint32_t frame_id);
 
-  // Writes |bitmap| to a temporary directory on a worker thread. The temporary
-  // directory is selected based on Unity's quirks.
+  // Writes |bitmap| into |icon_dir| on a worker thread, unless an image with
+  // the same |frame_id| was written already. |icon_dir| is created first if
+  // it is empty. The layout is selected based on Unity's quirks.
   static SetImageFromFileParams WriteUnityTempImageOnWorkerThread(
       const SkBitmap& bitmap,
-      int icon_change_count,
-      const std::string& id);
+      base::FilePath* icon_dir,
+      uint32_t frame_id);
+
+  // Writes |bitmap| to disk and calls OnFrameWritten() with the result.
+  void WriteFrame(const SkBitmap& bitmap,
+                  uint32_t frame_id,
+                  int icon_change_count);
+
+  // Caches the written frame, and shows it if it is still the latest icon
+  // set. |icon_change_count| is -1 for preloaded frames.
+  void OnFrameWritten(uint32_t frame_id,
+                      int icon_change_count,
+                      const SetImageFromFileParams& params);
 
   void SetImageFromFile(const SetImageFromFileParams& params);
   void SetMenu();
@@ -101,9 +127,19 @@ class AppIndicatorIcon : public views::StatusIconLinux {
   std::unique_ptr<AppIndicatorIconMenu> menu_;
   ui::MenuModel* menu_model_;
 
-  base::FilePath temp_dir_;
+  // The private directory all images of this icon are written to, preferably
+  // on a tmpfs. Empty until the first image is written, and only accessed on
+  // |file_task_runner_|.
+  std::unique_ptr<base::FilePath> temp_dir_;
   int icon_change_count_;
 
+  // Images written to |temp_dir_|, keyed by the generation ID of their
+  // bitmap.
+  base::MRUCache<uint32_t, SetImageFromFileParams> frames_;
+
+  // Sequence for all the file operations on |temp_dir_|.
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+
   base::WeakPtrFactory<AppIndicatorIcon> weak_factory_{this};
 
   DISALLOW_COPY_AND_ASSIGN(AppIndicatorIcon);
@@ -38,7 +38,9 @@ bool IsStatusIconSupported() {
 std::unique_ptr<views::StatusIconLinux> CreateLinuxStatusIcon(
     const gfx::ImageSkia& image,
     const base::string16& tool_tip,
-    const char* id_prefix) {
+    const char* id_prefix,
+    AppIndicatorIcon** app_indicator_icon) {
+  *app_indicator_icon = nullptr;
 #if GTK_CHECK_VERSION(3, 90, 0)
   NOTIMPLEMENTED();
   return nullptr;
@@ -46,9 +48,10 @@ std::unique_ptr<views::StatusIconLinux> CreateLinuxStatusIcon(
   if (AppIndicatorIcon::CouldOpen()) {
     ++indicators_count;
 
-    return std::unique_ptr<views::StatusIconLinux>(new AppIndicatorIcon(
+    *app_indicator_icon = new AppIndicatorIcon(
         base::StringPrintf("%s%d", id_prefix, indicators_count), image,
-        tool_tip));
+        tool_tip);
+    return std::unique_ptr<views::StatusIconLinux>(*app_indicator_icon);
   } else {
     return std::unique_ptr<views::StatusIconLinux>(
         new GtkStatusIcon(image, tool_tip));
@@ -19,11 +19,17 @@ namespace electron {
 
 namespace gtkui {
 
+class AppIndicatorIcon;
+
 bool IsStatusIconSupported();
+
+// |app_indicator_icon| is set to the created icon when it is backed by
+// libappindicator, and to nullptr otherwise.
 std::unique_ptr<views::StatusIconLinux> CreateLinuxStatusIcon(
     const gfx::ImageSkia& image,
     const base::string16& tool_tip,
-    const char* id_prefix);
+    const char* id_prefix,
+    AppIndicatorIcon** app_indicator_icon);
 
 }  // namespace gtkui
 
@@ -8,9 +8,16 @@
 #include <gtk/gtk.h>
 #include <stdint.h>
 
+#include <iterator>
+#include <memory>
+#include <tuple>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/sequence_checker.h"
 #include "third_party/skia/include/core/SkBitmap.h"
-#include "third_party/skia/include/core/SkColor.h"
-#include "third_party/skia/include/core/SkUnPreMultiply.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
 
 namespace gtk_util {
 
@@ -39,10 +46,72 @@ const char* const kYesLabel = GTK_STOCK_YES;
 G_GNUC_END_IGNORE_DEPRECATIONS
 #endif
 
-GdkPixbuf* GdkPixbufFromSkBitmap(const SkBitmap& bitmap) {
-  if (bitmap.isNull())
-    return nullptr;
+const size_t kPixbufCacheMaxBytes = 4 * 1024 * 1024;
+
+namespace {
+
+// A bitmap is identified by its pixels' generation ID, and by its subset of
+// those pixels.
+using PixbufCacheKey = std::tuple<uint32_t, int, int, int, int>;
+
+struct GObjectDeleter {
+  void operator()(gpointer object) const { g_object_unref(object); }
+};
+
+size_t GetPixbufByteSize(GdkPixbuf* pixbuf) {
+  return static_cast<size_t>(gdk_pixbuf_get_rowstride(pixbuf)) *
+         gdk_pixbuf_get_height(pixbuf);
+}
+
+// Keeps the recently converted pixbufs as long as their pixels fit in
+// kPixbufCacheMaxBytes, so large images are not pinned for the lifetime of
+// the process.
+class PixbufCache {
+ public:
+  PixbufCache() : cache_(PixbufMRUCache::NO_AUTO_EVICT) {}
+
+  GdkPixbuf* Get(const PixbufCacheKey& key) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    auto it = cache_.Get(key);
+    return it == cache_.end() ? nullptr : it->second.get();
+  }
+
+  void Put(const PixbufCacheKey& key, GdkPixbuf* pixbuf) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    size_t size = GetPixbufByteSize(pixbuf);
+    if (size > kPixbufCacheMaxBytes)
+      return;
+    while (!cache_.empty() && byte_size_ + size > kPixbufCacheMaxBytes) {
+      auto oldest = std::prev(cache_.end());
+      byte_size_ -= GetPixbufByteSize(oldest->second.get());
+      cache_.Erase(oldest);
+    }
+    byte_size_ += size;
+    cache_.Put(key, std::unique_ptr<GdkPixbuf, GObjectDeleter>(
+                        static_cast<GdkPixbuf*>(g_object_ref(pixbuf))));
+  }
+
+  size_t byte_size() const { return byte_size_; }
+
+ private:
+  using PixbufMRUCache =
+      base::MRUCache<PixbufCacheKey,
+                     std::unique_ptr<GdkPixbuf, GObjectDeleter>>;
+
+  PixbufMRUCache cache_;
+  size_t byte_size_ = 0;
 
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(PixbufCache);
+};
+
+PixbufCache& GetPixbufCache() {
+  static base::NoDestructor<PixbufCache> cache;
+  return *cache;
+}
+
+GdkPixbuf* ConvertSkBitmapToGdkPixbuf(const SkBitmap& bitmap) {
   int width = bitmap.width();
   int height = bitmap.height();
 
@@ -50,33 +119,45 @@ GdkPixbuf* GdkPixbufFromSkBitmap(const SkBitmap& bitmap) {
       gdk_pixbuf_new(GDK_COLORSPACE_RGB,  // The only colorspace gtk supports.
                      TRUE,                // There is an alpha channel.
                      8, width, height);
+  if (!pixbuf)
+    return nullptr;
 
-  // SkBitmaps are premultiplied, we need to unpremultiply them.
-  const int kBytesPerPixel = 4;
-  uint8_t* divided = gdk_pixbuf_get_pixels(pixbuf);
-
-  for (int y = 0, i = 0; y < height; y++) {
-    for (int x = 0; x < width; x++) {
-      uint32_t pixel = bitmap.getAddr32(0, y)[x];
-
-      int alpha = SkColorGetA(pixel);
-      if (alpha != 0 && alpha != 255) {
-        SkColor unmultiplied = SkUnPreMultiply::PMColorToColor(pixel);
-        divided[i + 0] = SkColorGetR(unmultiplied);
-        divided[i + 1] = SkColorGetG(unmultiplied);
-        divided[i + 2] = SkColorGetB(unmultiplied);
-        divided[i + 3] = alpha;
-      } else {
-        divided[i + 0] = SkColorGetR(pixel);
-        divided[i + 1] = SkColorGetG(pixel);
-        divided[i + 2] = SkColorGetB(pixel);
-        divided[i + 3] = alpha;
-      }
-      i += kBytesPerPixel;
-    }
+  // SkBitmaps are premultiplied BGRA and GdkPixbufs are unpremultiplied RGBA.
+  // Let skia do the conversion, it uses the SSE2/AVX2/NEON code paths of its
+  // pixel pipeline where available instead of converting pixel by pixel.
+  SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType,
+                                       kUnpremul_SkAlphaType);
+  if (!bitmap.readPixels(info, gdk_pixbuf_get_pixels(pixbuf),
+                         gdk_pixbuf_get_rowstride(pixbuf), 0, 0)) {
+    g_object_unref(pixbuf);
+    return nullptr;
   }
 
   return pixbuf;
 }
 
+}  // namespace
+
+GdkPixbuf* GdkPixbufFromSkBitmap(const SkBitmap& bitmap) {
+  if (bitmap.isNull())
+    return nullptr;
+
+  SkIPoint origin = bitmap.pixelRefOrigin();
+  PixbufCacheKey key(bitmap.getGenerationID(), origin.x(), origin.y(),
+                     bitmap.width(), bitmap.height());
+  PixbufCache& cache = GetPixbufCache();
+  GdkPixbuf* pixbuf = cache.Get(key);
+  if (pixbuf)
+    return static_cast<GdkPixbuf*>(g_object_ref(pixbuf));
+
+  pixbuf = ConvertSkBitmapToGdkPixbuf(bitmap);
+  if (pixbuf)
+    cache.Put(key, pixbuf);
+  return pixbuf;
+}
+
+size_t GetPixbufCacheByteSizeForTesting() {
+  return GetPixbufCache().byte_size();
+}
+
 }  // namespace gtk_util
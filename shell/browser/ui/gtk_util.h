@@ -6,6 +6,7 @@
 #define SHELL_BROWSER_UI_GTK_UTIL_H_
 
 #include <gtk/gtk.h>
+#include <stddef.h>
 
 class SkBitmap;
 
@@ -20,11 +21,22 @@ extern const char* const kOpenLabel;
 extern const char* const kSaveLabel;
 extern const char* const kYesLabel;
 
-// Convert and copy a SkBitmap to a GdkPixbuf. NOTE: this uses BGRAToRGBA, so
-// it is an expensive operation.  The returned GdkPixbuf will have a refcount of
-// 1, and the caller is responsible for unrefing it when done.
+// The most memory taken by the pixels of the cached GdkPixbufs.
+extern const size_t kPixbufCacheMaxBytes;
+
+// Convert and copy a SkBitmap to a GdkPixbuf. NOTE: this unpremultiplies and
+// swizzles every pixel, so it is an expensive operation. Recently converted
+// bitmaps are cached by their generation ID, up to kPixbufCacheMaxBytes, so
+// converting the same bitmap again (e.g. frames of an animated tray icon)
+// returns the cached GdkPixbuf.
+// The caller owns a reference to the returned GdkPixbuf and is responsible for
+// unrefing it when done. Cached pixbufs are shared with the other callers, so
+// they are immutable: copy the pixbuf with gdk_pixbuf_copy() before modifying
+// it. Must always be called on the same sequence, the UI thread.
 GdkPixbuf* GdkPixbufFromSkBitmap(const SkBitmap& bitmap);
 
+size_t GetPixbufCacheByteSizeForTesting();
+
 }  // namespace gtk_util
 
 #endif  // SHELL_BROWSER_UI_GTK_UTIL_H_
@@ -0,0 +1,76 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/browser/ui/gtk_util.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColor.h"
+
+namespace gtk_util {
+
+namespace {
+
+SkBitmap CreateBitmap(int width, int height, SkColor color) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(width, height);
+  bitmap.eraseColor(color);
+  return bitmap;
+}
+
+}  // namespace
+
+TEST(GtkUtilTest, GdkPixbufFromSkBitmapUnpremultiplies) {
+  SkBitmap bitmap = CreateBitmap(4, 3, SkColorSetARGB(0x80, 0xff, 0x40, 0x00));
+  GdkPixbuf* pixbuf = GdkPixbufFromSkBitmap(bitmap);
+  ASSERT_TRUE(pixbuf);
+  EXPECT_EQ(4, gdk_pixbuf_get_width(pixbuf));
+  EXPECT_EQ(3, gdk_pixbuf_get_height(pixbuf));
+
+  const guchar* pixel = gdk_pixbuf_get_pixels(pixbuf);
+  EXPECT_NEAR(0xff, pixel[0], 1);
+  EXPECT_NEAR(0x40, pixel[1], 1);
+  EXPECT_NEAR(0x00, pixel[2], 1);
+  EXPECT_EQ(0x80, pixel[3]);
+  g_object_unref(pixbuf);
+}
+
+TEST(GtkUtilTest, GdkPixbufFromSkBitmapReusesConvertedBitmaps) {
+  SkBitmap bitmap = CreateBitmap(16, 16, SK_ColorRED);
+  GdkPixbuf* first = GdkPixbufFromSkBitmap(bitmap);
+  GdkPixbuf* second = GdkPixbufFromSkBitmap(bitmap);
+  EXPECT_EQ(first, second);
+  g_object_unref(first);
+  g_object_unref(second);
+
+  // Modified pixels get a new generation ID, and so a new pixbuf.
+  bitmap.eraseColor(SK_ColorBLUE);
+  GdkPixbuf* third = GdkPixbufFromSkBitmap(bitmap);
+  EXPECT_EQ(0x00, gdk_pixbuf_get_pixels(third)[0]);
+  EXPECT_EQ(0xff, gdk_pixbuf_get_pixels(third)[2]);
+  g_object_unref(third);
+}
+
+TEST(GtkUtilTest, GdkPixbufCacheIsBoundedByBytes) {
+  // 1024x1024 RGBA pixbufs, so only a few fit in the cache.
+  for (int i = 0; i < 8; ++i) {
+    GdkPixbuf* pixbuf =
+        GdkPixbufFromSkBitmap(CreateBitmap(1024, 1024, SK_ColorGREEN));
+    ASSERT_TRUE(pixbuf);
+    g_object_unref(pixbuf);
+    EXPECT_LE(GetPixbufCacheByteSizeForTesting(), kPixbufCacheMaxBytes);
+  }
+
+  // Bitmaps larger than the whole cache are converted but never cached.
+  size_t size = GetPixbufCacheByteSizeForTesting();
+  SkBitmap large = CreateBitmap(2048, 1024, SK_ColorGREEN);
+  GdkPixbuf* first = GdkPixbufFromSkBitmap(large);
+  GdkPixbuf* second = GdkPixbufFromSkBitmap(large);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(size, GetPixbufCacheByteSizeForTesting());
+  g_object_unref(first);
+  g_object_unref(second);
+}
+
+}  // namespace gtk_util
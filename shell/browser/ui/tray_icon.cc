@@ -14,6 +14,8 @@ TrayIcon::~TrayIcon() = default;
 
 void TrayIcon::SetPressedImage(ImageType image) {}
 
+void TrayIcon::PreloadImages(const std::vector<gfx::Image>& images) {}
+
 void TrayIcon::DisplayBalloon(const BalloonOptions& options) {}
 
 void TrayIcon::RemoveBalloon() {}
@@ -13,6 +13,7 @@
 #include "shell/browser/ui/tray_icon_observer.h"
 #include "shell/common/gin_converters/guid_converter.h"
 #include "ui/gfx/geometry/rect.h"
+#include "ui/gfx/image/image.h"
 
 namespace electron {
 
@@ -34,6 +35,10 @@ class TrayIcon {
   // Sets the image associated with this status icon when pressed.
   virtual void SetPressedImage(ImageType image);
 
+  // Prepares |images| so that later switching to them with SetImage() is
+  // cheap, e.g. for the frames of an animated icon.
+  virtual void PreloadImages(const std::vector<gfx::Image>& images);
+
   // Sets the hover text for this status icon. This is also used as the label
   // for the menu item which is created as a replacement for the status icon
   // click action on platforms that do not support custom click actions for the
@@ -7,6 +7,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "shell/browser/browser.h"
+#include "shell/browser/ui/gtk/app_indicator_icon.h"
 #include "shell/browser/ui/gtk/status_icon.h"
 #include "shell/common/application_info.h"
 #include "ui/gfx/image/image.h"
@@ -29,10 +30,22 @@ void TrayIconGtk::SetImage(const gfx::Image& image) {
   tool_tip_ = base::UTF8ToUTF16(GetApplicationName());
 
   icon_ = gtkui::CreateLinuxStatusIcon(image_, tool_tip_,
-                                       Browser::Get()->GetName().c_str());
+                                       Browser::Get()->GetName().c_str(),
+                                       &app_indicator_icon_);
   icon_->SetDelegate(this);
 }
 
+void TrayIconGtk::PreloadImages(const std::vector<gfx::Image>& images) {
+  // Only libappindicator icons need to write the images to disk first.
+  if (!app_indicator_icon_)
+    return;
+
+  std::vector<gfx::ImageSkia> image_skias;
+  for (const auto& image : images)
+    image_skias.push_back(image.AsImageSkia());
+  app_indicator_icon_->PreloadIcons(image_skias);
+}
+
 void TrayIconGtk::SetToolTip(const std::string& tool_tip) {
   tool_tip_ = base::UTF8ToUTF16(tool_tip);
   icon_->SetToolTip(tool_tip_);
@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "shell/browser/ui/tray_icon.h"
 #include "ui/views/linux_ui/status_icon_linux.h"
@@ -17,6 +18,10 @@ class StatusIconLinux;
 
 namespace electron {
 
+namespace gtkui {
+class AppIndicatorIcon;
+}
+
 class TrayIconGtk : public TrayIcon, public views::StatusIconLinux::Delegate {
  public:
   TrayIconGtk();
@@ -24,6 +29,7 @@ class TrayIconGtk : public TrayIcon, public views::StatusIconLinux::Delegate {
 
   // TrayIcon:
   void SetImage(const gfx::Image& image) override;
+  void PreloadImages(const std::vector<gfx::Image>& images) override;
   void SetToolTip(const std::string& tool_tip) override;
   void SetContextMenu(ElectronMenuModel* menu_model) override;
 
@@ -39,6 +45,8 @@ class TrayIconGtk : public TrayIcon, public views::StatusIconLinux::Delegate {
 
  private:
   std::unique_ptr<views::StatusIconLinux> icon_;
+  // Set when |icon_| is backed by libappindicator.
+  gtkui::AppIndicatorIcon* app_indicator_icon_ = nullptr;
   gfx::ImageSkia image_;
   base::string16 tool_tip_;
   ui::MenuModel* menu_model_;
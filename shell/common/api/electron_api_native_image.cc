@@ -13,6 +13,7 @@
 #include "base/strings/pattern.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/task/thread_pool.h"
 #include "base/threading/thread_restrictions.h"
 #include "gin/arguments.h"
 #include "gin/object_template_builder.h"
@@ -22,12 +23,15 @@
 #include "shell/common/gin_converters/file_path_converter.h"
 #include "shell/common/gin_converters/gfx_converter.h"
 #include "shell/common/gin_converters/gurl_converter.h"
+#include "shell/common/gin_converters/image_converter.h"
 #include "shell/common/gin_converters/value_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
 #include "shell/common/gin_helper/function_template_extensions.h"
 #include "shell/common/gin_helper/object_template_builder.h"
+#include "shell/common/gin_helper/promise.h"
 #include "shell/common/node_includes.h"
 #include "shell/common/skia_util.h"
+#include "skia/ext/image_operations.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
@@ -61,6 +65,21 @@ float GetScaleFactorFromOptions(gin::Arguments* args) {
   return scale_factor;
 }
 
+// Get the scale factor and PNG compression level from options object at the
+// first argument
+void GetPNGOptions(gin::Arguments* args,
+                   float* scale_factor,
+                   base::Optional<int>* compression_level) {
+  *scale_factor = 1.0f;
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    options.Get("scaleFactor", scale_factor);
+    int level;
+    if (options.Get("compressionLevel", &level))
+      *compression_level = level;
+  }
+}
+
 base::FilePath NormalizePath(const base::FilePath& path) {
   if (!path.ReferencesParent()) {
     return path;
@@ -83,6 +102,117 @@ bool IsTemplateFilename(const base::FilePath& path) {
 }
 #endif
 
+// The encoding and resizing work done by the *Async methods is CPU bound and
+// must not block shutdown.
+constexpr base::TaskTraits kImageTaskTraits = {
+    base::TaskPriority::USER_VISIBLE,
+    base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN};
+
+skia::ImageOperations::ResizeMethod GetResizeMethodFromOptions(
+    const base::DictionaryValue& options) {
+  std::string quality;
+  options.GetString("quality", &quality);
+  if (quality == "good")
+    return skia::ImageOperations::ResizeMethod::RESIZE_GOOD;
+  else if (quality == "better")
+    return skia::ImageOperations::ResizeMethod::RESIZE_BETTER;
+  return skia::ImageOperations::ResizeMethod::RESIZE_BEST;
+}
+
+void FreeEncodedData(char* data, void* hint) {
+  delete reinterpret_cast<std::vector<unsigned char>*>(hint);
+}
+
+// Copies |bytes|, which are cached by the image and must not be modified
+// through the returned Buffer.
+v8::Local<v8::Value> RefCountedMemoryToBuffer(
+    v8::Isolate* isolate,
+    scoped_refptr<base::RefCountedMemory> bytes) {
+  return node::Buffer::Copy(isolate,
+                            reinterpret_cast<const char*>(bytes->front()),
+                            bytes->size())
+      .ToLocalChecked();
+}
+
+// Hands the ownership of |encoded| to a node Buffer without copying it.
+v8::Local<v8::Value> EncodedDataToBuffer(
+    v8::Isolate* isolate,
+    std::unique_ptr<std::vector<unsigned char>> encoded) {
+  if (encoded->empty())
+    return node::Buffer::New(isolate, 0).ToLocalChecked();
+  char* data = reinterpret_cast<char*>(encoded->data());
+  size_t size = encoded->size();
+  return node::Buffer::New(isolate, data, size, &FreeEncodedData,
+                           encoded.release())
+      .ToLocalChecked();
+}
+
+std::unique_ptr<std::vector<unsigned char>> EncodeBitmapAsPNG(
+    const SkBitmap& bitmap,
+    base::Optional<int> compression_level) {
+  auto encoded = std::make_unique<std::vector<unsigned char>>();
+  if (compression_level) {
+    electron::util::EncodeBGRASkBitmapAsPNG(bitmap, *compression_level,
+                                            encoded.get());
+  } else {
+    gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, encoded.get());
+  }
+  return encoded;
+}
+
+std::unique_ptr<std::vector<unsigned char>> EncodeBitmapAsJPEG(
+    const SkBitmap& bitmap,
+    int quality) {
+  auto encoded = std::make_unique<std::vector<unsigned char>>();
+  if (!bitmap.drawsNothing() &&
+      !gfx::JPEGCodec::Encode(bitmap, quality, encoded.get()))
+    encoded->clear();
+  return encoded;
+}
+
+gfx::ImageSkia DecodeImageFromBuffer(std::vector<unsigned char> buffer,
+                                     int width,
+                                     int height,
+                                     double scale_factor) {
+  gfx::ImageSkia image_skia;
+  electron::util::AddImageSkiaRepFromBuffer(&image_skia, buffer.data(),
+                                            buffer.size(), width, height,
+                                            scale_factor);
+  // The image is handed back to the thread that requested it.
+  image_skia.DetachStorageFromSequence();
+  return image_skia;
+}
+
+gfx::ImageSkia ResizeImageReps(std::vector<gfx::ImageSkiaRep> reps,
+                               skia::ImageOperations::ResizeMethod method,
+                               const gfx::Size& size) {
+  gfx::ImageSkia resized;
+  for (const auto& rep : reps) {
+    gfx::Size pixel_size = gfx::ScaleToRoundedSize(size, rep.scale());
+    if (pixel_size.IsEmpty())
+      continue;
+    SkBitmap bitmap = skia::ImageOperations::Resize(
+        rep.GetBitmap(), method, pixel_size.width(), pixel_size.height());
+    resized.AddRepresentation(gfx::ImageSkiaRep(bitmap, rep.scale()));
+  }
+  resized.DetachStorageFromSequence();
+  return resized;
+}
+
+void ResolveWithEncodedData(
+    gin_helper::Promise<v8::Local<v8::Value>> promise,
+    std::unique_ptr<std::vector<unsigned char>> encoded) {
+  v8::Isolate* isolate = promise.isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(promise.GetContext());
+  promise.Resolve(EncodedDataToBuffer(isolate, std::move(encoded)));
+}
+
+void ResolveWithImage(gin_helper::Promise<gfx::Image> promise,
+                      gfx::ImageSkia image_skia) {
+  promise.Resolve(gfx::Image(image_skia));
+}
+
 #if defined(OS_WIN)
 base::win::ScopedHICON ReadICOFromPath(int size, const base::FilePath& path) {
   // If file is in asar archive, we extract it to a temp file so LoadImage can
@@ -155,25 +285,49 @@ HICON NativeImage::GetHICON(int size) {
 #endif
 
 v8::Local<v8::Value> NativeImage::ToPNG(gin::Arguments* args) {
-  float scale_factor = GetScaleFactorFromOptions(args);
-
-  if (scale_factor == 1.0f) {
-    // Use raw 1x PNG bytes when available
+  float scale_factor;
+  base::Optional<int> compression_level;
+  GetPNGOptions(args, &scale_factor, &compression_level);
+
+  // Use raw 1x PNG bytes when available, they are only encoded here with the
+  // default compression level.
+  if (scale_factor == 1.0f &&
+      (!compression_level ||
+       image_.HasRepresentation(gfx::Image::kImageRepPNG))) {
     scoped_refptr<base::RefCountedMemory> png = image_.As1xPNGBytes();
-    if (png->size() > 0) {
-      const char* data = reinterpret_cast<const char*>(png->front());
-      size_t size = png->size();
-      return node::Buffer::Copy(args->isolate(), data, size).ToLocalChecked();
-    }
+    if (png->size() > 0)
+      return RefCountedMemoryToBuffer(args->isolate(), png);
   }
 
   const SkBitmap bitmap =
       image_.AsImageSkia().GetRepresentation(scale_factor).GetBitmap();
-  std::vector<unsigned char> encoded;
-  gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &encoded);
-  const char* data = reinterpret_cast<char*>(encoded.data());
-  size_t size = encoded.size();
-  return node::Buffer::Copy(args->isolate(), data, size).ToLocalChecked();
+  return EncodedDataToBuffer(args->isolate(),
+                             EncodeBitmapAsPNG(bitmap, compression_level));
+}
+
+v8::Local<v8::Promise> NativeImage::ToPNGAsync(gin::Arguments* args) {
+  gin_helper::Promise<v8::Local<v8::Value>> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+  float scale_factor;
+  base::Optional<int> compression_level;
+  GetPNGOptions(args, &scale_factor, &compression_level);
+
+  // Only reuse the 1x PNG bytes when they already exist, As1xPNGBytes() would
+  // otherwise encode them synchronously.
+  if (scale_factor == 1.0f &&
+      image_.HasRepresentation(gfx::Image::kImageRepPNG)) {
+    promise.Resolve(
+        RefCountedMemoryToBuffer(args->isolate(), image_.As1xPNGBytes()));
+    return handle;
+  }
+
+  const SkBitmap bitmap =
+      image_.AsImageSkia().GetRepresentation(scale_factor).GetBitmap();
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, kImageTaskTraits,
+      base::BindOnce(&EncodeBitmapAsPNG, bitmap, compression_level),
+      base::BindOnce(&ResolveWithEncodedData, std::move(promise)));
+  return handle;
 }
 
 v8::Local<v8::Value> NativeImage::ToBitmap(gin::Arguments* args) {
@@ -198,14 +352,33 @@ v8::Local<v8::Value> NativeImage::ToBitmap(gin::Arguments* args) {
 }
 
 v8::Local<v8::Value> NativeImage::ToJPEG(v8::Isolate* isolate, int quality) {
-  std::vector<unsigned char> output;
-  gfx::JPEG1xEncodedDataFromImage(image_, quality, &output);
-  if (output.empty())
+  const gfx::ImageSkiaRep& image_skia_rep =
+      image_.AsImageSkia().GetRepresentation(1.0f);
+  // Like gfx::JPEG1xEncodedDataFromImage, images without a 1x representation
+  // are not encoded.
+  if (image_skia_rep.scale() != 1.0f)
     return node::Buffer::New(isolate, 0).ToLocalChecked();
-  return node::Buffer::Copy(isolate,
-                            reinterpret_cast<const char*>(&output.front()),
-                            output.size())
-      .ToLocalChecked();
+  return EncodedDataToBuffer(
+      isolate, EncodeBitmapAsJPEG(image_skia_rep.GetBitmap(), quality));
+}
+
+v8::Local<v8::Promise> NativeImage::ToJPEGAsync(v8::Isolate* isolate,
+                                                int quality) {
+  gin_helper::Promise<v8::Local<v8::Value>> promise(isolate);
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  const gfx::ImageSkiaRep& image_skia_rep =
+      image_.AsImageSkia().GetRepresentation(1.0f);
+  if (image_skia_rep.scale() != 1.0f) {
+    promise.Resolve(node::Buffer::New(isolate, 0).ToLocalChecked());
+    return handle;
+  }
+
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, kImageTaskTraits,
+      base::BindOnce(&EncodeBitmapAsJPEG, image_skia_rep.GetBitmap(), quality),
+      base::BindOnce(&ResolveWithEncodedData, std::move(promise)));
+  return handle;
 }
 
 std::string NativeImage::ToDataURL(gin::Arguments* args) {
@@ -222,6 +395,36 @@ std::string NativeImage::ToDataURL(gin::Arguments* args) {
       image_.AsImageSkia().GetRepresentation(scale_factor).GetBitmap());
 }
 
+v8::Local<v8::Promise> NativeImage::ToDataURLAsync(gin::Arguments* args) {
+  gin_helper::Promise<std::string> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+  float scale_factor = GetScaleFactorFromOptions(args);
+
+  if (scale_factor == 1.0f &&
+      image_.HasRepresentation(gfx::Image::kImageRepPNG)) {
+    scoped_refptr<base::RefCountedMemory> png = image_.As1xPNGBytes();
+    base::ThreadPool::PostTaskAndReplyWithResult(
+        FROM_HERE, kImageTaskTraits,
+        base::BindOnce(
+            [](scoped_refptr<base::RefCountedMemory> png) {
+              return webui::GetPngDataUrl(png->front(), png->size());
+            },
+            png),
+        base::BindOnce(&gin_helper::Promise<std::string>::ResolvePromise,
+                       std::move(promise)));
+    return handle;
+  }
+
+  const SkBitmap bitmap =
+      image_.AsImageSkia().GetRepresentation(scale_factor).GetBitmap();
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, kImageTaskTraits,
+      base::BindOnce(&webui::GetBitmapDataUrl, bitmap),
+      base::BindOnce(&gin_helper::Promise<std::string>::ResolvePromise,
+                     std::move(promise)));
+  return handle;
+}
+
 void SkUnref(char* data, void* hint) {
   reinterpret_cast<SkRefCnt*>(hint)->unref();
 }
@@ -286,10 +489,8 @@ float NativeImage::GetAspectRatio(const base::Optional<float> scale_factor) {
     return static_cast<float>(size.width()) / static_cast<float>(size.height());
 }
 
-gin::Handle<NativeImage> NativeImage::Resize(gin::Arguments* args,
-                                             base::DictionaryValue options) {
-  float scale_factor = GetScaleFactorFromOptions(args);
-
+gfx::Size NativeImage::GetResizedSize(float scale_factor,
+                                      const base::DictionaryValue& options) {
   gfx::Size size = GetSize(scale_factor);
   int width = size.width();
   int height = size.height();
@@ -307,22 +508,39 @@ gin::Handle<NativeImage> NativeImage::Resize(gin::Arguments* args,
     size.set_width(height);
     size = gfx::ScaleToRoundedSize(size, GetAspectRatio(scale_factor), 1.f);
   }
+  return size;
+}
 
-  skia::ImageOperations::ResizeMethod method =
-      skia::ImageOperations::ResizeMethod::RESIZE_BEST;
-  std::string quality;
-  options.GetString("quality", &quality);
-  if (quality == "good")
-    method = skia::ImageOperations::ResizeMethod::RESIZE_GOOD;
-  else if (quality == "better")
-    method = skia::ImageOperations::ResizeMethod::RESIZE_BETTER;
+gin::Handle<NativeImage> NativeImage::Resize(gin::Arguments* args,
+                                             base::DictionaryValue options) {
+  float scale_factor = GetScaleFactorFromOptions(args);
+  gfx::Size size = GetResizedSize(scale_factor, options);
 
   gfx::ImageSkia resized = gfx::ImageSkiaOperations::CreateResizedImage(
-      image_.AsImageSkia(), method, size);
+      image_.AsImageSkia(), GetResizeMethodFromOptions(options), size);
   return gin::CreateHandle(
       args->isolate(), new NativeImage(args->isolate(), gfx::Image(resized)));
 }
 
+v8::Local<v8::Promise> NativeImage::ResizeAsync(gin::Arguments* args,
+                                                base::DictionaryValue options) {
+  gin_helper::Promise<gfx::Image> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+  float scale_factor = GetScaleFactorFromOptions(args);
+  gfx::Size size = GetResizedSize(scale_factor, options);
+
+  // Only the pixels of the existing representations are handed to the worker,
+  // the ImageSkia itself must stay on this thread.
+  gfx::ImageSkia image_skia = image_.AsImageSkia();
+  image_skia.GetRepresentation(scale_factor);
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, kImageTaskTraits,
+      base::BindOnce(&ResizeImageReps, image_skia.image_reps(),
+                     GetResizeMethodFromOptions(options), size),
+      base::BindOnce(&ResolveWithImage, std::move(promise)));
+  return handle;
+}
+
 gin::Handle<NativeImage> NativeImage::Crop(v8::Isolate* isolate,
                                            const gfx::Rect& rect) {
   gfx::ImageSkia cropped =
@@ -506,6 +724,41 @@ gin::Handle<NativeImage> NativeImage::CreateFromBuffer(
   return Create(args->isolate(), gfx::Image(image_skia));
 }
 
+// static
+v8::Local<v8::Promise> NativeImage::CreateFromBufferAsync(
+    v8::Local<v8::Value> buffer,
+    gin::Arguments* args) {
+  gin_helper::Promise<gfx::Image> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  if (!node::Buffer::HasInstance(buffer)) {
+    promise.RejectWithErrorMessage("buffer must be a node Buffer");
+    return handle;
+  }
+
+  int width = 0;
+  int height = 0;
+  double scale_factor = 1.;
+
+  gin_helper::Dictionary options;
+  if (args->GetNext(&options)) {
+    options.Get("width", &width);
+    options.Get("height", &height);
+    options.Get("scaleFactor", &scale_factor);
+  }
+
+  // The buffer may be modified by JS while decoding, so decode a snapshot.
+  const auto* data =
+      reinterpret_cast<const unsigned char*>(node::Buffer::Data(buffer));
+  std::vector<unsigned char> copy(data, data + node::Buffer::Length(buffer));
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, kImageTaskTraits,
+      base::BindOnce(&DecodeImageFromBuffer, std::move(copy), width, height,
+                     scale_factor),
+      base::BindOnce(&ResolveWithImage, std::move(promise)));
+  return handle;
+}
+
 // static
 gin::Handle<NativeImage> NativeImage::CreateFromDataURL(v8::Isolate* isolate,
                                                         const GURL& url) {
@@ -542,12 +795,15 @@ gin::ObjectTemplateBuilder NativeImage::GetObjectTemplateBuilder(
   return gin::ObjectTemplateBuilder(isolate, GetTypeName(),
                                     constructor->InstanceTemplate())
       .SetMethod("toPNG", &NativeImage::ToPNG)
+      .SetMethod("toPNGAsync", &NativeImage::ToPNGAsync)
       .SetMethod("toJPEG", &NativeImage::ToJPEG)
+      .SetMethod("toJPEGAsync", &NativeImage::ToJPEGAsync)
       .SetMethod("toBitmap", &NativeImage::ToBitmap)
       .SetMethod("getBitmap", &NativeImage::GetBitmap)
       .SetMethod("getScaleFactors", &NativeImage::GetScaleFactors)
       .SetMethod("getNativeHandle", &NativeImage::GetNativeHandle)
       .SetMethod("toDataURL", &NativeImage::ToDataURL)
+      .SetMethod("toDataURLAsync", &NativeImage::ToDataURLAsync)
       .SetMethod("isEmpty", &NativeImage::IsEmpty)
       .SetMethod("getSize", &NativeImage::GetSize)
       .SetMethod("setTemplateImage", &NativeImage::SetTemplateImage)
@@ -555,6 +811,7 @@ gin::ObjectTemplateBuilder NativeImage::GetObjectTemplateBuilder(
       .SetProperty("isMacTemplateImage", &NativeImage::IsTemplateImage,
                    &NativeImage::SetTemplateImage)
       .SetMethod("resize", &NativeImage::Resize)
+      .SetMethod("resizeAsync", &NativeImage::ResizeAsync)
       .SetMethod("crop", &NativeImage::Crop)
       .SetMethod("getAspectRatio", &NativeImage::GetAspectRatio)
       .SetMethod("addRepresentation", &NativeImage::AddRepresentation);
@@ -632,6 +889,8 @@ void Initialize(v8::Local<v8::Object> exports,
   native_image.SetMethod("createFromPath", &NativeImage::CreateFromPath);
   native_image.SetMethod("createFromBitmap", &NativeImage::CreateFromBitmap);
   native_image.SetMethod("createFromBuffer", &NativeImage::CreateFromBuffer);
+  native_image.SetMethod("createFromBufferAsync",
+                         &NativeImage::CreateFromBufferAsync);
   native_image.SetMethod("createFromDataURL", &NativeImage::CreateFromDataURL);
   native_image.SetMethod("createFromNamedImage",
                          &NativeImage::CreateFromNamedImage);
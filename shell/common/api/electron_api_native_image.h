@@ -64,6 +64,9 @@ class NativeImage : public gin::Wrappable<NativeImage> {
       gin_helper::ErrorThrower thrower,
       v8::Local<v8::Value> buffer,
       gin::Arguments* args);
+  static v8::Local<v8::Promise> CreateFromBufferAsync(
+      v8::Local<v8::Value> buffer,
+      gin::Arguments* args);
   static gin::Handle<NativeImage> CreateFromDataURL(v8::Isolate* isolate,
                                                     const GURL& url);
   static gin::Handle<NativeImage> CreateFromNamedImage(gin::Arguments* args,
@@ -98,20 +101,29 @@ class NativeImage : public gin::Wrappable<NativeImage> {
 
  private:
   v8::Local<v8::Value> ToPNG(gin::Arguments* args);
+  v8::Local<v8::Promise> ToPNGAsync(gin::Arguments* args);
   v8::Local<v8::Value> ToJPEG(v8::Isolate* isolate, int quality);
+  v8::Local<v8::Promise> ToJPEGAsync(v8::Isolate* isolate, int quality);
   v8::Local<v8::Value> ToBitmap(gin::Arguments* args);
   std::vector<float> GetScaleFactors();
   v8::Local<v8::Value> GetBitmap(gin::Arguments* args);
   v8::Local<v8::Value> GetNativeHandle(gin_helper::ErrorThrower thrower);
   gin::Handle<NativeImage> Resize(gin::Arguments* args,
                                   base::DictionaryValue options);
+  v8::Local<v8::Promise> ResizeAsync(gin::Arguments* args,
+                                     base::DictionaryValue options);
   gin::Handle<NativeImage> Crop(v8::Isolate* isolate, const gfx::Rect& rect);
   std::string ToDataURL(gin::Arguments* args);
+  v8::Local<v8::Promise> ToDataURLAsync(gin::Arguments* args);
   bool IsEmpty();
   gfx::Size GetSize(const base::Optional<float> scale_factor);
   float GetAspectRatio(const base::Optional<float> scale_factor);
   void AddRepresentation(const gin_helper::Dictionary& options);
 
+  // Computes the target size in DIP for resizing to |options|.
+  gfx::Size GetResizedSize(float scale_factor,
+                           const base::DictionaryValue& options);
+
   // Mark the image as template image.
   void SetTemplateImage(bool setAsTemplate);
   // Determine if the image is a template image.
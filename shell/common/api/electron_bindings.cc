@@ -9,6 +9,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/process/process.h"
 #include "base/process/process_handle.h"
@@ -21,6 +22,7 @@
 #include "services/resource_coordinator/public/cpp/memory_instrumentation/memory_instrumentation.h"
 #include "shell/browser/browser.h"
 #include "shell/common/application_info.h"
+#include "shell/common/cpu_profile.h"
 #include "shell/common/gin_converters/file_path_converter.h"
 #include "shell/common/gin_helper/dictionary.h"
 #include "shell/common/gin_helper/locker.h"
@@ -75,6 +77,7 @@ void ElectronBindings::BindTo(v8::Isolate* isolate,
   BindProcess(isolate, &dict, metrics_.get());
 
   dict.SetMethod("takeHeapSnapshot", &TakeHeapSnapshot);
+  dict.SetMethod("takeCpuProfile", &TakeCpuProfile);
 #if defined(OS_POSIX)
   dict.SetMethod("setFdLimit", &base::IncreaseFdLimitTo);
 #endif
@@ -330,4 +333,54 @@ bool ElectronBindings::TakeHeapSnapshot(v8::Isolate* isolate,
   return electron::TakeHeapSnapshot(isolate, &file);
 }
 
+// static
+v8::Local<v8::Promise> ElectronBindings::TakeCpuProfile(
+    gin_helper::Arguments* args) {
+  gin_helper::Promise<void> promise(args->isolate());
+  v8::Local<v8::Promise> handle = promise.GetHandle();
+
+  base::FilePath file_path;
+  int duration = 10000;
+  int sampling_interval = 1000;
+  gin_helper::Dictionary options;
+  if (!args->GetNext(&file_path)) {
+    promise.RejectWithErrorMessage("Invalid file path");
+    return handle;
+  }
+  if (args->GetNext(&options)) {
+    options.Get("duration", &duration);
+    options.Get("samplingInterval", &sampling_interval);
+  }
+  if (duration <= 0 || sampling_interval <= 0) {
+    promise.RejectWithErrorMessage("Invalid CPU profile options");
+    return handle;
+  }
+
+  base::File file;
+  {
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    file = base::File(file_path,
+                      base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  }
+  if (!file.IsValid()) {
+    promise.RejectWithErrorMessage("takeCpuProfile failed");
+    return handle;
+  }
+
+  electron::TakeCpuProfile(
+      args->isolate(), std::move(file),
+      base::TimeDelta::FromMilliseconds(duration),
+      base::TimeDelta::FromMicroseconds(sampling_interval),
+      base::BindOnce(
+          [](gin_helper::Promise<void> promise, bool success) {
+            if (success) {
+              promise.Resolve();
+            } else {
+              promise.RejectWithErrorMessage("takeCpuProfile failed");
+            }
+          },
+          std::move(promise)));
+  return handle;
+}
+
 }  // namespace electron
@@ -62,6 +62,7 @@ class ElectronBindings {
   static v8::Local<v8::Value> GetIOCounters(v8::Isolate* isolate);
   static bool TakeHeapSnapshot(v8::Isolate* isolate,
                                const base::FilePath& file_path);
+  static v8::Local<v8::Promise> TakeCpuProfile(gin_helper::Arguments* args);
 
   void ActivateUVLoop(v8::Isolate* isolate);
 
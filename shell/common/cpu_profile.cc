@@ -0,0 +1,213 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "shell/common/cpu_profile.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/json/string_escape.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "gin/converter.h"
+#include "v8/include/v8-profiler.h"
+
+namespace {
+
+// Buffers the JSON so the profile is written in chunks, without building the
+// whole string in memory.
+class ProfileWriter {
+ public:
+  explicit ProfileWriter(base::File* file) : file_(file) {}
+
+  void Write(base::StringPiece data) {
+    buffer_.append(data.data(), data.size());
+    if (buffer_.size() >= kChunkSize)
+      Flush();
+  }
+
+  void WriteNumber(int64_t number) { Write(base::NumberToString(number)); }
+
+  void WriteString(const char* string) {
+    base::EscapeJSONString(string ? string : "", true, &buffer_);
+  }
+
+  bool Flush() {
+    if (!failed_ && !buffer_.empty()) {
+      int size = static_cast<int>(buffer_.size());
+      failed_ = file_->WriteAtCurrentPos(buffer_.data(), size) != size;
+    }
+    buffer_.clear();
+    return !failed_;
+  }
+
+ private:
+  static constexpr size_t kChunkSize = 65536;
+
+  base::File* file_;
+  std::string buffer_;
+  bool failed_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfileWriter);
+};
+
+void WriteNode(ProfileWriter* writer, const v8::CpuProfileNode* node) {
+  writer->Write("{\"id\":");
+  writer->WriteNumber(node->GetNodeId());
+  writer->Write(",\"callFrame\":{\"functionName\":");
+  writer->WriteString(node->GetFunctionNameStr());
+  writer->Write(",\"scriptId\":\"");
+  writer->WriteNumber(node->GetScriptId());
+  writer->Write("\",\"url\":");
+  writer->WriteString(node->GetScriptResourceNameStr());
+  // DevTools expects zero-based positions.
+  writer->Write(",\"lineNumber\":");
+  writer->WriteNumber(node->GetLineNumber() - 1);
+  writer->Write(",\"columnNumber\":");
+  writer->WriteNumber(node->GetColumnNumber() - 1);
+  writer->Write("},\"hitCount\":");
+  writer->WriteNumber(node->GetHitCount());
+  writer->Write(",\"children\":[");
+  for (int i = 0; i < node->GetChildrenCount(); ++i) {
+    if (i > 0)
+      writer->Write(",");
+    writer->WriteNumber(node->GetChild(i)->GetNodeId());
+  }
+  writer->Write("]}");
+}
+
+bool WriteProfile(const v8::CpuProfile* profile, base::File* file) {
+  ProfileWriter writer(file);
+
+  // The stacks can be deep, so the tree is walked without recursion.
+  writer.Write("{\"nodes\":[");
+  std::vector<const v8::CpuProfileNode*> stack = {profile->GetTopDownRoot()};
+  bool first = true;
+  while (!stack.empty()) {
+    const v8::CpuProfileNode* node = stack.back();
+    stack.pop_back();
+    if (!first)
+      writer.Write(",");
+    first = false;
+    WriteNode(&writer, node);
+    for (int i = node->GetChildrenCount() - 1; i >= 0; --i)
+      stack.push_back(node->GetChild(i));
+  }
+
+  writer.Write("],\"startTime\":");
+  writer.WriteNumber(profile->GetStartTime());
+  writer.Write(",\"endTime\":");
+  writer.WriteNumber(profile->GetEndTime());
+
+  writer.Write(",\"samples\":[");
+  int count = profile->GetSamplesCount();
+  for (int i = 0; i < count; ++i) {
+    if (i > 0)
+      writer.Write(",");
+    writer.WriteNumber(profile->GetSample(i)->GetNodeId());
+  }
+
+  writer.Write("],\"timeDeltas\":[");
+  int64_t last_timestamp = profile->GetStartTime();
+  for (int i = 0; i < count; ++i) {
+    if (i > 0)
+      writer.Write(",");
+    int64_t timestamp = profile->GetSampleTimestamp(i);
+    writer.WriteNumber(timestamp - last_timestamp);
+    last_timestamp = timestamp;
+  }
+  writer.Write("]}");
+
+  return writer.Flush();
+}
+
+class CpuProfileSession {
+ public:
+  CpuProfileSession(v8::Isolate* isolate,
+                    base::File file,
+                    base::OnceCallback<void(bool)> callback)
+      : isolate_(isolate),
+        profiler_(v8::CpuProfiler::New(isolate)),
+        file_(std::move(file)),
+        callback_(std::move(callback)) {}
+
+  bool Start(base::TimeDelta sampling_interval) {
+    v8::HandleScope handle_scope(isolate_);
+    profiler_->SetSamplingInterval(
+        static_cast<int>(sampling_interval.InMicroseconds()));
+    return profiler_->StartProfiling(GetTitle(), true) ==
+           v8::CpuProfilingStatus::kStarted;
+  }
+
+  void Finish() {
+    bool success = false;
+    {
+      v8::HandleScope handle_scope(isolate_);
+      v8::CpuProfile* profile = profiler_->StopProfiling(GetTitle());
+      if (profile) {
+        base::ThreadRestrictions::ScopedAllowIO allow_io;
+        success = WriteProfile(profile, &file_);
+        profile->Delete();
+      }
+    }
+    Dispose();
+    std::move(callback_).Run(success);
+  }
+
+  void Fail() {
+    Dispose();
+    std::move(callback_).Run(false);
+  }
+
+ private:
+  v8::Local<v8::String> GetTitle() {
+    return gin::StringToV8(isolate_, "electron");
+  }
+
+  // Not done on destruction, the pending task may be dropped after the
+  // isolate is gone.
+  void Dispose() {
+    profiler_->Dispose();
+    profiler_ = nullptr;
+  }
+
+  v8::Isolate* isolate_;
+  v8::CpuProfiler* profiler_;
+  base::File file_;
+  base::OnceCallback<void(bool)> callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(CpuProfileSession);
+};
+
+}  // namespace
+
+namespace electron {
+
+void TakeCpuProfile(v8::Isolate* isolate,
+                    base::File file,
+                    base::TimeDelta duration,
+                    base::TimeDelta sampling_interval,
+                    base::OnceCallback<void(bool success)> callback) {
+  DCHECK(isolate);
+
+  auto session = std::make_unique<CpuProfileSession>(
+      isolate, std::move(file), std::move(callback));
+  if (!session->Start(sampling_interval)) {
+    session->Fail();
+    return;
+  }
+
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::BindOnce(&CpuProfileSession::Finish,
+                     base::Owned(session.release())),
+      duration);
+}
+
+}  // namespace electron
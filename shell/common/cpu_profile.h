@@ -0,0 +1,27 @@
+// Copyright (c) 2020 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SHELL_COMMON_CPU_PROFILE_H_
+#define SHELL_COMMON_CPU_PROFILE_H_
+
+#include "base/callback.h"
+#include "base/files/file.h"
+#include "base/time/time.h"
+#include "v8/include/v8.h"
+
+namespace electron {
+
+// Samples the JS stacks of |isolate| every |sampling_interval| for
+// |duration|, then writes the profile to |file| in the .cpuprofile format of
+// DevTools. The isolate keeps running meanwhile, |callback| is run on the
+// calling sequence with whether the profile was written.
+void TakeCpuProfile(v8::Isolate* isolate,
+                    base::File file,
+                    base::TimeDelta duration,
+                    base::TimeDelta sampling_interval,
+                    base::OnceCallback<void(bool success)> callback);
+
+}  // namespace electron
+
+#endif  // SHELL_COMMON_CPU_PROFILE_H_
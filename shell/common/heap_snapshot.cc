@@ -4,10 +4,92 @@
 
 #include "shell/common/heap_snapshot.h"
 
+#include <memory>
+#include <utility>
+
+#include "base/json/json_writer.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/values.h"
+#include "gin/converter.h"
+#include "mojo/public/c/system/trap.h"
+#include "mojo/public/cpp/system/trap.h"
 #include "v8/include/v8-profiler.h"
 
 namespace {
 
+// How long the serialization waits for the consumer of a full pipe before the
+// snapshot is aborted, the page is blocked meanwhile.
+constexpr base::TimeDelta kMaxStallTime = base::TimeDelta::FromSeconds(10);
+
+// Signaled by a mojo trap when the handle it watches becomes writable, or can
+// never become writable again.
+class TrapEvent : public base::RefCountedThreadSafe<TrapEvent> {
+ public:
+  TrapEvent() = default;
+
+  base::WaitableEvent& event() { return event_; }
+  MojoResult result() const { return result_; }
+
+  static void OnNotification(const MojoTrapEvent* trap_event) {
+    auto* self = reinterpret_cast<TrapEvent*>(trap_event->trigger_context);
+    if (trap_event->result == MOJO_RESULT_CANCELLED) {
+      // The trap is closed, balances the reference taken by WaitWritable().
+      self->Release();
+      return;
+    }
+    self->result_ = trap_event->result;
+    self->event_.Signal();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<TrapEvent>;
+  ~TrapEvent() = default;
+
+  base::WaitableEvent event_;
+  MojoResult result_ = MOJO_RESULT_UNKNOWN;
+
+  DISALLOW_COPY_AND_ASSIGN(TrapEvent);
+};
+
+// Like mojo::Wait() for MOJO_HANDLE_SIGNAL_WRITABLE, but gives up with
+// MOJO_RESULT_DEADLINE_EXCEEDED after |timeout|.
+MojoResult WaitWritable(mojo::DataPipeProducerHandle handle,
+                        base::TimeDelta timeout) {
+  mojo::ScopedTrapHandle trap;
+  MojoResult rv = mojo::CreateTrap(&TrapEvent::OnNotification, &trap);
+  if (rv != MOJO_RESULT_OK)
+    return rv;
+
+  auto event = base::MakeRefCounted<TrapEvent>();
+  // Released when the trap is closed.
+  event->AddRef();
+  rv = MojoAddTrigger(trap->value(), handle.value(),
+                      MOJO_HANDLE_SIGNAL_WRITABLE,
+                      MOJO_TRIGGER_CONDITION_SIGNALS_SATISFIED,
+                      reinterpret_cast<uintptr_t>(event.get()), nullptr);
+  if (rv != MOJO_RESULT_OK) {
+    event->Release();
+    return rv;
+  }
+
+  uint32_t num_blocking_events = 1;
+  MojoTrapEvent blocking_event = {sizeof(blocking_event)};
+  rv = MojoArmTrap(trap->value(), nullptr, &num_blocking_events,
+                   &blocking_event);
+  if (rv == MOJO_RESULT_FAILED_PRECONDITION) {
+    // The handle is already writable, or the consumer is gone.
+    return blocking_event.result;
+  }
+  if (rv != MOJO_RESULT_OK)
+    return rv;
+
+  if (!event->event().TimedWait(timeout))
+    return MOJO_RESULT_DEADLINE_EXCEEDED;
+  return event->result();
+}
+
 class HeapSnapshotOutputStream : public v8::OutputStream {
  public:
   explicit HeapSnapshotOutputStream(base::File* file) : file_(file) {
@@ -30,6 +112,70 @@ class HeapSnapshotOutputStream : public v8::OutputStream {
   bool is_complete_ = false;
 };
 
+class DataPipeOutputStream : public v8::OutputStream {
+ public:
+  explicit DataPipeOutputStream(mojo::ScopedDataPipeProducerHandle stream)
+      : stream_(std::move(stream)) {}
+
+  bool IsComplete() const { return is_complete_; }
+
+  // v8::OutputStream
+  int GetChunkSize() override { return 65536; }
+  void EndOfStream() override { is_complete_ = true; }
+
+  v8::OutputStream::WriteResult WriteAsciiChunk(char* data, int size) override {
+    while (size > 0) {
+      uint32_t bytes_written = size;
+      MojoResult result =
+          stream_->WriteData(data, &bytes_written, MOJO_WRITE_DATA_FLAG_NONE);
+      if (result == MOJO_RESULT_SHOULD_WAIT) {
+        // The isolate is blocked by the serialization anyway, waiting for
+        // the consumer keeps the memory bounded. A consumer that stops
+        // reading must not hang the page though.
+        result = WaitWritable(stream_.get(), kMaxStallTime);
+        if (result != MOJO_RESULT_OK)
+          return kAbort;
+        continue;
+      }
+      if (result != MOJO_RESULT_OK)
+        return kAbort;
+      data += bytes_written;
+      size -= bytes_written;
+    }
+    return kContinue;
+  }
+
+ private:
+  mojo::ScopedDataPipeProducerHandle stream_;
+  bool is_complete_ = false;
+};
+
+// Converts a node of the allocation profile to the format of DevTools.
+base::Value AllocationNodeToValue(v8::Isolate* isolate,
+                                  const v8::AllocationProfile::Node* node) {
+  base::Value call_frame(base::Value::Type::DICTIONARY);
+  call_frame.SetStringKey("functionName", gin::V8ToString(isolate, node->name));
+  call_frame.SetStringKey("scriptId", base::NumberToString(node->script_id));
+  call_frame.SetStringKey("url", gin::V8ToString(isolate, node->script_name));
+  call_frame.SetIntKey("lineNumber", node->line_number - 1);
+  call_frame.SetIntKey("columnNumber", node->column_number - 1);
+
+  double self_size = 0;
+  for (const auto& allocation : node->allocations)
+    self_size += static_cast<double>(allocation.size) * allocation.count;
+
+  base::Value children(base::Value::Type::LIST);
+  for (const auto* child : node->children)
+    children.Append(AllocationNodeToValue(isolate, child));
+
+  base::Value result(base::Value::Type::DICTIONARY);
+  result.SetKey("callFrame", std::move(call_frame));
+  result.SetDoubleKey("selfSize", self_size);
+  result.SetIntKey("id", node->node_id);
+  result.SetKey("children", std::move(children));
+  return result;
+}
+
 }  // namespace
 
 namespace electron {
@@ -53,4 +199,60 @@ bool TakeHeapSnapshot(v8::Isolate* isolate, base::File* file) {
   return stream.IsComplete();
 }
 
+bool TakeHeapSnapshot(v8::Isolate* isolate,
+                      mojo::ScopedDataPipeProducerHandle stream) {
+  DCHECK(isolate);
+
+  if (!stream.is_valid())
+    return false;
+
+  auto* snapshot = isolate->GetHeapProfiler()->TakeHeapSnapshot();
+  if (!snapshot)
+    return false;
+
+  DataPipeOutputStream output_stream(std::move(stream));
+  snapshot->Serialize(&output_stream, v8::HeapSnapshot::kJSON);
+
+  const_cast<v8::HeapSnapshot*>(snapshot)->Delete();
+
+  return output_stream.IsComplete();
+}
+
+bool StartSamplingHeapProfiler(v8::Isolate* isolate,
+                               uint64_t sampling_interval,
+                               int stack_depth) {
+  DCHECK(isolate);
+  return isolate->GetHeapProfiler()->StartSamplingHeapProfiler(
+      sampling_interval, stack_depth);
+}
+
+std::string StopSamplingHeapProfiler(v8::Isolate* isolate) {
+  DCHECK(isolate);
+  v8::HandleScope handle_scope(isolate);
+  auto* heap_profiler = isolate->GetHeapProfiler();
+  std::unique_ptr<v8::AllocationProfile> profile(
+      heap_profiler->GetAllocationProfile());
+  heap_profiler->StopSamplingHeapProfiler();
+  if (!profile)
+    return std::string();
+
+  base::Value samples(base::Value::Type::LIST);
+  for (const auto& sample : profile->GetSamples()) {
+    base::Value value(base::Value::Type::DICTIONARY);
+    value.SetDoubleKey("size",
+                       static_cast<double>(sample.size) * sample.count);
+    value.SetIntKey("nodeId", sample.node_id);
+    value.SetDoubleKey("ordinal", static_cast<double>(sample.sample_id));
+    samples.Append(std::move(value));
+  }
+
+  base::Value result(base::Value::Type::DICTIONARY);
+  result.SetKey("head", AllocationNodeToValue(isolate, profile->GetRootNode()));
+  result.SetKey("samples", std::move(samples));
+
+  std::string json;
+  base::JSONWriter::Write(result, &json);
+  return json;
+}
+
 }  // namespace electron
@@ -5,13 +5,33 @@
 #ifndef SHELL_COMMON_HEAP_SNAPSHOT_H_
 #define SHELL_COMMON_HEAP_SNAPSHOT_H_
 
+#include <string>
+
 #include "base/files/file.h"
+#include "mojo/public/cpp/system/data_pipe.h"
 #include "v8/include/v8.h"
 
 namespace electron {
 
 bool TakeHeapSnapshot(v8::Isolate* isolate, base::File* file);
 
+// Writes the snapshot to |stream| while it is serialized, waiting for the
+// consumer when the pipe is full, so the snapshot is never held in memory as a
+// whole. Fails if the consumer goes away, or leaves the pipe full for 10
+// seconds.
+bool TakeHeapSnapshot(v8::Isolate* isolate,
+                      mojo::ScopedDataPipeProducerHandle stream);
+
+// The sampling heap profiler only records a sample of the allocations, which
+// is cheap enough for production. |sampling_interval| is the average number of
+// bytes between two samples.
+bool StartSamplingHeapProfiler(v8::Isolate* isolate,
+                               uint64_t sampling_interval,
+                               int stack_depth);
+// Returns the allocations that are still alive, as the JSON of a DevTools
+// .heapprofile file, or an empty string if the profiler is not running.
+std::string StopSamplingHeapProfiler(v8::Isolate* isolate);
+
 }  // namespace electron
 
 #endif  // SHELL_COMMON_HEAP_SNAPSHOT_H_
@@ -3,8 +3,10 @@
 // found in the LICENSE file.
 
 #include <string>
+#include <vector>
 
 #include "base/files/file_util.h"
+#include "base/numerics/ranges.h"
 #include "base/strings/pattern.h"
 #include "base/strings/string_util.h"
 #include "base/threading/thread_restrictions.h"
@@ -15,6 +17,8 @@
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
+#include "third_party/skia/include/core/SkStream.h"
+#include "third_party/skia/include/encode/SkPngEncoder.h"
 #include "ui/gfx/codec/jpeg_codec.h"
 #include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/geometry/size.h"
@@ -42,6 +46,26 @@ ScaleFactorPair kScaleFactorPairs[] = {
     {"@1.5x", 1.5f}, {"@1.8x", 1.8f},   {"@2.5x", 2.5f},
 };
 
+// SkWStream that appends to a vector, so the encoder output does not need to
+// be copied out of a SkDynamicMemoryWStream.
+class VectorWStream : public SkWStream {
+ public:
+  explicit VectorWStream(std::vector<unsigned char>* dst) : dst_(dst) {}
+
+  bool write(const void* buffer, size_t size) override {
+    const unsigned char* ptr = reinterpret_cast<const unsigned char*>(buffer);
+    dst_->insert(dst_->end(), ptr, ptr + size);
+    return true;
+  }
+
+  size_t bytesWritten() const override { return dst_->size(); }
+
+ private:
+  std::vector<unsigned char>* dst_;
+
+  DISALLOW_COPY_AND_ASSIGN(VectorWStream);
+};
+
 float GetScaleFactorFromPath(const base::FilePath& path) {
   std::string filename(path.BaseName().RemoveExtension().AsUTF8Unsafe());
 
@@ -150,6 +174,30 @@ bool PopulateImageSkiaRepsFromPath(gfx::ImageSkia* image,
         image, path.InsertBeforeExtensionASCII(pair.name), pair.scale);
   return succeed;
 }
+
+bool EncodeBGRASkBitmapAsPNG(const SkBitmap& bitmap,
+                             int compression_level,
+                             std::vector<unsigned char>* output) {
+  output->clear();
+  SkPixmap pixmap;
+  if (!bitmap.peekPixels(&pixmap))
+    return false;
+
+  SkPngEncoder::Options options;
+  options.fZLibLevel = base::ClampToRange(compression_level, 0, 9);
+  // Adaptive filtering tries every filter on every row, which dominates the
+  // encoding time when a fast compression level was asked for.
+  if (options.fZLibLevel < 6)
+    options.fFilterFlags = SkPngEncoder::FilterFlag::kSub;
+
+  VectorWStream stream(output);
+  if (!SkPngEncoder::Encode(&stream, pixmap, options)) {
+    output->clear();
+    return false;
+  }
+  return true;
+}
+
 #if defined(OS_WIN)
 bool ReadImageSkiaFromICO(gfx::ImageSkia* image, HICON icon) {
   // Convert the icon from the Windows specific HICON to gfx::ImageSkia.
@@ -6,9 +6,12 @@
 #define SHELL_COMMON_SKIA_UTIL_H_
 
 #include <string>
+#include <vector>
 
 #include "ui/gfx/image/image_skia.h"
 
+class SkBitmap;
+
 namespace electron {
 
 namespace util {
@@ -33,6 +36,12 @@ bool AddImageSkiaRepFromPNG(gfx::ImageSkia* image,
                             size_t size,
                             double scale_factor);
 
+// Encodes the BGRA |bitmap| as PNG using the zlib |compression_level| (0-9).
+// Lower levels trade output size for encoding speed.
+bool EncodeBGRASkBitmapAsPNG(const SkBitmap& bitmap,
+                             int compression_level,
+                             std::vector<unsigned char>* output);
+
 #if defined(OS_WIN)
 bool ReadImageSkiaFromICO(gfx::ImageSkia* image, HICON icon);
 #endif
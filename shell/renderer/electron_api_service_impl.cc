@@ -13,6 +13,7 @@
 #include "base/threading/thread_restrictions.h"
 #include "gin/data_object_builder.h"
 #include "mojo/public/cpp/system/platform_handle.h"
+#include "shell/common/cpu_profile.h"
 #include "shell/common/electron_constants.h"
 #include "shell/common/gin_converters/blink_converter.h"
 #include "shell/common/gin_converters/value_converter.h"
@@ -22,10 +23,13 @@
 #include "shell/common/v8_value_serializer.h"
 #include "shell/renderer/electron_render_frame_observer.h"
 #include "shell/renderer/renderer_client_base.h"
+#include "third_party/blink/public/common/web_cache/web_cache_resource_type_stats.h"
 #include "third_party/blink/public/mojom/frame/user_activation_notification_type.mojom-shared.h"
+#include "third_party/blink/public/platform/web_cache.h"
 #include "third_party/blink/public/web/blink.h"
 #include "third_party/blink/public/web/web_local_frame.h"
 #include "third_party/blink/public/web/web_message_port_converter.h"
+#include "third_party/blink/renderer/platform/heap/process_heap.h"  // nogncheck
 
 namespace electron {
 
@@ -33,6 +37,15 @@ namespace {
 
 const char kIpcKey[] = "ipcNative";
 
+mojom::ResourceTypeStatPtr ToMojom(
+    const blink::WebCacheResourceTypeStat& stat) {
+  auto result = mojom::ResourceTypeStat::New();
+  result->count = stat.count;
+  result->size = stat.size;
+  result->decoded_size = stat.decoded_size;
+  return result;
+}
+
 // Gets the private object under kIpcKey
 v8::Local<v8::Object> GetIpcObject(v8::Local<v8::Context> context) {
   auto* isolate = context->GetIsolate();
@@ -237,4 +250,70 @@ void ElectronApiServiceImpl::TakeHeapSnapshot(
   std::move(callback).Run(success);
 }
 
+void ElectronApiServiceImpl::TakeHeapSnapshotStream(
+    mojo::ScopedDataPipeProducerHandle stream,
+    TakeHeapSnapshotStreamCallback callback) {
+  bool success =
+      electron::TakeHeapSnapshot(blink::MainThreadIsolate(), std::move(stream));
+
+  std::move(callback).Run(success);
+}
+
+void ElectronApiServiceImpl::StartSamplingHeapProfiler(
+    uint64_t sampling_interval,
+    int32_t stack_depth,
+    StartSamplingHeapProfilerCallback callback) {
+  std::move(callback).Run(electron::StartSamplingHeapProfiler(
+      blink::MainThreadIsolate(), sampling_interval, stack_depth));
+}
+
+void ElectronApiServiceImpl::StopSamplingHeapProfiler(
+    StopSamplingHeapProfilerCallback callback) {
+  std::move(callback).Run(
+      electron::StopSamplingHeapProfiler(blink::MainThreadIsolate()));
+}
+
+void ElectronApiServiceImpl::TakeCpuProfile(mojo::ScopedHandle file,
+                                            base::TimeDelta duration,
+                                            base::TimeDelta sampling_interval,
+                                            TakeCpuProfileCallback callback) {
+  base::ScopedPlatformFile platform_file;
+  if (mojo::UnwrapPlatformFile(std::move(file), &platform_file) !=
+      MOJO_RESULT_OK) {
+    LOG(ERROR) << "Unable to get the file handle from mojo.";
+    std::move(callback).Run(false);
+    return;
+  }
+
+  electron::TakeCpuProfile(blink::MainThreadIsolate(),
+                           base::File(std::move(platform_file)), duration,
+                           sampling_interval, std::move(callback));
+}
+
+void ElectronApiServiceImpl::GetResourceUsage(
+    GetResourceUsageCallback callback) {
+  auto usage = mojom::RendererResourceUsage::New();
+
+  v8::HeapStatistics heap_stats;
+  blink::MainThreadIsolate()->GetHeapStatistics(&heap_stats);
+  usage->js_heap_used_size = heap_stats.used_heap_size();
+  usage->js_heap_total_size = heap_stats.total_heap_size();
+  usage->js_heap_size_limit = heap_stats.heap_size_limit();
+
+  usage->blink_heap_allocated_size =
+      blink::ProcessHeap::TotalAllocatedObjectSize();
+  usage->blink_heap_total_size = blink::ProcessHeap::TotalAllocatedSpace();
+
+  blink::WebCacheResourceTypeStats stats;
+  blink::WebCache::GetResourceTypeStats(&stats);
+  usage->images = ToMojom(stats.images);
+  usage->scripts = ToMojom(stats.scripts);
+  usage->css_style_sheets = ToMojom(stats.css_style_sheets);
+  usage->xsl_style_sheets = ToMojom(stats.xsl_style_sheets);
+  usage->fonts = ToMojom(stats.fonts);
+  usage->other = ToMojom(stats.other);
+
+  std::move(callback).Run(std::move(usage));
+}
+
 }  // namespace electron
@@ -38,6 +38,19 @@ class ElectronApiServiceImpl : public mojom::ElectronRenderer,
   void NotifyUserActivation() override;
   void TakeHeapSnapshot(mojo::ScopedHandle file,
                         TakeHeapSnapshotCallback callback) override;
+  void TakeHeapSnapshotStream(mojo::ScopedDataPipeProducerHandle stream,
+                              TakeHeapSnapshotStreamCallback callback) override;
+  void StartSamplingHeapProfiler(
+      uint64_t sampling_interval,
+      int32_t stack_depth,
+      StartSamplingHeapProfilerCallback callback) override;
+  void StopSamplingHeapProfiler(
+      StopSamplingHeapProfilerCallback callback) override;
+  void TakeCpuProfile(mojo::ScopedHandle file,
+                      base::TimeDelta duration,
+                      base::TimeDelta sampling_interval,
+                      TakeCpuProfileCallback callback) override;
+  void GetResourceUsage(GetResourceUsageCallback callback) override;
 
   base::WeakPtr<ElectronApiServiceImpl> GetWeakPtr() {
     return weak_factory_.GetWeakPtr();
@@ -6,10 +6,10 @@ import * as net from 'net';
 import * as fs from 'fs';
 import * as path from 'path';
 import { promisify } from 'util';
-import { app, BrowserWindow, Menu, session } from 'electron/main';
+import { app, BrowserWindow, ipcMain, Menu, session } from 'electron/main';
 import { emittedOnce } from './events-helpers';
 import { closeWindow, closeAllWindows } from './window-helpers';
-import { ifdescribe, ifit } from './spec-helpers';
+import { ifdescribe, ifit, delay } from './spec-helpers';
 import split = require('split')
 
 const features = process._linkedBinding('electron_common_features');
@@ -1205,6 +1205,120 @@ describe('app module', () => {
     });
   });
 
+  describe('startMetricsSampling() API', () => {
+    afterEach(() => {
+      app.stopMetricsSampling();
+    });
+
+    it('samples the metrics of all running electron processes', async () => {
+      app.startMetricsSampling({ interval: 100, maxSamples: 3 });
+      expect(app.isMetricsSamplingEnabled()).to.be.true('sampling enabled');
+      await delay(1000);
+
+      const snapshot = app.getMetricsSnapshot();
+      expect(snapshot).to.be.an('array').and.have.lengthOf.at.least(1);
+      for (const entry of snapshot) {
+        expect(entry.pid).to.be.above(0, 'pid is not > 0');
+        expect(entry.type).to.be.a('string').that.does.not.equal('');
+        expect(entry.time).to.be.a('number').that.is.greaterThan(0);
+        expect(entry.percentCPUUsage).to.be.a('number');
+        expect(entry.workingSetSize).to.be.greaterThan(0);
+        expect(entry.ioReadBytes).to.be.a('number');
+        expect(entry.ioWriteBytes).to.be.a('number');
+      }
+      expect(snapshot.map(entry => entry.type)).to.include('Browser');
+
+      const history = app.getMetricsHistory();
+      for (const entry of history) {
+        expect(entry.samples).to.have.lengthOf.at.most(3);
+      }
+      const latest = Math.max(...snapshot.map(entry => entry.time));
+      for (const entry of app.getMetricsHistory(latest)) {
+        expect(entry.samples).to.be.empty();
+      }
+
+      app.stopMetricsSampling();
+      expect(app.isMetricsSamplingEnabled()).to.be.false('sampling enabled');
+      expect(app.getMetricsSnapshot()).to.be.empty();
+    });
+
+    it('emits an event when a threshold is exceeded', async () => {
+      app.startMetricsSampling({
+        interval: 100,
+        thresholds: [{ processType: 'Browser', metric: 'workingSetSize', value: 1 }]
+      });
+      const [, details] = await emittedOnce(app, 'process-metrics-threshold-exceeded');
+      expect(details.pid).to.equal(process.pid);
+      expect(details.type).to.equal('Browser');
+      expect(details.metric).to.equal('workingSetSize');
+      expect(details.value).to.be.greaterThan(details.threshold);
+    });
+
+    it('throws on invalid options', () => {
+      expect(() => app.startMetricsSampling({ interval: 1 })).to.throw();
+      expect(() => app.startMetricsSampling({ thresholds: [{ metric: 'foo', value: 1 }] } as any)).to.throw();
+    });
+  });
+
+  describe('startLongTaskMonitor() API', () => {
+    afterEach(() => {
+      app.stopLongTaskMonitor();
+    });
+
+    const waitForLongTask = (source: string) => new Promise<any>(resolve => {
+      const listener = (event: Electron.Event, details: any) => {
+        if (details.source === source) {
+          app.removeListener('long-task', listener);
+          resolve(details);
+        }
+      };
+      app.on('long-task', listener);
+    });
+
+    it('emits an event for long tasks', async () => {
+      app.startLongTaskMonitor({ threshold: 50 });
+      expect(app.isLongTaskMonitorRunning()).to.be.true('monitor running');
+      setTimeout(() => {
+        const end = Date.now() + 100;
+        while (Date.now() < end);
+      }, 0);
+      const details = await waitForLongTask('uv');
+      expect(details.duration).to.be.at.least(50);
+      expect(details.startTime).to.be.at.most(Date.now());
+
+      const stats = app.getLongTaskStats();
+      expect(stats).to.have.all.keys('uv', 'ipc', 'mojo', 'timer', 'task');
+      expect(stats.uv.longTaskCount).to.be.at.least(1);
+      expect(stats.uv.maxTime).to.be.at.least(50);
+      const histogramCount = stats.uv.histogram.reduce((sum: number, bucket: any) => sum + bucket.count, 0);
+      expect(histogramCount).to.equal(stats.uv.count);
+
+      app.stopLongTaskMonitor();
+      expect(app.isLongTaskMonitorRunning()).to.be.false('monitor running');
+    });
+
+    it('attributes ipc messages to their channel', async () => {
+      app.startLongTaskMonitor({ threshold: 50 });
+      const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      try {
+        ipcMain.once('long-task-spec', () => {
+          const end = Date.now() + 100;
+          while (Date.now() < end);
+        });
+        await w.loadURL('about:blank');
+        w.webContents.executeJavaScript('require(\'electron\').ipcRenderer.send(\'long-task-spec\')');
+        const details = await waitForLongTask('ipc');
+        expect(details.detail).to.equal('long-task-spec');
+      } finally {
+        w.destroy();
+      }
+    });
+
+    it('throws on invalid options', () => {
+      expect(() => app.startLongTaskMonitor({ threshold: 0 })).to.throw();
+    });
+  });
+
   describe('getGPUFeatureStatus() API', () => {
     it('returns the graphic features statuses', () => {
       const features = app.getGPUFeatureStatus();
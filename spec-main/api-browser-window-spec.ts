@@ -1317,6 +1317,31 @@ describe('BrowserWindow module', () => {
       // Values can be 0,2,3,4, or 6. We want 6, which is RGB + Alpha
       expect(imgBuffer[25]).to.equal(6);
     });
+
+    it('scales the image to the requested size', async () => {
+      const w = new BrowserWindow({ show: false, width: 400, height: 400 });
+      w.loadFile(path.join(fixtures, 'pages', 'theme-color.html'));
+      await emittedOnce(w, 'ready-to-show');
+      w.show();
+
+      const image = await w.capturePage(undefined, { size: { width: 100, height: 50 } });
+      expect(image.getSize()).to.deep.equal({ width: 100, height: 50 });
+    });
+
+    it('preserves the aspect ratio when only one dimension is requested', async () => {
+      const w = new BrowserWindow({ show: false, width: 400, height: 400 });
+      w.loadFile(path.join(fixtures, 'pages', 'theme-color.html'));
+      await emittedOnce(w, 'ready-to-show');
+      w.show();
+
+      const full = (await w.capturePage()).getSize();
+      const byWidth = (await w.capturePage(undefined, { size: { width: 100 } })).getSize();
+      expect(byWidth.width).to.equal(100);
+      expect(byWidth.height).to.be.closeTo(100 * full.height / full.width, 1);
+      const byHeight = (await w.capturePage(undefined, { size: { height: 50 } })).getSize();
+      expect(byHeight.height).to.equal(50);
+      expect(byHeight.width).to.be.closeTo(50 * full.width / full.height, 1);
+    });
   });
 
   describe('BrowserWindow.setProgressBar(progress)', () => {
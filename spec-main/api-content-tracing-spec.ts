@@ -121,6 +121,44 @@ ifdescribe(!(process.platform !== 'win32' && ['arm', 'arm64'].includes(process.a
     });
   });
 
+  describe('flight recorder', function () {
+    this.timeout(5e3);
+
+    afterEach(async () => {
+      if (contentTracing.flightRecorderRunning) {
+        await contentTracing.stopFlightRecorder();
+      }
+    });
+
+    it('dumps the recent events and keeps running', async () => {
+      await app.whenReady();
+      await contentTracing.startFlightRecorder({ categories: ['electron'], bufferSize: 1024 });
+      expect(contentTracing.flightRecorderRunning).to.be.true('flight recorder running');
+
+      const resultFilePath = await contentTracing.dumpFlightRecorder(outputFilePath);
+      expect(resultFilePath).to.equal(outputFilePath);
+      expect(fs.existsSync(outputFilePath)).to.be.true('output exists');
+      expect(contentTracing.flightRecorderRunning).to.be.true('flight recorder running');
+
+      const tempFilePath = await contentTracing.dumpFlightRecorder();
+      expect(tempFilePath).to.be.a('string').that.is.not.empty('result path');
+
+      await contentTracing.stopFlightRecorder();
+      expect(contentTracing.flightRecorderRunning).to.be.false('flight recorder running');
+    });
+
+    it('cannot run together with startRecording', async () => {
+      await app.whenReady();
+      await contentTracing.startFlightRecorder();
+      await expect(contentTracing.startRecording({})).to.be.rejectedWith(/flight recorder is running/);
+      await expect(contentTracing.startFlightRecorder()).to.be.rejectedWith(/already running/);
+    });
+
+    it('rejects dumping when it is not running', async () => {
+      await expect(contentTracing.dumpFlightRecorder()).to.be.rejectedWith(/not running/);
+    });
+  });
+
   describe('captured events', () => {
     it('include V8 samples from the main process', async function () {
       // This test is flaky on macOS CI.
@@ -121,6 +121,59 @@ describe('netLog module', () => {
     expect(JSON.parse(dump).events.some((x: any) => x.params && x.params.bytes && Buffer.from(x.params.bytes, 'base64').includes(unique))).to.be.true('uuid present in dump');
   });
 
+  describe('streaming', () => {
+    afterEach(async () => {
+      if (testNetLog().currentlyStreaming) {
+        await testNetLog().stopStreaming();
+      }
+    });
+
+    it('buffers the filtered events in memory', async () => {
+      const batches: any[][] = [];
+      await testNetLog().startStreaming({ eventTypes: ['URL_REQUEST_START_JOB'] }, (events) => {
+        batches.push(events);
+      });
+      expect(testNetLog().currentlyStreaming).to.be.true('currently streaming');
+      await new Promise((resolve) => {
+        const req = net.request({ url: serverUrl, session: session.fromPartition('net-log') });
+        req.on('response', (response) => {
+          response.on('data', () => {});
+          response.on('end', () => resolve());
+        });
+        req.end();
+      });
+      await testNetLog().stopStreaming();
+      expect(testNetLog().currentlyStreaming).to.be.false('currently streaming');
+
+      const events = testNetLog().getRecentEvents();
+      expect(events).to.not.be.empty();
+      for (const event of events) {
+        expect(event.type).to.equal('URL_REQUEST_START_JOB');
+      }
+      expect(events.some((event: any) => event.phase === 'begin' && event.params.url.startsWith(serverUrl))).to.be.true();
+      expect(testNetLog().getRecentEvents(0.000001)).to.have.lengthOf.at.most(events.length);
+      for (const batch of batches) {
+        for (const event of batch) {
+          expect(event.type).to.equal('URL_REQUEST_START_JOB');
+        }
+      }
+    });
+
+    it('rejects unknown event types', () => {
+      expect(() => testNetLog().startStreaming({ eventTypes: ['NOT_AN_EVENT'] })).to.throw(/Unknown event type/);
+    });
+
+    it('rejects limits that are not finite', () => {
+      expect(() => testNetLog().startStreaming({ maxEvents: Infinity })).to.throw(/Invalid value for maxEvents/);
+      expect(() => testNetLog().startStreaming({ maxAge: NaN })).to.throw(/Invalid value for maxAge/);
+      expect(() => testNetLog().startStreaming({ maxFileSize: -1 })).to.throw(/Invalid value for maxFileSize/);
+    });
+
+    it('rejects stopping when not streaming', async () => {
+      await expect(testNetLog().stopStreaming()).to.be.rejectedWith('No net log stream in progress');
+    });
+  });
+
   ifit(process.platform !== 'linux')('should begin and end logging automatically when --log-net-log is passed', async () => {
     const appProcess = ChildProcess.spawn(process.execPath,
       [appPath], {
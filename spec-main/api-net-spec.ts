@@ -1,6 +1,9 @@
 import { expect } from 'chai';
 import { net, session, ClientRequest, BrowserWindow, ClientRequestConstructorOptions } from 'electron/main';
+import * as fs from 'fs';
 import * as http from 'http';
+import * as os from 'os';
+import * as path from 'path';
 import * as url from 'url';
 import { AddressInfo, Socket } from 'net';
 import { emittedOnce } from './events-helpers';
@@ -176,6 +179,40 @@ describe('net module', () => {
       expect(response.statusCode).to.equal(200);
     });
 
+    it('should batch response data into chunks of chunkSize', async () => {
+      // Neither the body nor the writes are multiples of the chunk size.
+      const bodyData = randomBuffer(4 * kOneMegaByte + 123);
+      const writeSize = 10000;
+      const serverUrl = await respondOnce.toSingleURL((request, response) => {
+        for (let offset = 0; offset < bodyData.length; offset += writeSize) {
+          response.write(bodyData.slice(offset, offset + writeSize));
+        }
+        response.end();
+      });
+      const urlRequest = net.request({ url: serverUrl, chunkSize: kOneMegaByte });
+      const response = await getResponse(urlRequest);
+      const chunks: Buffer[] = [];
+      response.on('data', (chunk) => chunks.push(chunk));
+      await emittedOnce(response, 'end');
+      expect(Buffer.concat(chunks).equals(bodyData)).to.equal(true);
+      expect(chunks.map(chunk => chunk.length)).to.deep.equal([kOneMegaByte, kOneMegaByte, kOneMegaByte, kOneMegaByte, 123]);
+    });
+
+    it('should write the response body to downloadPath', async () => {
+      const bodyData = randomBuffer(kOneMegaByte);
+      const serverUrl = await respondOnce.toSingleURL((request, response) => {
+        response.end(bodyData);
+      });
+      const downloadPath = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'electron-net-spec-')), 'body');
+      const urlRequest = net.request({ url: serverUrl, downloadPath });
+      const response = await getResponse(urlRequest);
+      let dataEmitted = false;
+      response.on('data', () => { dataEmitted = true; });
+      await emittedOnce(response, 'end');
+      expect(dataEmitted).to.equal(false);
+      expect(fs.readFileSync(downloadPath).equals(bodyData)).to.equal(true);
+    });
+
     it('should support chunked encoding', async () => {
       const serverUrl = await respondOnce.toSingleURL((request, response) => {
         response.statusCode = 200;
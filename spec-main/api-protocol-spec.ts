@@ -5,6 +5,7 @@ import * as ChildProcess from 'child_process';
 import * as path from 'path';
 import * as http from 'http';
 import * as fs from 'fs';
+import * as os from 'os';
 import * as qs from 'querystring';
 import * as stream from 'stream';
 import { EventEmitter } from 'events';
@@ -185,12 +186,165 @@ describe('protocol module', () => {
       expect(r.data).to.equal(text);
     });
 
+    it('sends large Buffers intact', async () => {
+      const largeText = text.repeat(512 * 1024);
+      registerBufferProtocol(protocolName, (request, callback) => callback(Buffer.from(largeText)));
+      const r = await ajax(protocolName + '://fake-host');
+      expect(r.data).to.equal(largeText);
+    });
+
+    it('keeps sending a Buffer that the handler changes afterwards', async () => {
+      const data = Buffer.from(text.repeat(512 * 1024));
+      registerBufferProtocol(protocolName, (request, callback) => {
+        callback(data);
+        data.fill(0);
+      });
+      const r = await ajax(protocolName + '://fake-host');
+      expect(r.data).to.equal(text.repeat(512 * 1024));
+    });
+
+    it('detaches the Buffer when transferData is set', async () => {
+      const largeText = text.repeat(512 * 1024);
+      let data: Buffer;
+      registerBufferProtocol(protocolName, (request, callback) => {
+        data = Buffer.from(largeText);
+        callback({ data, transferData: true });
+      });
+      const r = await ajax(protocolName + '://fake-host');
+      expect(r.data).to.equal(largeText);
+      expect(data!.buffer.byteLength).to.equal(0);
+    });
+
     it('fails when sending string', async () => {
       registerBufferProtocol(protocolName, (request, callback) => callback(text as any));
       await expect(ajax(protocolName + '://fake-host')).to.be.eventually.rejectedWith(Error, '404');
     });
   });
 
+  describe('protocol.enableResponseCache', () => {
+    it('fails for schemes that are not registered', () => {
+      expect(protocol.enableResponseCache(protocolName)).to.equal(false);
+    });
+
+    it('fails for protocols whose responses cannot be cached', () => {
+      registerFileProtocol(protocolName, (request, callback) => callback(__filename));
+      expect(protocol.enableResponseCache(protocolName)).to.equal(false);
+      expect(protocol.disableResponseCache(protocolName)).to.equal(false);
+    });
+
+    it('serves fresh responses without calling the handler', async () => {
+      let calls = 0;
+      registerStringProtocol(protocolName, (request, callback) => {
+        calls++;
+        callback({ data: text, headers: { 'cache-control': 'max-age=3600' } });
+      });
+      expect(protocol.enableResponseCache(protocolName)).to.equal(true);
+      expect((await ajax(protocolName + '://fake-host')).data).to.equal(text);
+      expect((await ajax(protocolName + '://fake-host')).data).to.equal(text);
+      expect(calls).to.equal(1);
+    });
+
+    it('does not cache no-store responses', async () => {
+      let calls = 0;
+      registerStringProtocol(protocolName, (request, callback) => {
+        calls++;
+        callback({ data: text, headers: { 'cache-control': 'no-store' } });
+      });
+      protocol.enableResponseCache(protocolName);
+      await ajax(protocolName + '://fake-host');
+      await ajax(protocolName + '://fake-host');
+      expect(calls).to.equal(2);
+    });
+
+    it('revalidates stale responses', async () => {
+      const validators: (string | undefined)[] = [];
+      registerStringProtocol(protocolName, (request, callback) => {
+        const etag = request.headers['If-None-Match'];
+        validators.push(etag);
+        if (etag === '"v1"') {
+          callback({ statusCode: 304, data: '' });
+        } else {
+          callback({ data: text, headers: { 'cache-control': 'no-cache', etag: '"v1"' } });
+        }
+      });
+      protocol.enableResponseCache(protocolName);
+      expect((await ajax(protocolName + '://fake-host')).data).to.equal(text);
+      expect((await ajax(protocolName + '://fake-host')).data).to.equal(text);
+      expect(validators).to.deep.equal([undefined, '"v1"']);
+    });
+
+    it('updates the stored headers with the ones of a 304 response', async () => {
+      const validators: (string | undefined)[] = [];
+      registerStringProtocol(protocolName, (request, callback) => {
+        const etag = request.headers['If-None-Match'];
+        validators.push(etag);
+        if (etag === '"v1"') {
+          callback({ statusCode: 304, data: '', headers: { etag: '"v2"' } });
+        } else if (etag === '"v2"') {
+          callback({ statusCode: 304, data: '', headers: { 'cache-control': 'max-age=3600' } });
+        } else {
+          callback({ data: text, headers: { 'cache-control': 'no-cache', etag: '"v1"' } });
+        }
+      });
+      protocol.enableResponseCache(protocolName);
+      for (let i = 0; i < 4; i++) {
+        expect((await ajax(protocolName + '://fake-host')).data).to.equal(text);
+      }
+      expect(validators).to.deep.equal([undefined, '"v1"', '"v2"']);
+    });
+
+    it('calls the handler for no-cache requests', async () => {
+      let calls = 0;
+      registerStringProtocol(protocolName, (request, callback) => {
+        calls++;
+        callback({ data: text, headers: { 'cache-control': 'max-age=3600' } });
+      });
+      protocol.enableResponseCache(protocolName);
+      await ajax(protocolName + '://fake-host');
+      await ajax(protocolName + '://fake-host', { headers: { 'Cache-Control': 'no-cache' } });
+      await ajax(protocolName + '://fake-host', { headers: { Pragma: 'no-cache' } });
+      expect(calls).to.equal(3);
+      await ajax(protocolName + '://fake-host');
+      expect(calls).to.equal(3);
+    });
+
+    describe('with a diskPath', () => {
+      let diskPath: string;
+      beforeEach(() => { diskPath = fs.mkdtempSync(path.join(os.tmpdir(), 'electron-protocol-cache-')); });
+      afterEach(() => { fs.rmdirSync(diskPath, { recursive: true }); });
+
+      const listEntries = () => fs.existsSync(diskPath) ? fs.readdirSync(diskPath) : [];
+      const waitForEntries = async (count: number) => {
+        while (listEntries().length !== count) await delay(10);
+      };
+
+      it('keeps the entries on disk within maxDiskSize', async () => {
+        const body = 'a'.repeat(1500);
+        registerStringProtocol(protocolName, (request, callback) => {
+          callback({ data: body, headers: { 'cache-control': 'max-age=3600' } });
+        });
+        protocol.enableResponseCache(protocolName, { diskPath, maxDiskSize: 2500 });
+        await ajax(protocolName + '://fake-host/a');
+        await waitForEntries(1);
+        const [first] = listEntries();
+        await ajax(protocolName + '://fake-host/b');
+        await waitForEntries(1);
+        expect(listEntries()).to.not.include(first);
+      });
+
+      it('deletes the entries on disk when disabled', async () => {
+        registerStringProtocol(protocolName, (request, callback) => {
+          callback({ data: text, headers: { 'cache-control': 'max-age=3600' } });
+        });
+        protocol.enableResponseCache(protocolName, { diskPath });
+        await ajax(protocolName + '://fake-host');
+        await waitForEntries(1);
+        protocol.disableResponseCache(protocolName);
+        await waitForEntries(0);
+      });
+    });
+  });
+
   describe('protocol.registerFileProtocol', () => {
     const filePath = path.join(fixturesPath, 'test.asar', 'a.asar', 'file1');
     const fileContent = fs.readFileSync(filePath);
@@ -243,6 +397,37 @@ describe('protocol module', () => {
       expect(r.data).to.equal(String(normalContent));
     });
 
+    it('sends a range of a normal file', async () => {
+      registerFileProtocol(protocolName, (request, callback) => callback(normalPath));
+      const r = await ajax(protocolName + '://fake-host', { headers: { Range: 'bytes=2-9' } });
+      expect(r.data).to.equal(String(normalContent.slice(2, 10)));
+    });
+
+    it('sends multiple ranges of a normal file', async () => {
+      registerFileProtocol(protocolName, (request, callback) => callback({ path: normalPath, highWaterMark: 1024 * 1024 }));
+      const r = await ajax(protocolName + '://fake-host', { headers: { Range: 'bytes=0-3,6-9' } });
+      expect(r.status).to.equal(206);
+      expect(r.headers).to.match(/content-type: multipart\/byteranges; boundary=/);
+      expect(r.data).to.include(`Content-Range: bytes 0-3/${normalContent.length}\r\n\r\n${normalContent.slice(0, 4)}\r\n`);
+      expect(r.data).to.include(`Content-Range: bytes 6-9/${normalContent.length}\r\n\r\n${normalContent.slice(6, 10)}\r\n`);
+    });
+
+    it('merges overlapping ranges of a normal file', async () => {
+      registerFileProtocol(protocolName, (request, callback) => callback({ path: normalPath, highWaterMark: 1024 * 1024 }));
+      const r = await ajax(protocolName + '://fake-host', { headers: { Range: 'bytes=8-9,0-3,2-5' } });
+      expect(r.status).to.equal(206);
+      expect(r.data).to.include(`Content-Range: bytes 0-5/${normalContent.length}\r\n\r\n${normalContent.slice(0, 6)}\r\n`);
+      expect(r.data).to.include(`Content-Range: bytes 8-9/${normalContent.length}\r\n\r\n${normalContent.slice(8, 10)}\r\n`);
+    });
+
+    it('sends the whole file for too many ranges', async () => {
+      registerFileProtocol(protocolName, (request, callback) => callback({ path: normalPath, highWaterMark: 1024 * 1024 }));
+      const ranges = Array.from({ length: 20 }, (_, i) => `${i * 2}-${i * 2}`).join(',');
+      const r = await ajax(protocolName + '://fake-host', { headers: { Range: `bytes=${ranges}` } });
+      expect(r.status).to.equal(200);
+      expect(r.data).to.equal(String(normalContent));
+    });
+
     it('fails when sending unexist-file', async () => {
       const fakeFilePath = path.join(fixturesPath, 'test.asar', 'a.asar', 'not-exist');
       registerFileProtocol(protocolName, (request, callback) => callback(fakeFilePath));
@@ -392,6 +577,21 @@ describe('protocol module', () => {
       expect(r.data).to.have.lengthOf(data.length);
     });
 
+    it('can handle large responses sent in many small chunks', async () => {
+      const data = Buffer.alloc(4 * 1024 * 1024, 'a');
+      registerStreamProtocol(protocolName, (request, callback) => {
+        const body = new stream.Readable({ read () {} });
+        for (let offset = 0; offset < data.length; offset += 16 * 1024) {
+          body.push(data.slice(offset, offset + 16 * 1024));
+        }
+        body.push(null);
+        callback({ highWaterMark: 256 * 1024, data: body });
+      });
+      const r = await ajax(protocolName + '://fake-host');
+      expect(r.data).to.have.lengthOf(data.length);
+      expect(r.data).to.equal(data.toString());
+    });
+
     it('can handle a stream completing while writing', async () => {
       function dumbPassthrough () {
         return new stream.Transform({
@@ -165,6 +165,47 @@ describe('session module', () => {
       expect(list.some(cookie => cookie.name === name && cookie.value === value)).to.equal(false);
     });
 
+    it('sets and removes many cookies at once', async () => {
+      const { cookies } = session.fromPartition('cookies-many');
+      const names = ['a', 'b', 'c'];
+      await cookies.setMany(names.map(name => ({ url, name, value: name })));
+      let list = await cookies.get({ url });
+      expect(list.map(cookie => cookie.name).sort()).to.deep.equal(names);
+
+      await cookies.removeMany(names.slice(1).map(name => ({ url, name })));
+      list = await cookies.get({ url });
+      expect(list.map(cookie => cookie.name)).to.deep.equal(['a']);
+    });
+
+    it('rejects setMany without setting any cookie if one is invalid', async () => {
+      const { cookies } = session.fromPartition('cookies-many-invalid');
+      await expect(cookies.setMany([
+        { url, name: 'valid', value: '1' },
+        { url: 'asdf', name: 'invalid', value: '2' }
+      ])).to.eventually.be.rejectedWith('Failed to get cookie domain');
+      expect(await cookies.get({ url })).to.have.lengthOf(0);
+    });
+
+    it('emits the changes of a batch together', async () => {
+      const { cookies } = session.fromPartition('cookies-changes');
+      const changed: string[] = [];
+      const batched: string[] = [];
+      cookies.on('changed', (event, cookie) => changed.push(cookie.name));
+      const done = new Promise<void>(resolve => {
+        cookies.on('changes', (event, changes) => {
+          // The changed events are emitted as the changes happen, first.
+          expect(changed).to.include.members(changes.map(change => change.cookie.name));
+          expect(changes.every(change => change.removed === false)).to.equal(true);
+          batched.push(...changes.map(change => change.cookie.name));
+          if (batched.length === 2) resolve();
+        });
+      });
+      await cookies.setMany([{ url, name: 'a', value: '1' }, { url, name: 'b', value: '2' }]);
+      await done;
+      expect(batched.sort()).to.deep.equal(['a', 'b']);
+      expect(changed.sort()).to.deep.equal(['a', 'b']);
+    });
+
     it.skip('should set cookie for standard scheme', async () => {
       const { cookies } = session.defaultSession;
       const domain = 'fake-host';
@@ -478,6 +519,33 @@ describe('session module', () => {
         expect(proxy).to.equal(`PROXY myproxy:${proxyPort}`);
       }
     });
+
+    it('resolves several urls in order', async () => {
+      const config = { mode: 'fixed_servers' as any, proxyRules: 'http=myproxy:80', proxyBypassRules: '<local>' };
+      await customSession.setProxy(config);
+      const proxies = await customSession.resolveProxies(['http://example.com/', 'http://example/', 'http://example.com/other']);
+      expect(proxies).to.deep.equal(['PROXY myproxy:80', 'DIRECT', 'PROXY myproxy:80']);
+      expect(await customSession.resolveProxies([])).to.deep.equal([]);
+    });
+
+    it('caches resolved proxies when a ttl is set', async () => {
+      customSession.setProxyResolutionCacheTTL(60);
+      await customSession.setProxy({ proxyRules: 'http=myproxy:80' });
+      const before = customSession.getProxyResolutionMetrics();
+      expect(await customSession.resolveProxy('http://example.com/')).to.equal('PROXY myproxy:80');
+      expect(await customSession.resolveProxy('http://example.com/#ref')).to.equal('PROXY myproxy:80');
+      expect(await customSession.resolveProxy('http://example.com/path')).to.equal('PROXY myproxy:80');
+      expect(await customSession.resolveProxy('https://example.com/a')).to.equal('DIRECT');
+      expect(await customSession.resolveProxy('https://example.com/b')).to.equal('DIRECT');
+      const after = customSession.getProxyResolutionMetrics();
+      expect(after.lookupCount).to.equal(before.lookupCount + 3);
+      expect(after.cacheHitCount).to.equal(before.cacheHitCount + 2);
+      expect(after.maxTime).to.be.at.least(after.lastTime);
+
+      await customSession.setProxy({ proxyRules: 'http=myproxy:81' });
+      expect(await customSession.resolveProxy('http://example.com/')).to.equal('PROXY myproxy:81');
+      customSession.setProxyResolutionCacheTTL(0);
+    });
   });
 
   describe('ses.getBlobData()', () => {
@@ -590,6 +658,43 @@ describe('session module', () => {
       expect(w.webContents.getTitle()).to.equal(url);
     });
 
+    it('reuses cached decisions after Chromium clears its cache', async () => {
+      let numVerificationRequests = 0;
+      session.defaultSession.setCertificateVerifyProc((e, callback) => {
+        numVerificationRequests++;
+        callback(0);
+      }, { cacheSize: 16, cacheTTL: 60 });
+
+      const url = `https://127.0.0.1:${(server.address() as AddressInfo).port}`;
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL(url);
+      expect(numVerificationRequests).to.equal(1);
+
+      // Setting the proc of any session clears Chromium's verifier cache.
+      session.fromPartition('cert-verify-cache').setCertificateVerifyProc(null);
+      await session.defaultSession.closeAllConnections();
+      await w.loadURL(url + '/test');
+      expect(w.webContents.getTitle()).to.equal('hello');
+      expect(numVerificationRequests).to.equal(1);
+    });
+
+    it('calls the proc again once a cached decision expires', async () => {
+      let numVerificationRequests = 0;
+      session.defaultSession.setCertificateVerifyProc((e, callback) => {
+        numVerificationRequests++;
+        callback(0);
+      }, { cacheSize: 16, cacheTTL: 0.1 });
+
+      const url = `https://127.0.0.1:${(server.address() as AddressInfo).port}`;
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL(url);
+      await delay(200);
+      session.fromPartition('cert-verify-cache').setCertificateVerifyProc(null);
+      await session.defaultSession.closeAllConnections();
+      await w.loadURL(url + '/test');
+      expect(numVerificationRequests).to.equal(2);
+    });
+
     it('saves cached results', async () => {
       let numVerificationRequests = 0;
       session.defaultSession.setCertificateVerifyProc((e, callback) => {
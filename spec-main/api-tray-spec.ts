@@ -137,6 +137,44 @@ describe('tray module', () => {
     });
   });
 
+  describe('tray.setImageFrame(index)', () => {
+    const logoPath = path.resolve(__dirname, '..', 'spec', 'fixtures', 'assets', 'logo.png');
+
+    it('switches between the frames passed to setImageFrames', () => {
+      const frames = [nativeImage.createEmpty(), nativeImage.createFromPath(logoPath)];
+      expect(() => tray.setImageFrames(frames)).to.not.throw();
+      expect(() => tray.setImageFrame(1)).to.not.throw();
+      expect(() => tray.setImageFrame(0)).to.not.throw();
+      expect(() => tray.setImageFrame(1)).to.not.throw();
+    });
+
+    it('accepts image paths as frames', () => {
+      expect(() => tray.setImageFrames([logoPath, logoPath])).to.not.throw();
+      expect(() => tray.setImageFrame(1)).to.not.throw();
+    });
+
+    it('throws when the index is out of range', () => {
+      tray.setImageFrames([nativeImage.createEmpty()]);
+      expect(() => tray.setImageFrame(1)).to.throw(RangeError, 'Image frame index out of range');
+    });
+
+    it('throws when no frames were set', () => {
+      expect(() => tray.setImageFrame(0)).to.throw(RangeError, 'Image frame index out of range');
+    });
+
+    it('replaces the previous frames', () => {
+      tray.setImageFrames([logoPath, logoPath, logoPath]);
+      expect(() => tray.setImageFrame(2)).to.not.throw();
+      tray.setImageFrames([logoPath]);
+      expect(() => tray.setImageFrame(0)).to.not.throw();
+      expect(() => tray.setImageFrame(2)).to.throw(RangeError, 'Image frame index out of range');
+    });
+
+    it('throws when the frames are not images', () => {
+      expect(() => tray.setImageFrames([{} as any])).to.throw(/Error processing argument/);
+    });
+  });
+
   describe('tray.setPressedImage(image)', () => {
     it('accepts empty image', () => {
       tray.setPressedImage(nativeImage.createEmpty());
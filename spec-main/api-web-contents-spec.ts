@@ -3,9 +3,10 @@ import { AddressInfo } from 'net';
 import * as path from 'path';
 import * as fs from 'fs';
 import * as http from 'http';
+import * as zlib from 'zlib';
 import * as ChildProcess from 'child_process';
 import { BrowserWindow, ipcMain, webContents, session, WebContents, app } from 'electron/main';
-import { clipboard } from 'electron/common';
+import { clipboard, nativeImage } from 'electron/common';
 import { emittedOnce } from './events-helpers';
 import { closeAllWindows } from './window-helpers';
 import { ifdescribe, ifit, delay, defer } from './spec-helpers';
@@ -42,6 +43,84 @@ describe('webContents module', () => {
     });
   });
 
+  describe('getRendererResourceUsage() API', () => {
+    afterEach(closeAllWindows);
+
+    it('returns the usage of each renderer process', async () => {
+      const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.loadURL('about:blank');
+      await w.webContents.executeJavaScript('require(\'electron\').ipcRenderer.send(\'resource-usage-spec\', \'hello\')');
+      await emittedOnce(ipcMain, 'resource-usage-spec');
+
+      const usage = await webContents.getRendererResourceUsage();
+      const renderer = usage.find(renderer => renderer.pid === w.webContents.getOSProcessId())!;
+      expect(renderer).to.be.an('object');
+      expect(renderer.heap.usedHeapSize).to.be.greaterThan(0);
+      expect(renderer.heap.heapSizeLimit).to.be.at.least(renderer.heap.totalHeapSize);
+      expect(renderer.blinkMemory.allocated).to.be.a('number');
+      expect(renderer.cache.images).to.have.all.keys('count', 'size', 'liveSize');
+
+      const ipc = renderer.ipc.find(ipc => ipc.webContentsId === w.webContents.id)!;
+      expect(ipc.messagesReceived).to.be.at.least(1);
+      expect(ipc.bytesReceived).to.be.greaterThan(0);
+    });
+
+    it('counts the replies to invoke and sendSync as sent', async () => {
+      const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.loadURL('about:blank');
+      ipcMain.handle('resource-usage-spec', () => 'reply');
+      defer(() => ipcMain.removeHandler('resource-usage-spec'));
+      const onSync = (event: Electron.IpcMainEvent) => { event.returnValue = 'reply'; };
+      ipcMain.on('resource-usage-spec-sync', onSync);
+      defer(() => ipcMain.removeListener('resource-usage-spec-sync', onSync));
+
+      await w.webContents.executeJavaScript(`(async () => {
+        const { ipcRenderer } = require('electron');
+        await ipcRenderer.invoke('resource-usage-spec');
+        ipcRenderer.sendSync('resource-usage-spec-sync');
+      })()`);
+
+      const usage = await webContents.getRendererResourceUsage();
+      const renderer = usage.find(renderer => renderer.pid === w.webContents.getOSProcessId())!;
+      const ipc = renderer.ipc.find(ipc => ipc.webContentsId === w.webContents.id)!;
+      expect(ipc.messagesSent).to.be.at.least(2);
+      expect(ipc.bytesSent).to.be.greaterThan(0);
+    });
+
+    it('reports the ipc traffic since the previous update when subscribed', async () => {
+      const w = new BrowserWindow({ show: false, webPreferences: { nodeIntegration: true, contextIsolation: false } });
+      await w.loadURL('about:blank');
+
+      const updates: Electron.RendererResourceUsage[][] = [];
+      let onUpdate = () => {};
+      const nextUpdate = () => new Promise<void>(resolve => { onUpdate = resolve; });
+      const unsubscribe = webContents.subscribeRendererResourceUsage({ interval: 100 }, usage => {
+        updates.push(usage);
+        onUpdate();
+      });
+      try {
+        await nextUpdate();
+        w.webContents.send('resource-usage-spec', 'hello');
+        await nextUpdate();
+      } finally {
+        unsubscribe();
+      }
+
+      const sent = updates.map(usage => {
+        for (const renderer of usage) {
+          const ipc = renderer.ipc.find(ipc => ipc.webContentsId === w.webContents.id);
+          if (ipc) return ipc.messagesSent;
+        }
+        return 0;
+      });
+      expect(sent.reduce((sum, count) => sum + count, 0)).to.equal(1);
+    });
+
+    it('throws on invalid options', () => {
+      expect(() => webContents.subscribeRendererResourceUsage({ interval: 1 }, () => {})).to.throw();
+    });
+  });
+
   describe('will-prevent-unload event', function () {
     afterEach(closeAllWindows);
     it('does not emit if beforeunload returns undefined', async () => {
@@ -1587,6 +1666,76 @@ describe('webContents module', () => {
     generateSpecs('with sandbox', true);
   });
 
+  describe('capturePageToBuffer()', () => {
+    afterEach(closeAllWindows);
+
+    const showWindow = async () => {
+      const w = new BrowserWindow({ show: false, width: 400, height: 400 });
+      w.loadFile(path.join(fixturesPath, 'pages', 'theme-color.html'));
+      await emittedOnce(w, 'ready-to-show');
+      w.show();
+      return w;
+    };
+
+    it('resolves with the raw pixels', async () => {
+      const w = await showWindow();
+      const size = { width: 100, height: 50 };
+      const pixels = await w.webContents.capturePageToBuffer(undefined, { size });
+      expect(pixels).to.have.lengthOf(size.width * size.height * 4);
+    });
+
+    it('writes the pixels into the passed buffer', async () => {
+      const w = await showWindow();
+      const size = { width: 100, height: 50 };
+      const buffer = Buffer.alloc(size.width * size.height * 4 + 16);
+      const pixels = await w.webContents.capturePageToBuffer(undefined, { size, buffer });
+      expect(pixels).to.have.lengthOf(size.width * size.height * 4);
+      expect(pixels.buffer).to.equal(buffer.buffer);
+    });
+
+    it('writes the pixels into a passed ArrayBuffer', async () => {
+      const w = await showWindow();
+      const size = { width: 100, height: 50 };
+      const arrayBuffer = new ArrayBuffer(size.width * size.height * 4);
+      const pixels = await w.webContents.capturePageToBuffer(undefined, { size, buffer: arrayBuffer });
+      expect(pixels).to.have.lengthOf(size.width * size.height * 4);
+      expect(pixels.buffer).to.equal(arrayBuffer);
+    });
+
+    it('rejects when the passed buffer is too small', async () => {
+      const w = await showWindow();
+      const buffer = Buffer.alloc(16);
+      await expect(w.webContents.capturePageToBuffer(undefined, { size: { width: 100, height: 50 }, buffer })).to.eventually.be.rejectedWith(/buffer is too small/);
+    });
+
+    it('encodes the capture as PNG and JPEG', async () => {
+      const w = await showWindow();
+      const png = await w.webContents.capturePageToBuffer(undefined, { format: 'png', size: { width: 100 } });
+      expect(png.slice(1, 4).toString()).to.equal('PNG');
+      const jpeg = await w.webContents.capturePageToBuffer(undefined, { format: 'jpeg', quality: 50 });
+      expect(jpeg[0]).to.equal(0xFF);
+      expect(jpeg[1]).to.equal(0xD8);
+    });
+
+    it('scales the capture to a full or partial size', async () => {
+      const w = await showWindow();
+      const full = nativeImage.createFromBuffer(await w.webContents.capturePageToBuffer(undefined, { format: 'png' })).getSize();
+      const sized = nativeImage.createFromBuffer(await w.webContents.capturePageToBuffer(undefined, { format: 'png', size: { width: 100, height: 50 } })).getSize();
+      expect(sized).to.deep.equal({ width: 100, height: 50 });
+      const byWidth = nativeImage.createFromBuffer(await w.webContents.capturePageToBuffer(undefined, { format: 'png', size: { width: 100 } })).getSize();
+      expect(byWidth.width).to.equal(100);
+      expect(byWidth.height).to.be.closeTo(100 * full.height / full.width, 1);
+      const byHeight = await w.webContents.capturePageToBuffer(undefined, { size: { height: 50 } });
+      const byHeightWidth = Math.round(50 * full.width / full.height);
+      expect(byHeight.length).to.be.within((byHeightWidth - 1) * 50 * 4, (byHeightWidth + 1) * 50 * 4);
+    });
+
+    it('rejects an unknown format', async () => {
+      const w = await showWindow();
+      await expect(w.webContents.capturePageToBuffer(undefined, { format: 'gif' as any })).to.eventually.be.rejectedWith(/format must be one of/);
+    });
+  });
+
   describe('takeHeapSnapshot()', () => {
     afterEach(closeAllWindows);
 
@@ -1634,6 +1783,105 @@ describe('webContents module', () => {
     });
   });
 
+  describe('takeHeapSnapshotStream()', () => {
+    afterEach(closeAllWindows);
+
+    const readAll = async (stream: NodeJS.ReadableStream) => {
+      const chunks: Buffer[] = [];
+      for await (const chunk of stream) {
+        chunks.push(chunk as Buffer);
+      }
+      return Buffer.concat(chunks);
+    };
+
+    it('streams the snapshot', async () => {
+      const w = new BrowserWindow({ show: false, webPreferences: { sandbox: true } });
+      await w.loadURL('about:blank');
+
+      const snapshot = JSON.parse((await readAll(w.webContents.takeHeapSnapshotStream())).toString());
+      expect(snapshot).to.have.property('snapshot');
+      expect(snapshot).to.have.property('nodes');
+    });
+
+    it('compresses the snapshot', async () => {
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL('about:blank');
+
+      const compressed = await readAll(w.webContents.takeHeapSnapshotStream({ compress: true }));
+      const snapshot = JSON.parse(zlib.gunzipSync(compressed).toString());
+      expect(snapshot).to.have.property('snapshot');
+    });
+
+    it('can be aborted', async () => {
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL('about:blank');
+
+      const stream = w.webContents.takeHeapSnapshotStream();
+      await emittedOnce(stream, 'readable');
+      stream.destroy();
+      await emittedOnce(stream, 'close');
+      // The renderer is still responsive.
+      expect(await w.webContents.executeJavaScript('1 + 1')).to.equal(2);
+    });
+  });
+
+  describe('startSamplingHeapProfiler()', () => {
+    afterEach(closeAllWindows);
+
+    it('returns a heap profile', async () => {
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL('about:blank');
+
+      await w.webContents.startSamplingHeapProfiler({ samplingInterval: 1024 });
+      await w.webContents.executeJavaScript('window.leak = new Array(100000).fill(0).map((_, i) => ({ i }))');
+      const profile = JSON.parse(await w.webContents.stopSamplingHeapProfiler());
+      expect(profile.head).to.have.property('callFrame');
+      expect(profile.head.children).to.be.an('array');
+      expect(profile.samples).to.be.an('array').that.is.not.empty();
+    });
+
+    it('rejects when the profiler is not running', async () => {
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL('about:blank');
+
+      await expect(w.webContents.stopSamplingHeapProfiler()).to.eventually.be.rejectedWith(/not running/);
+    });
+  });
+
+  describe('takeCpuProfile()', () => {
+    afterEach(closeAllWindows);
+
+    it('saves a cpu profile', async () => {
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL('about:blank');
+
+      const filePath = path.join(app.getPath('temp'), 'test.cpuprofile');
+      try {
+        const promise = w.webContents.takeCpuProfile(filePath, { duration: 500, samplingInterval: 100 });
+        w.webContents.executeJavaScript('const end = Date.now() + 200; while (Date.now() < end) {}');
+        await promise;
+        const profile = JSON.parse(fs.readFileSync(filePath, 'utf8'));
+        expect(profile.nodes).to.be.an('array').that.is.not.empty();
+        expect(profile.nodes[0]).to.have.property('callFrame');
+        expect(profile.samples).to.be.an('array');
+        expect(profile.timeDeltas).to.have.lengthOf(profile.samples.length);
+      } finally {
+        try {
+          fs.unlinkSync(filePath);
+        } catch (e) {
+          // ignore error
+        }
+      }
+    });
+
+    it('fails with invalid file path', async () => {
+      const w = new BrowserWindow({ show: false });
+      await w.loadURL('about:blank');
+
+      await expect(w.webContents.takeCpuProfile('', { duration: 100 })).to.eventually.be.rejectedWith(Error, 'takeCpuProfile failed');
+    });
+  });
+
   describe('setBackgroundThrottling()', () => {
     afterEach(closeAllWindows);
     it('does not crash when allowing', () => {
@@ -75,6 +75,25 @@ describe('webRequest module', () => {
       await expect(ajax(defaultURL)).to.eventually.be.rejectedWith('404');
     });
 
+    it('can cancel the request from a later task', async () => {
+      ses.webRequest.onBeforeRequest((details, callback) => {
+        setImmediate(() => callback({ cancel: true }));
+      });
+      await expect(ajax(defaultURL)).to.eventually.be.rejectedWith('404');
+    });
+
+    it('can redirect the request synchronously', async () => {
+      ses.webRequest.onBeforeRequest((details, callback) => {
+        if (details.url === defaultURL) {
+          callback({ redirectURL: `${defaultURL}redirect` });
+        } else {
+          callback({});
+        }
+      });
+      const { data } = await ajax(defaultURL);
+      expect(data).to.equal('/redirect');
+    });
+
     it('can filter URLs', async () => {
       const filter = { urls: [defaultURL + 'filter/*'] };
       ses.webRequest.onBeforeRequest(filter, (details, callback) => {
@@ -100,6 +119,15 @@ describe('webRequest module', () => {
       expect(data).to.equal('/');
     });
 
+    it('only passes the declared fields', async () => {
+      ses.webRequest.onBeforeRequest({ fields: ['url', 'method'] }, (details, callback) => {
+        expect(Object.keys(details).sort()).to.deep.equal(['method', 'url']);
+        callback({});
+      });
+      const { data } = await ajax(defaultURL);
+      expect(data).to.equal('/');
+    });
+
     it('receives post data in details object', async () => {
       const postData = {
         name: 'post test',
@@ -152,6 +180,71 @@ describe('webRequest module', () => {
     });
   });
 
+  describe('webRequest.setRules', () => {
+    afterEach(() => {
+      ses.webRequest.setRules([]);
+      ses.webRequest.onBeforeRequest(null);
+    });
+
+    it('can block requests', async () => {
+      ses.webRequest.setRules([{ urls: [defaultURL + 'filter/*'], action: 'block' }]);
+      const { data } = await ajax(`${defaultURL}nofilter/test`);
+      expect(data).to.equal('/nofilter/test');
+      await expect(ajax(`${defaultURL}filter/test`)).to.eventually.be.rejectedWith('404');
+    });
+
+    it('does not call the onBeforeRequest listener for blocked requests', async () => {
+      let called = false;
+      ses.webRequest.onBeforeRequest((details, callback) => {
+        called = true;
+        callback({});
+      });
+      ses.webRequest.setRules([{ action: 'block' }]);
+      await expect(ajax(defaultURL)).to.eventually.be.rejectedWith('404');
+      expect(called).to.be.false();
+    });
+
+    it('matches methods and resource types', async () => {
+      ses.webRequest.setRules([
+        { methods: ['post'], action: 'block' },
+        { resourceTypes: ['image'], action: 'block' }
+      ]);
+      const { data } = await ajax(defaultURL);
+      expect(data).to.equal('/');
+      await expect(ajax(defaultURL, { type: 'POST' })).to.eventually.be.rejectedWith('404');
+    });
+
+    it('can redirect requests', async () => {
+      ses.webRequest.setRules([{ urls: [defaultURL], action: 'redirect', redirectURL: `${defaultURL}redirect` }]);
+      const { data } = await ajax(defaultURL);
+      expect(data).to.equal('/redirect');
+    });
+
+    it('can modify request headers', async () => {
+      ses.webRequest.setRules([{
+        action: 'modifyHeaders',
+        requestHeaders: { set: { Accept: '*/*;test/header' } }
+      }]);
+      const { data } = await ajax(defaultURL);
+      expect(data).to.equal('/header/received');
+    });
+
+    it('can modify response headers', async () => {
+      ses.webRequest.setRules([{
+        action: 'modifyHeaders',
+        responseHeaders: { set: { Custom: 'Changed' }, remove: ['X-Unused'] }
+      }]);
+      const { headers } = await ajax(defaultURL);
+      expect(headers).to.match(/^custom: Changed$/m);
+    });
+
+    it('throws for invalid rules', () => {
+      expect(() => ses.webRequest.setRules([{ action: 'invalid' as any }])).to.throw(/Rule action must be one of/);
+      expect(() => ses.webRequest.setRules([{ action: 'redirect' }])).to.throw(/redirectURL/);
+      expect(() => ses.webRequest.setRules([{ urls: ['bad'], action: 'block' }])).to.throw(/Invalid url pattern/);
+    });
+  });
+
   describe('webRequest.onBeforeSendHeaders', () => {
     afterEach(() => {
       ses.webRequest.onBeforeSendHeaders(null);
@@ -515,5 +608,93 @@ describe('webRequest module', () => {
       expect(reqHeaders['/websocket'].foo).to.equal('bar');
       expect(reqHeaders['/'].foo).to.equal('bar');
     });
+
+    it('can filter messages', async () => {
+      const server = http.createServer();
+      const wss = new WebSocket.Server({ server });
+      const serverReceived: string[] = [];
+      wss.on('connection', (ws) => {
+        ws.on('message', (message) => {
+          serverReceived.push(message as string);
+          ws.send(`echo ${message}`);
+        });
+      });
+      await new Promise(resolve => server.listen(0, '127.0.0.1', resolve));
+      const port = (server.address() as AddressInfo).port;
+
+      const ses = session.fromPartition('WebRequestWebSocketFrames');
+      ses.webRequest.onWebSocketFrame({ urls: ['ws://127.0.0.1/*'] }, (details, callback) => {
+        expect(details.type).to.equal('text');
+        if (details.direction === 'send') {
+          if (details.data === 'drop') {
+            callback({ cancel: true });
+          } else {
+            callback({ data: (details.data as string).replace('secret', '***') });
+          }
+        } else {
+          callback({ data: (details.data as string).toUpperCase() });
+        }
+      });
+      const contents = (webContents as any).create({ session: ses });
+      after(() => {
+        contents.destroy();
+        server.close();
+        ses.webRequest.onWebSocketFrame(null);
+      });
+
+      await contents.loadURL('about:blank');
+      const received = await contents.executeJavaScript(`new Promise(resolve => {
+        const received = [];
+        const ws = new WebSocket('ws://127.0.0.1:${port}/');
+        ws.onopen = () => { ws.send('drop'); ws.send('my secret'); ws.send('done'); };
+        ws.onmessage = (e) => {
+          received.push(e.data);
+          if (received.length === 2) resolve(received);
+        };
+      })`);
+      expect(serverReceived).to.deep.equal(['my ***', 'done']);
+      expect(received).to.deep.equal(['ECHO MY ***', 'ECHO DONE']);
+
+      const [stats] = ses.webRequest.getWebSocketStats();
+      expect(stats.url).to.equal(`ws://127.0.0.1:${port}/`);
+      expect(stats.framesSent).to.equal(3);
+      expect(stats.framesReceived).to.equal(2);
+      expect(stats.bytesSent).to.equal('drop'.length + 'my secret'.length + 'done'.length);
+      expect(stats.messagesFiltered).to.equal(5);
+    });
+
+    it('forwards binary messages with the changes made in place', async () => {
+      const server = http.createServer();
+      const wss = new WebSocket.Server({ server });
+      wss.on('connection', (ws) => {
+        ws.on('message', (message) => ws.send(message));
+      });
+      await new Promise(resolve => server.listen(0, '127.0.0.1', resolve));
+      const port = (server.address() as AddressInfo).port;
+
+      const ses = session.fromPartition('WebRequestWebSocketBinaryFrames');
+      ses.webRequest.onWebSocketFrame({ urls: ['ws://127.0.0.1/*'] }, (details, callback) => {
+        expect(details.type).to.equal('binary');
+        if (details.direction === 'send') {
+          (details.data as Buffer)[0] = 0x41;
+        }
+        callback();
+      });
+      const contents = (webContents as any).create({ session: ses });
+      after(() => {
+        contents.destroy();
+        server.close();
+        ses.webRequest.onWebSocketFrame(null);
+      });
+
+      await contents.loadURL('about:blank');
+      const received = await contents.executeJavaScript(`new Promise(resolve => {
+        const ws = new WebSocket('ws://127.0.0.1:${port}/');
+        ws.binaryType = 'arraybuffer';
+        ws.onopen = () => { ws.send(new Uint8Array([1, 2, 3])); };
+        ws.onmessage = (e) => { resolve(Array.from(new Uint8Array(e.data))); };
+      })`);
+      expect(received).to.deep.equal([0x41, 2, 3]);
+    });
   });
 });
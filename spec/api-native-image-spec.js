@@ -236,6 +236,29 @@ describe('nativeImage module', () => {
     });
   });
 
+  describe('createFromBufferAsync(buffer, options)', () => {
+    it('resolves with an image created from the given buffer', async () => {
+      const imageA = nativeImage.createFromPath(path.join(__dirname, 'fixtures', 'assets', 'logo.png'));
+
+      const imageB = await nativeImage.createFromBufferAsync(imageA.toPNG());
+      expect(imageB.getSize()).to.deep.equal({ width: 538, height: 190 });
+      expect(imageA.toBitmap().equals(imageB.toBitmap())).to.be.true();
+
+      const imageC = await nativeImage.createFromBufferAsync(imageA.toBitmap(),
+        { width: 538, height: 190, scaleFactor: 2.0 });
+      expect(imageC.getSize()).to.deep.equal({ width: 269, height: 95 });
+    });
+
+    it('resolves with an empty image when the buffer is empty', async () => {
+      const image = await nativeImage.createFromBufferAsync(Buffer.from([]));
+      expect(image.isEmpty()).to.be.true();
+    });
+
+    it('rejects on invalid arguments', async () => {
+      await expect(nativeImage.createFromBufferAsync(null)).to.eventually.be.rejectedWith('buffer must be a node Buffer');
+    });
+  });
+
   describe('createFromDataURL(dataURL)', () => {
     it('returns an empty image from the empty string', () => {
       expect(nativeImage.createFromDataURL('').isEmpty()).to.be.true();
@@ -339,6 +362,64 @@ describe('nativeImage module', () => {
     });
   });
 
+  describe('toPNG()', () => {
+    it('returns a copy of the cached PNG data', () => {
+      const image = nativeImage.createFromPath(path.join(__dirname, 'fixtures', 'assets', 'logo.png'));
+      const png = image.toPNG();
+      const original = Buffer.from(png);
+      png.fill(0);
+      expect(image.toPNG().equals(original)).to.be.true();
+    });
+  });
+
+  describe('toPNG({ compressionLevel })', () => {
+    it('encodes a decodable image at every compression level', () => {
+      const image = nativeImage.createFromPath(path.join(__dirname, 'fixtures', 'assets', 'logo.png'));
+      const sizes = [];
+      for (const compressionLevel of [0, 1, 6, 9]) {
+        const png = image.toPNG({ compressionLevel, scaleFactor: 2.0 });
+        sizes.push(png.length);
+        const decoded = nativeImage.createFromBuffer(png);
+        expect(decoded.getSize()).to.deep.equal({ width: 538, height: 190 });
+        expect(decoded.toBitmap().equals(image.toBitmap())).to.be.true();
+      }
+      expect(sizes[0]).to.be.above(sizes[3]);
+    });
+  });
+
+  describe('toPNGAsync()', () => {
+    it('resolves with the same data as toPNG()', async () => {
+      const image = nativeImage.createFromPath(path.join(__dirname, 'fixtures', 'assets', 'logo.png'));
+      for (const scaleFactor of [1.0, 2.0]) {
+        const png = await image.toPNGAsync({ scaleFactor });
+        expect(png.equals(image.toPNG({ scaleFactor }))).to.be.true();
+      }
+
+      const resized = image.resize({ width: 100 });
+      expect((await resized.toPNGAsync()).equals(resized.toPNG())).to.be.true();
+    });
+
+    it('resolves with an empty buffer for an empty image', async () => {
+      expect(await nativeImage.createEmpty().toPNGAsync()).to.have.lengthOf(0);
+    });
+  });
+
+  describe('toJPEGAsync()', () => {
+    it('resolves with the same data as toJPEG()', async () => {
+      const image = nativeImage.createFromPath(path.join(__dirname, 'fixtures', 'assets', 'logo.png'));
+      const jpeg = await image.toJPEGAsync(80);
+      expect(jpeg.equals(image.toJPEG(80))).to.be.true();
+    });
+  });
+
+  describe('toDataURLAsync()', () => {
+    it('resolves with the same data URL as toDataURL()', async () => {
+      const image = nativeImage.createFromPath(path.join(__dirname, 'fixtures', 'assets', 'logo.png'));
+      expect(await image.toDataURLAsync()).to.equal(image.toDataURL());
+      expect(await image.toDataURLAsync({ scaleFactor: 2.0 })).to.equal(image.toDataURL({ scaleFactor: 2.0 }));
+    });
+  });
+
   describe('createFromPath(path)', () => {
     it('returns an empty image for invalid paths', () => {
       expect(nativeImage.createFromPath('').isEmpty()).to.be.true();
@@ -446,6 +527,26 @@ describe('nativeImage module', () => {
     });
   });
 
+  describe('resizeAsync(options)', () => {
+    it('resolves with a resized image', async () => {
+      const image = nativeImage.createFromPath(path.join(__dirname, 'fixtures', 'assets', 'logo.png'));
+      for (const [resizeTo, expectedSize] of new Map([
+        [{ width: 269 }, { width: 269, height: 95 }],
+        [{ height: 200 }, { width: 566, height: 200 }],
+        [{ width: 80, height: 65 }, { width: 80, height: 65 }],
+        [{ width: 0, height: 0 }, { width: 0, height: 0 }]
+      ])) {
+        const resized = await image.resizeAsync(resizeTo);
+        expect(resized.getSize()).to.deep.equal(expectedSize);
+      }
+    });
+
+    it('resolves with an empty image when called on an empty image', async () => {
+      const resized = await nativeImage.createEmpty().resizeAsync({ width: 1, height: 1 });
+      expect(resized.isEmpty()).to.be.true();
+    });
+  });
+
   describe('crop(bounds)', () => {
     it('returns an empty image when called on an empty image', () => {
       expect(nativeImage.createEmpty().crop({ width: 1, height: 2, x: 0, y: 0 }).isEmpty()).to.be.true();
@@ -115,4 +115,26 @@ describe('process module', () => {
       expect(success).to.be.false();
     });
   });
+
+  describe('process.takeCpuProfile()', () => {
+    it('saves a cpu profile', async () => {
+      const filePath = path.join(await ipcRenderer.invoke('get-temp-dir'), 'test.cpuprofile');
+      try {
+        await process.takeCpuProfile(filePath, { duration: 100 });
+        const profile = JSON.parse(fs.readFileSync(filePath, 'utf8'));
+        expect(profile.nodes).to.be.an('array').that.is.not.empty();
+        expect(profile.timeDeltas).to.have.lengthOf(profile.samples.length);
+      } finally {
+        try {
+          fs.unlinkSync(filePath);
+        } catch (e) {
+          // ignore error
+        }
+      }
+    });
+
+    it('rejects on failure', async () => {
+      await expect(process.takeCpuProfile('', { duration: 100 })).to.eventually.be.rejectedWith('takeCpuProfile failed');
+    });
+  });
 });
@@ -119,6 +119,8 @@ declare namespace NodeJS {
     session?: Electron.Session;
     partition?: string;
     referrer?: string;
+    chunkSize?: number;
+    downloadPath?: string;
   };
   type ResponseHead = {
     statusCode: number;
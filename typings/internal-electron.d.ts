@@ -76,6 +76,7 @@ declare namespace Electron {
     _printToPDF(options: any): Promise<Buffer>;
     _print(options: any, callback?: (success: boolean, failureReason: string) => void): void;
     _getPrinters(): Electron.PrinterInfo[];
+    _takeHeapSnapshotStream(): { read(): Promise<Buffer | null>; cancel(): void; };
     _init(): void;
     canGoToIndex(index: number): boolean;
     getActiveIndex(): number;